@@ -24,25 +24,26 @@
 
 #define DEFAULT_FLUSH_THRESHOLD 32768 // 32 KB
 
+#include "../core/DescriptorTable.hpp"
 #include "IBuffer.hpp"
 #include "IBufferManager.hpp"
-#include <map>
 
 // Forward declarations
 class ISocket;
 class FileBuffer;
 class SocketBuffer;
+class SendfileBuffer;
 
 class BufferManager : public IBufferManager
 {
 private:
-    std::map<int, IBuffer *> m_buffers;
     size_t m_flush_threshold;
     ISocket &m_socket;
+    DescriptorTable &m_descriptors; // Buffers, indexed by descriptor
 
 public:
     // Constructor
-    BufferManager(ISocket &socket);
+    BufferManager(ISocket &socket, DescriptorTable &descriptors);
 
     // Destructor
     ~BufferManager();
@@ -55,6 +56,16 @@ public:
     ssize_t pushSocketBuffer(int socket_descriptor,
                              const std::vector<char> &data);
 
+    // Hand data over to a socket buffer without copying it
+    ssize_t pushSocketSegment(int socket_descriptor, std::vector<char> &data);
+
+    // Push a response with a file body, size bytes from an offset, into a
+    // socket buffer
+    ssize_t pushSendfileBuffer(int socket_descriptor,
+                               const std::vector<char> &head,
+                               int file_descriptor, off_t offset,
+                               size_t size);
+
     // Flush the buffer for a specific descriptor
     ssize_t flushBuffer(int descriptor, bool blocking = false);
 
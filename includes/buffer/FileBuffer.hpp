@@ -35,6 +35,9 @@ public:
     // Push data into the buffer
     ssize_t push(const std::vector<char> &data);
 
+    // Push data into the buffer, leaving the vector empty
+    ssize_t pushSegment(std::vector<char> &data);
+
     // Flush the buffer to a file descriptor
     ssize_t flush(int file_descriptor, bool regardless_of_threshold = false);
 
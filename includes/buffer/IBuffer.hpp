@@ -24,6 +24,9 @@ public:
     virtual ssize_t
     push(const std::vector<char> &) = 0; // Method to append a vector of
                                          // characters to the buffer
+    virtual ssize_t
+    pushSegment(std::vector<char> &) = 0; // Method to hand a vector over to
+                                          // the buffer, leaving it empty
     virtual ssize_t flush(int, bool = false) = 0; // Method to flush the buffer
     virtual std::vector<char> peek() const = 0; // Method to peek at the buffer
 };
@@ -13,6 +13,9 @@ public:
     virtual ssize_t pushFileBuffer(int, const std::vector<char> &,
                                    size_t = 32500) = 0;
     virtual ssize_t pushSocketBuffer(int, const std::vector<char> &) = 0;
+    virtual ssize_t pushSocketSegment(int, std::vector<char> &) = 0;
+    virtual ssize_t pushSendfileBuffer(int, const std::vector<char> &, int,
+                                       off_t, size_t) = 0;
     virtual ssize_t flushBuffer(int, bool = false) = 0;
     virtual void flushBuffers() = 0;
     virtual void destroyBuffer(int) = 0;
@@ -0,0 +1,67 @@
+#ifndef SENDFILEBUFFER_HPP
+#define SENDFILEBUFFER_HPP
+
+/*
+ * SendfileBuffer.hpp
+ *
+ * Holds a response whose body is a file, for socket descriptors.
+ * The head of the response (status line and headers) is kept in memory and
+ * sent first, the body is then sent straight from the file descriptor with
+ * sendfile(2), so the file content is never copied into the process.
+ * Data pushed afterwards is sent once the file is done.
+ *
+ */
+
+#include "../network/ISocket.hpp"
+#include "IBuffer.hpp"
+#include <vector>
+
+// Maximum number of file bytes handed to a single sendfile call
+#define SENDFILE_CHUNK_SIZE 1048576 // 1 MB
+
+class SendfileBuffer : public IBuffer
+{
+private:
+    std::vector<char> m_head; // Bytes sent before the file
+    int m_file_descriptor;    // File to send, closed on destruction
+    off_t m_offset;           // Offset of the next file byte to send
+    off_t m_end;              // Offset past the last file byte to send
+    std::vector<char> m_tail; // Bytes sent after the file
+    ISocket &m_socket;        // Socket object for sending data
+
+    // Send in-memory bytes, returns the bytes sent or -1 on error
+    ssize_t m_sendBytes(int socket_descriptor, std::vector<char> &data,
+                        bool blocking, bool more);
+
+    // Send the file until the socket is full, returns the bytes sent or -1 on
+    // error
+    ssize_t m_sendFile(int socket_descriptor);
+
+    // Get the number of bytes left to send
+    ssize_t m_remaining() const;
+
+public:
+    // Constructor, takes ownership of the file descriptor, whose size bytes
+    // from an offset are sent
+    SendfileBuffer(ISocket &socket, const std::vector<char> &head,
+                   int file_descriptor, off_t offset, size_t size);
+
+    // Destructor
+    ~SendfileBuffer();
+
+    // Push data to send after the file
+    ssize_t push(const std::vector<char> &data);
+
+    // Push data to send after the file, leaving the vector empty
+    ssize_t pushSegment(std::vector<char> &data);
+
+    // Send the buffer to a socket descriptor
+    ssize_t flush(int socket_descriptor, bool blocking = false);
+
+    // Peek at the in-memory part of the buffer
+    std::vector<char> peek() const;
+};
+
+#endif // SENDFILEBUFFER_HPP
+
+// Path: includes/buffer/SendfileBuffer.hpp
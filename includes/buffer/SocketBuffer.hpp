@@ -5,18 +5,29 @@
  * SocketBuffer.hpp
  *
  * Holds buffers intended for socket descriptors.
+ * The data is kept as a list of segments, as pushed, and sent with a single
+ * vectored send. A read offset into the first segment tracks partial sends,
+ * so nothing is copied or shifted on the way out.
  */
 
 #include "../network/ISocket.hpp"
 #include "IBuffer.hpp"
-#include <cstring>
+#include <deque>
 #include <vector>
 
+// Maximum number of segments handed to a single vectored send
+#define SOCKET_BUFFER_MAX_IOVECS 64
+
 class SocketBuffer : public IBuffer
 {
 private:
-    std::vector<char> m_buffer; // Buffer to hold data
-    ISocket &m_socket;          // Socket object for sending data
+    std::deque<std::vector<char> > m_segments; // Segments to send, in order
+    size_t m_offset;   // Bytes of the first segment already sent
+    size_t m_size;     // Bytes left to send
+    ISocket &m_socket; // Socket object for sending data
+
+    // Drop the bytes sent from the front of the buffer
+    void m_consume(size_t bytes_sent);
 
 public:
     // Constructor
@@ -25,9 +36,12 @@ public:
     // Destructor
     ~SocketBuffer();
 
-    // Push data into the buffer
+    // Push a copy of the data into the buffer
     ssize_t push(const std::vector<char> &data);
 
+    // Hand the data over to the buffer without copying it
+    ssize_t pushSegment(std::vector<char> &data);
+
     // Send the buffer to a socket descriptor
     ssize_t flush(int socket_descriptor, bool blocking = false);
 
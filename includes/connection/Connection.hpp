@@ -7,15 +7,19 @@
  * This class represents a network connection and interaction with a client.
  * It stores the socket descriptor, client IP address, port number, and remote
  * address, as well as pointers to the request and response objects. Its
- * lifetime is tied to the active connection with the client.
+ * lifetime is tied to the active connection with the client: it serves one
+ * request after the other as long as both ends keep it alive.
  *
  * It is owned by the ConnectionManager.
  *
  */
 
-#define DEFAULT_TIMEOUT 300     // 5 minutes
-#define CGI_DEFAULT_TIMEOUT 300 // 20 seconds
+#define DEFAULT_TIMEOUT 300           // 5 minutes
+#define CGI_DEFAULT_TIMEOUT 300       // 20 seconds
+#define DEFAULT_KEEPALIVE_TIMEOUT 75  // seconds
+#define DEFAULT_KEEPALIVE_REQUESTS 1000
 
+#include "../core/ITimerWheel.hpp"
 #include "../logger/ILogger.hpp"
 #include "IConnection.hpp"
 #include <ctime>
@@ -24,29 +28,38 @@ class Connection : public IConnection
 {
 private:
     SocketDescriptor_t
-        m_socket_descriptor;        // Socket descriptor for the connection
-    std::string m_ip;               // Client's IP address
-    int m_port;                     // Port number
-    std::string m_remote_address;   // Remote address
-    int m_cgi_output_pipe_read_end; // Read pipe descriptor for the response
-    int m_cgi_pid;                  // PID of the CGI process
-    ILogger &m_logger;              // Reference to the logger
-    IRequest *m_request;            // Pointer to the request object
-    IResponse *m_response;          // Pointer to the response object
-    ISession *m_session;            // Pointer to the session object
-    const time_t m_timeout;         // Timeout for the connection
-    time_t m_last_access;           // Last access time
-    time_t m_cgi_start_time;        // Cgi start time
+        m_socket_descriptor;           // Socket descriptor for the connection
+    std::string m_ip;                  // Client's IP address
+    int m_port;                        // Port number
+    std::string m_remote_address;      // Remote address
+    int m_cgi_output_pipe_read_end;    // Read pipe descriptor for the response
+    int m_cgi_pid;                     // PID of the CGI process
+    ILogger &m_logger;                 // Reference to the logger
+    IRequest *m_request;               // Request, owned by the factory
+    IResponse *m_response;             // Response, owned by the factory
+    ISession *m_session;               // Pointer to the session object
+    ITimerWheel &m_timer_wheel;        // Reference to the timer wheel
+    const time_t m_timeout;            // Timeout for the connection
+    const time_t m_keepalive_timeout;  // Timeout between two requests
+    const size_t m_keepalive_requests; // Maximum requests per connection
+    size_t m_request_count;            // Requests served so far
+    bool m_keep_alive;                 // Keep the connection after responding
+    Timer m_timer;                     // Idle timeout of the connection
+    Timer m_cgi_timer;                 // Timeout of the CGI process
 
 public:
     Connection(std::pair<int, std::pair<std::string, std::string> > client_info,
                ILogger &logger, IRequest *request, IResponse *response,
+               ITimerWheel &timer_wheel,
+               time_t keepalive_timeout = DEFAULT_KEEPALIVE_TIMEOUT,
+               size_t keepalive_requests = DEFAULT_KEEPALIVE_REQUESTS,
                time_t timeout = DEFAULT_TIMEOUT);
     virtual ~Connection();
 
     // Setters
     virtual void setSession(ISession *session);
     virtual void clearCgiInfo();
+    virtual void setKeepAlive(bool keep_alive);
 
     // Getters
     virtual int getSocketDescriptor() const;
@@ -58,12 +71,14 @@ public:
     virtual IResponse &getResponse() const;
     virtual ISession &getSession() const;
     virtual int getCgiPid() const;
+    virtual bool isKeepAlive() const;
+    virtual size_t getRequestCount() const;
     virtual void setCgiInfo(int pid, int response_read_pipe_fd);
 
     // Connection management
-    virtual void touch();               // Update the last access time
-    virtual bool hasExpired() const;    // Check if the connection has expired
-    virtual bool cgiHasExpired() const; // Check if the CGI process has expired
+    virtual void touch(); // Re-arm the idle timeout
+    virtual void reset(IRequest *request,
+                       IResponse *response); // Start the next request
 };
 
 #endif // CONNECTION_HPP
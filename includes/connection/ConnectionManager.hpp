@@ -18,6 +18,7 @@
 
 #include <map>
 
+#include "../core/DescriptorTable.hpp"
 #include "../factory/IFactory.hpp"
 #include "../logger/ILogger.hpp"
 #include "IConnection.hpp"
@@ -27,11 +28,8 @@
 class ConnectionManager : public IConnectionManager
 {
 private:
-    std::map<SocketDescriptor_t, IConnection *>
-        m_connections;                            // active connections
+    DescriptorTable &m_descriptors; // active connections, by socket
     std::map<SessionId_t, ISession *> m_sessions; // active sessions
-    time_t
-        m_last_garbage_collection; // last time garbage collection was performed
     IFactory &m_factory; // factory object to create connections and sessions
     ILogger &m_logger;   // logger object
 
@@ -41,7 +39,8 @@ private:
 
 public:
     // Constructor
-    ConnectionManager(ILogger &logger, IFactory &factory);
+    ConnectionManager(ILogger &logger, IFactory &factory,
+                      DescriptorTable &descriptors);
 
     // Destructor
     virtual ~ConnectionManager();
@@ -50,6 +49,7 @@ public:
     virtual void addConnection(
         std::pair<int, std::pair<std::string, std::string> > client_info);
     virtual void removeConnection(SocketDescriptor_t socket_descriptor);
+    virtual void resetConnection(SocketDescriptor_t socket_descriptor);
     virtual IConnection &getConnection(SocketDescriptor_t socket_descriptor);
     virtual IRequest &getRequest(SocketDescriptor_t socket_descriptor);
     virtual IResponse &getResponse(SocketDescriptor_t socket_descriptor);
@@ -68,7 +68,7 @@ public:
                                            const IRequest &request,
                                            IResponse &response);
 
-    // Method to retire idle sessions
+    // Method to reap zombie processes
     virtual void collectGarbage();
 };
 
@@ -16,6 +16,10 @@
 #include <sys/socket.h>
 #include <vector>
 
+// Maximum number of bytes read from a client at once, a read of this size may
+// leave more data in the socket
+#define CLIENT_READ_MAX_SIZE 262144
+
 class IClientHandler
 {
 public:
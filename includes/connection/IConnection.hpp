@@ -7,7 +7,8 @@
  * This class represents a network connection and interaction with a client.
  * It stores the socket descriptor, client IP address, port number, and remote
  * address, as well as pointers to the request and response objects. Its
- * lifetime is tied to the active connection with the client.
+ * lifetime is tied to the active connection with the client: it serves one
+ * request after the other as long as both ends keep it alive.
  *
  * It is owned by the ConnectionManager.
  *
@@ -28,6 +29,7 @@ public:
     // Setters
     virtual void setSession(ISession *session) = 0;
     virtual void clearCgiInfo() = 0;
+    virtual void setKeepAlive(bool keep_alive) = 0;
 
     // Getters
     virtual int getSocketDescriptor() const = 0;
@@ -39,13 +41,14 @@ public:
     virtual IResponse &getResponse() const = 0;
     virtual ISession &getSession() const = 0;
     virtual int getCgiPid() const = 0;
+    virtual bool isKeepAlive() const = 0;
+    virtual size_t getRequestCount() const = 0;
     virtual void setCgiInfo(int, int) = 0;
 
     // Connection management
-    virtual void touch() = 0;            // Update the last access time
-    virtual bool hasExpired() const = 0; // Check if the connection has expired
-    virtual bool
-    cgiHasExpired() const = 0; // Check if the CGI process has expired
+    virtual void touch() = 0; // Re-arm the idle timeout
+    virtual void reset(IRequest *request,
+                       IResponse *response) = 0; // Start the next request
 };
 
 #endif // ICONNECTION_HPP
@@ -24,6 +24,7 @@ public:
     virtual void
         addConnection(std::pair<int, std::pair<std::string, std::string> >) = 0;
     virtual void removeConnection(SocketDescriptor_t) = 0;
+    virtual void resetConnection(SocketDescriptor_t) = 0;
     virtual IConnection &getConnection(SocketDescriptor_t) = 0;
     virtual IRequest &getRequest(SocketDescriptor_t) = 0;
     virtual IResponse &getResponse(SocketDescriptor_t) = 0;
@@ -41,7 +42,7 @@ public:
     virtual void assignSessionToConnection(IConnection &, const IRequest &,
                                            IResponse &) = 0;
 
-    // Method to retire idle sessions
+    // Method to reap zombie processes
     virtual void collectGarbage() = 0;
 };
 
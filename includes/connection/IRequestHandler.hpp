@@ -11,6 +11,8 @@ public:
     virtual ~IRequestHandler() {};
 
     virtual Triplet_t handleRequest(int) = 0;
+    virtual Triplet_t processRequest(int) = 0;
+    virtual bool keepAlive(int) = 0;
     virtual int handlePipeException(int) = 0;
     virtual int handlePipeRead(int) = 0;
     virtual void handleErrorResponse(int, int) = 0;
@@ -22,8 +22,7 @@ class ISession
 public:
     virtual ~ISession() {};
 
-    virtual void touch() = 0;            // Update last access time
-    virtual bool hasExpired() const = 0; // Check if session has expired
+    virtual void touch() = 0; // Re-arm the idle timeout
     virtual void setData(const std::string &,
                          const std::string &) = 0; // Set session data
     virtual std::string
@@ -28,7 +28,9 @@
 #include "../buffer/IBufferManager.hpp"
 #include "../configuration/IConfiguration.hpp"
 #include "../constants/HttpHelper.hpp"
+#include "../core/DescriptorTable.hpp"
 #include "../exception/IExceptionHandler.hpp"
+#include "../exception/WebservExceptions.hpp"
 #include "../logger/ILogger.hpp"
 #include "../request/RequestParser.hpp"
 #include "../response/IResponseGenerator.hpp"
@@ -36,7 +38,6 @@
 #include "IClientHandler.hpp"
 #include "IConnectionManager.hpp"
 #include "IRequestHandler.hpp"
-#include <map>
 
 // Forward declaration
 class ISocket;
@@ -57,10 +58,17 @@ private:
     ILogger &m_logger;        // Reference to the logger
     const IExceptionHandler
         &m_exception_handler;         // Ref to the exception handler
-    std::map<int, int> m_pipe_routes; // pipe descriptors to socket descriptors
+    DescriptorTable &m_descriptors;   // pipe descriptors to socket descriptors
+
+    // Directory the CGI body files are created in, ending with '/'
+    std::string m_client_body_temp_path;
 
     // private method
     int m_sendResponse(int socket_descriptor);
+    Triplet_t m_handleRequestException(int socket_descriptor,
+                                       const WebservException &e);
+    void m_setKeepAlive(IConnection &connection, const IRequest &request);
+    void m_openBodyFile(IRequest &request);
 
 public:
     // Constructor
@@ -68,7 +76,8 @@ public:
                    IConnectionManager &connection_manager,
                    const IConfiguration &configuration, IRouter &router,
                    ILogger &logger, const IExceptionHandler &exception_handler,
-                   IClientHandler &client_handler);
+                   IClientHandler &client_handler,
+                   DescriptorTable &descriptors);
 
     // Destructor
     ~RequestHandler();
@@ -76,6 +85,12 @@ public:
     // Handles client requests
     Triplet_t handleRequest(int socket_descriptor);
 
+    // Processes the requests already buffered for a client
+    Triplet_t processRequest(int socket_descriptor);
+
+    // Resets a kept-alive connection for its next request
+    bool keepAlive(int socket_descriptor);
+
     // Handles exceptions related to pipe events
     int handlePipeException(int pipe_descriptor);
 
@@ -14,6 +14,7 @@
 
 #define DEFAULT_TIMEOUT 300 // 5 minutes
 
+#include "../core/ITimerWheel.hpp"
 #include "ISession.hpp"
 #include <ctime>
 #include <map>
@@ -22,20 +23,21 @@
 class Session : public ISession
 {
 private:
-    const SessionId_t m_id; // Unique session id
-    const time_t m_timeout; // Time elapsed before session expires
-    time_t m_last_access;   // Last time session was accessed
+    const SessionId_t m_id;     // Unique session id
+    ITimerWheel &m_timer_wheel; // Reference to the timer wheel
+    const time_t m_timeout;     // Time elapsed before session expires
+    Timer m_timer;              // Idle timeout of the session
     std::map<std::string, std::string> m_data; // Session data
 
 public:
     // Constructor
-    Session(SessionId_t id, time_t timeout = DEFAULT_TIMEOUT);
+    Session(SessionId_t id, ITimerWheel &timer_wheel,
+            time_t timeout = DEFAULT_TIMEOUT);
 
     // Destructor
     ~Session();
 
-    virtual void touch();            // Update last access time
-    virtual bool hasExpired() const; // Check if session has expired
+    virtual void touch(); // Re-arm the idle timeout
     virtual void setData(const std::string &key,
                          const std::string &value); // Set session data
     virtual std::string
@@ -0,0 +1,54 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+/*
+ * Clock.hpp
+ *
+ * Wall clock read once per turn of the event loop.
+ *
+ * Every log line and every response carries the current time, which only
+ * changes once per second. The clock is read by the event loop before the
+ * events are handled, and the time is only formatted again when the second
+ * changed, so that logging and responding reuse the same strings instead of
+ * formatting the time each.
+ */
+
+#include "IClock.hpp"
+
+class Clock : public IClock
+{
+private:
+    time_t m_time;               // Time of the last update
+    uint64_t m_microseconds;     // Time of the last update, in microseconds
+    std::string m_log_timestamp; // Local time, for the logs
+    std::string m_iso8601;       // Local time, ISO 8601
+    std::string m_common_log;    // Local time, Common Log Format
+    std::string m_http_date;     // UTC, IMF-fixdate
+
+    // Format the time of the last update
+    void m_format();
+
+    Clock(const Clock &src);
+    Clock &operator=(const Clock &src);
+
+public:
+    // Constructor, reads the clock
+    Clock();
+
+    // Destructor
+    ~Clock();
+
+    // Read the wall clock, formatting the time again if a second went by
+    void update();
+
+    // Getters for the time of the last update
+    time_t getTime() const;
+    uint64_t getMicroseconds() const;
+    const std::string &getLogTimestamp() const;
+    const std::string &getIso8601() const;
+    const std::string &getCommonLogTimestamp() const;
+    const std::string &getHttpDate() const;
+};
+
+#endif // CLOCK_HPP
+// Path: includes/core/Clock.hpp
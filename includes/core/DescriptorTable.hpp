@@ -0,0 +1,78 @@
+#ifndef DESCRIPTORTABLE_HPP
+#define DESCRIPTORTABLE_HPP
+
+/*
+ * DescriptorTable.hpp
+ *
+ * Table of everything the worker knows about its open descriptors, indexed
+ * by the descriptor itself. Descriptors are small integers handed out lowest
+ * first, so a flat array sized from the descriptor limit turns every lookup
+ * of the event loop into a single indexed access: the polling slot and type
+ * for the PollfdManager, the pending writes for the BufferManager, the
+ * connection for the ConnectionManager, and the client socket a CGI pipe or
+ * body file belongs to for the RequestHandler.
+ *
+ * The table is sized once from worker_rlimit_nofile, and only grows if a
+ * descriptor above the limit shows up anyway. References to entries are only
+ * valid until the next lookup that may grow it.
+ */
+
+#include <cstddef>
+#include <vector>
+
+// Entries allocated before the descriptor limit is known
+#define DESCRIPTOR_TABLE_DEFAULT_SIZE 1024
+
+// Largest table sized from the descriptor limit, which may be unlimited
+#define DESCRIPTOR_TABLE_MAX_SIZE 1048576
+
+// Forward declarations
+class IBuffer;
+class IConnection;
+
+// What the worker knows about a descriptor
+struct DescriptorEntry
+{
+    int pollfd_index;        // Index in the pollfd queue, or -1 if not polled
+    short type;              // DescriptorType, while polled
+    IBuffer *buffer;         // Data waiting to be written, or NULL
+    IConnection *connection; // Connection of a client socket, or NULL
+    int client_socket;       // Client socket a pipe or body file serves, or -1
+};
+
+class DescriptorTable
+{
+private:
+    std::vector<DescriptorEntry> m_entries;
+
+    // Entry returned for descriptors outside the table
+    static const DescriptorEntry s_empty_entry;
+
+    DescriptorTable(const DescriptorTable &src);
+    DescriptorTable &operator=(const DescriptorTable &src);
+
+public:
+    // Constructor, with DESCRIPTOR_TABLE_DEFAULT_SIZE entries
+    DescriptorTable();
+
+    // Destructor
+    ~DescriptorTable();
+
+    // Set the descriptor limit of the process, 0 keeps the inherited one,
+    // and size the table from the limit in effect
+    // Returns false if the limit could not be set
+    bool setLimit(size_t limit);
+
+    // Get the entry of a descriptor, growing the table if needed
+    DescriptorEntry &operator[](int descriptor);
+
+    // Get the entry of a descriptor, an empty entry if it is outside the table
+    const DescriptorEntry &at(int descriptor) const;
+
+    // Get the number of entries
+    size_t size() const;
+};
+
+#endif // DESCRIPTORTABLE_HPP
+
+// Path: includes/core/DescriptorTable.hpp
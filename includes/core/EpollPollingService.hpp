@@ -0,0 +1,45 @@
+#ifndef EPOLLPOLLINGSERVICE_HPP
+#define EPOLLPOLLINGSERVICE_HPP
+
+/*
+ * EpollPollingService.hpp
+ *
+ * Polling service backed by epoll. Only the descriptors reported ready by
+ * epoll_wait are handed to the EventManager, so the cost of a cycle depends on
+ * the number of active descriptors rather than on the size of the poll set.
+ */
+
+#ifdef __linux__
+
+#include "../logger/ILogger.hpp"
+#include "../pollfd/EpollPollfdManager.hpp"
+#include "IPollingService.hpp"
+#include <sys/epoll.h>
+#include <vector>
+
+#define EPOLL_MAX_EVENTS 1024
+
+class EpollPollingService : public IPollingService
+{
+private:
+    EpollPollfdManager &m_pollfd_manager;
+    ILogger &m_logger;
+    int m_timeout;
+    std::vector<epoll_event> m_events;
+
+    // Method to translate epoll events to poll events
+    static short m_toPollEvents(uint32_t events);
+
+public:
+    EpollPollingService(EpollPollfdManager &pollfd_manager, ILogger &logger,
+                        int timeout = DEFAULT_POLLING_TIMEOUT);
+    ~EpollPollingService();
+
+    virtual void pollEvents();
+    virtual void setPollingTimeout(int timeout);
+};
+
+#endif // __linux__
+
+#endif // EPOLLPOLLINGSERVICE_HPP
+// Path: includes/core/EpollPollingService.hpp
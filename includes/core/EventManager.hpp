@@ -8,6 +8,7 @@
 #include "../network/IServer.hpp"
 #include "../pollfd/IPollfdManager.hpp"
 #include "IEventManager.hpp"
+#include "ITimerWheel.hpp"
 
 typedef std::pair<int, std::pair<int, int> > Triplet_t;
 
@@ -19,24 +20,35 @@ private:
     IConnectionManager &m_connection_manager;
     IServer &m_server;
     IRequestHandler &m_request_handler;
+    ITimerWheel &m_timer_wheel;
     ILogger &m_logger;
 
+    // Periodic reaping of zombie processes
+    Timer m_garbage_collector_timer;
+
     // Event handling functions for different types of files
     void m_handleRegularFileEvents(ssize_t &pollfd_index, short events);
     void m_handleServerSocketEvents(ssize_t pollfd_index, short events);
     void m_handleClientSocketEvents(ssize_t &pollfd_index, short events);
     void m_handlePipeEvents(ssize_t &pollfd_index, short events);
 
+    // Timeout handling functions for different types of timers
+    void m_handleExpiredTimers();
+    void m_handleConnectionTimeout(int client_socket);
+    void m_handleCgiTimeout(int client_socket);
+
     // helper functions
-    void m_handleRequest(ssize_t &pollfd_index);
+    void m_handleRequest(ssize_t &pollfd_index, short options = 0);
     void m_handleClientException(ssize_t &pollfd_index, short events);
     ssize_t m_flushBuffer(ssize_t &pollfd_index, short options = 0);
+    void m_keepAlive(ssize_t &pollfd_index, int descriptor);
     void m_cleanUp(ssize_t &pollfd_index, int descriptor, short options = 0);
 
 public:
     EventManager(IPollfdManager &pollfd_manager, IBufferManager &buffer_manager,
                  IConnectionManager &connection_manager, IServer &server,
-                 IRequestHandler &request_handler, ILogger &logger);
+                 IRequestHandler &request_handler, ITimerWheel &timer_wheel,
+                 ILogger &logger);
     ~EventManager();
 
     virtual void handleEvents();
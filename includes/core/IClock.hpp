@@ -0,0 +1,47 @@
+#ifndef ICLOCK_HPP
+#define ICLOCK_HPP
+
+/*
+ * IClock.hpp
+ *
+ * Abstract class for reading the wall clock, and the time formatted for the
+ * logs and the HTTP headers.
+ */
+
+#include <ctime>
+#include <stdint.h>
+#include <string>
+
+class IClock
+{
+public:
+    virtual ~IClock() {}
+
+    // Read the wall clock, formatting the time again if a second went by
+    virtual void update() = 0;
+
+    // Get the time of the last update
+    virtual time_t getTime() const = 0;
+
+    // Get the time of the last update in microseconds since the epoch, used
+    // to time the requests
+    virtual uint64_t getMicroseconds() const = 0;
+
+    // Get the local time of the last update as "2011-01-01 01:11:11", used by
+    // the logs
+    virtual const std::string &getLogTimestamp() const = 0;
+
+    // Get the local time of the last update as "2011-01-01T01:11:11+01:00"
+    virtual const std::string &getIso8601() const = 0;
+
+    // Get the local time of the last update as "01/Jan/2011:01:11:11 +0100",
+    // used by the access logs
+    virtual const std::string &getCommonLogTimestamp() const = 0;
+
+    // Get the time of the last update as an IMF-fixdate,
+    // "Sat, 01 Jan 2011 00:11:11 GMT", used by the Date header
+    virtual const std::string &getHttpDate() const = 0;
+};
+
+#endif // ICLOCK_HPP
+// Path: includes/core/IClock.hpp
@@ -7,6 +7,9 @@
  * Abstract class for handling polling events.
  */
 
+#define DEFAULT_POLLING_TIMEOUT 100 // in milliseconds
+#define MAX_POLLING_TIMEOUT 1000    // in milliseconds
+
 class IPollingService
 {
 public:
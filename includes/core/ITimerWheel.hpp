@@ -0,0 +1,35 @@
+#ifndef ITIMERWHEEL_HPP
+#define ITIMERWHEEL_HPP
+
+/*
+ * ITimerWheel.hpp
+ *
+ * Abstract class for scheduling timeouts.
+ */
+
+#include "Timer.hpp"
+
+class ITimerWheel
+{
+public:
+    virtual ~ITimerWheel() {}
+
+    // Arm or re-arm a timer to expire in the given number of milliseconds
+    virtual void schedule(Timer &timer, unsigned long timeout) = 0;
+
+    // Disarm a timer
+    virtual void cancel(Timer &timer) = 0;
+
+    // Read the clock and collect the timers that expired since the last call
+    virtual void advance() = 0;
+
+    // Pop an expired timer, NULL when none are left
+    virtual Timer *popExpired() = 0;
+
+    // Get the milliseconds until the next timer may expire, at most
+    // max_timeout
+    virtual int getNextTimeout(int max_timeout) const = 0;
+};
+
+#endif // ITIMERWHEEL_HPP
+// Path: includes/core/ITimerWheel.hpp
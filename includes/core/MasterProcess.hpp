@@ -0,0 +1,64 @@
+#ifndef MASTERPROCESS_HPP
+#define MASTERPROCESS_HPP
+
+/*
+ * MasterProcess.hpp
+ *
+ * The MasterProcess class forks the worker processes requested by the
+ * 'worker_processes' directive ('auto' for one per online CPU) and supervises
+ * them. Each worker runs its own core cycle with its own server sockets, bound
+ * with SO_REUSEPORT so the kernel spreads the incoming connections.
+ *
+ * Workers that die are respawned, except those that fail to set up (exit
+ * status WORKER_SETUP_FAILURE), which shuts the master down since the next
+ * worker would fail as well. On SIGINT the master forwards the signal to the
+ * workers and waits for them to exit.
+ *
+ * With a single worker process, no master is forked and the core cycle runs in
+ * the initial process.
+ */
+
+#include "../buffer/IBufferManager.hpp"
+#include "../configuration/IConfiguration.hpp"
+#include "../logger/ILogger.hpp"
+#include "../utils/SignalHandler.hpp"
+#include <sys/types.h>
+#include <vector>
+
+#define WORKER_SETUP_FAILURE 2
+
+class MasterProcess
+{
+private:
+    int m_worker_processes;       // Number of worker processes to run
+    std::vector<pid_t> m_workers; // Process ids of the workers, -1 if dead
+    int m_exit_status;            // Exit status of the master process
+    IBufferManager &m_buffer_manager;
+    ILogger &m_logger;
+    SignalHandler &m_signal_handler;
+
+    // Fork a worker in the given slot, returns true in the worker
+    bool m_spawnWorker(size_t slot);
+
+    // Forward SIGINT to the running workers
+    void m_stopWorkers();
+
+    // Drop the log messages buffered for stderr, already copied to stderr
+    void m_dropLogBacklog();
+
+public:
+    MasterProcess(IConfiguration &configuration,
+                  IBufferManager &buffer_manager, ILogger &logger,
+                  SignalHandler &signal_handler);
+    ~MasterProcess();
+
+    // Fork and supervise the workers. Returns true in the worker processes,
+    // and false in the master once all workers have exited
+    bool run();
+
+    // Get the exit status of the master process
+    int getExitStatus() const;
+};
+
+#endif // MASTERPROCESS_HPP
+// Path: includes/core/MasterProcess.hpp
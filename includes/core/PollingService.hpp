@@ -15,7 +15,7 @@ private:
 
 public:
     PollingService(IPollfdManager &pollfd_manager, ILogger &logger,
-                   int timeout = 100);
+                   int timeout = DEFAULT_POLLING_TIMEOUT);
     ~PollingService();
 
     virtual void pollEvents();
@@ -0,0 +1,46 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+/*
+ * Timer.hpp
+ *
+ * A Timer is a node of the TimerWheel, embedded in the object it times out
+ * (Connection, Session, EventManager). Arming, re-arming and cancelling it are
+ * constant-time list operations. The type and id let the EventManager find the
+ * owner back when the timer expires.
+ *
+ * NOTE - the owner must cancel its armed timers before destroying them.
+ */
+
+#include <cstddef>
+
+enum TimerType
+{
+    CONNECTION_TIMER,        // Idle client connection, id is the socket
+    CGI_TIMER,               // Running CGI process, id is the client socket
+    SESSION_TIMER,           // Idle session, id is the session id
+    GARBAGE_COLLECTOR_TIMER, // Periodic reaping of zombie processes
+};
+
+class Timer
+{
+private:
+    friend class TimerWheel;
+
+    Timer *m_previous;       // Previous timer in the slot
+    Timer *m_next;           // Next timer in the slot
+    Timer **m_slot;          // Head of the slot holding the timer, or NULL
+    unsigned long m_expires; // Tick at which the timer expires
+    const TimerType m_type;  // What the timer times out
+    const size_t m_id;       // Id of the timed out object
+
+public:
+    Timer(TimerType type, size_t id);
+
+    TimerType getType() const;
+    size_t getId() const;
+    bool isArmed() const;
+};
+
+#endif // TIMER_HPP
+// Path: includes/core/Timer.hpp
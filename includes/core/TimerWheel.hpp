@@ -0,0 +1,69 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+/*
+ * TimerWheel.hpp
+ *
+ * Hierarchical timing wheel holding the timeouts of connections, sessions and
+ * CGI processes.
+ *
+ * Time is divided in ticks of TIMER_WHEEL_TICK milliseconds. Level 0 has one
+ * slot per tick for the next TIMER_WHEEL_SLOTS ticks, and each following level
+ * has slots TIMER_WHEEL_SLOTS times wider. A timer is linked in the slot
+ * matching its expiry tick at the lowest level able to hold it; when the level
+ * below wraps around, the next slot of the level above is cascaded down.
+ *
+ * Arming and cancelling are O(1), and advancing the wheel only touches the
+ * slots passed and the timers in them, so the cost of expiry scales with the
+ * number of timers that expire rather than with the number of timers armed.
+ *
+ * Expired timers are kept linked in an expired list until popped, so that a
+ * timer destroyed while others are handled is safely unlinked.
+ */
+
+#include "ITimerWheel.hpp"
+#include "Timer.hpp"
+
+#define TIMER_WHEEL_TICK 10 // milliseconds
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+class TimerWheel : public ITimerWheel
+{
+private:
+    Timer *m_slots[ TIMER_WHEEL_LEVELS ][ TIMER_WHEEL_SLOTS ]; // Slot heads
+    Timer *m_expired;              // Head of the expired timers
+    unsigned long m_current_tick;  // Last tick processed
+    unsigned long m_now;           // Clock at the last advance, milliseconds
+    size_t m_armed_timers;         // Number of timers in the slots
+
+    // Read the monotonic clock in milliseconds
+    static unsigned long m_readClock();
+
+    // Link a timer at the head of a list
+    void m_link(Timer &timer, Timer **slot);
+
+    // Unlink a timer from its list
+    void m_unlink(Timer &timer);
+
+    // Link a timer in the slot matching its expiry tick
+    void m_insert(Timer &timer);
+
+    // Move the timers of a slot of the given level to the levels below
+    void m_cascade(int level, unsigned long index);
+
+public:
+    TimerWheel();
+    ~TimerWheel();
+
+    virtual void schedule(Timer &timer, unsigned long timeout);
+    virtual void cancel(Timer &timer);
+    virtual void advance();
+    virtual Timer *popExpired();
+    virtual int getNextTimeout(int max_timeout) const;
+};
+
+#endif // TIMERWHEEL_HPP
+// Path: includes/core/TimerWheel.hpp
@@ -251,6 +251,16 @@ public:
                            1) {};
 };
 
+class UnknownLogVariableError : public WebservException
+{
+public:
+    UnknownLogVariableError(const std::string &variable)
+        : WebservException(CRITICAL,
+                           "Unknown variable in log_format: \"$" + variable +
+                               "\"",
+                           1) {};
+};
+
 class UnknownHttpStatusCodeError : public WebservException
 {
 public:
@@ -3,18 +3,58 @@
 
 #include "../configuration/IConfiguration.hpp"
 #include "../constants/HttpHelper.hpp"
+#include "../core/IClock.hpp"
+#include "../core/ITimerWheel.hpp"
 #include "../logger/ILogger.hpp"
 #include "IFactory.hpp"
+#include <vector>
+
+/*
+ * Factory
+ *
+ * Creates the objects a connection is made of. Connections, requests and
+ * responses are pooled: objects handed back are reset and kept for the next
+ * connection instead of being deleted, so that once warmed up accepting a
+ * connection and serving a request do not allocate them again. Connections
+ * are constructed in place in freed blocks, requests and responses are reset
+ * and reused as they are.
+ *
+ * When the factory is destroyed it logs, at the info level, the requests
+ * served with the calls to operator new per request, in a build counting
+ * them (see AllocationCounter), and how often the pools were empty.
+ *
+ */
+
+// Maximum number of free objects of each kind kept for reuse
+#define FACTORY_POOL_MAX_SIZE 1024
+
+class Request;
+class Response;
 
 class Factory : public IFactory
 {
 private:
     const IConfiguration &m_configuration;
     ILogger &m_logger;
+    ITimerWheel &m_timer_wheel;
+    const IClock &m_clock;
     const HttpHelper m_http_helper;
+    const time_t m_keepalive_timeout;
+    const size_t m_keepalive_requests;
+
+    // Free objects, ready to be reused
+    std::vector<void *> m_free_connections; // Blocks sized for a Connection
+    std::vector<Request *> m_free_requests;
+    std::vector<Response *> m_free_responses;
+
+    // Statistics, logged when the factory is destroyed
+    size_t m_pool_misses;      // Objects allocated as their pool was empty
+    size_t m_requests_created; // Requests handed out, new or reused
+    size_t m_allocations;      // Calls to operator new when it was created
 
 public:
-    Factory(const IConfiguration &configuration, ILogger &m_logger);
+    Factory(const IConfiguration &configuration, ILogger &m_logger,
+            ITimerWheel &timer_wheel, const IClock &clock);
     virtual ~Factory();
 
     virtual IConnection *
@@ -22,6 +62,10 @@ public:
     virtual IRequest *createRequest();
     virtual IResponse *createResponse();
     virtual ISession *createSession(SessionId_t id);
+
+    virtual void releaseConnection(IConnection *connection);
+    virtual void releaseRequest(IRequest *request);
+    virtual void releaseResponse(IResponse *response);
 };
 
 #endif // FACTORY_HPP
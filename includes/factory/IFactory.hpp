@@ -16,6 +16,11 @@ public:
     virtual IRequest *createRequest() = 0;
     virtual IResponse *createResponse() = 0;
     virtual ISession *createSession(SessionId_t id) = 0;
+
+    // Hand objects created by the factory back to it, instead of deleting
+    virtual void releaseConnection(IConnection *connection) = 0;
+    virtual void releaseRequest(IRequest *request) = 0;
+    virtual void releaseResponse(IResponse *response) = 0;
 };
 
 #endif // IFACTORY_HPP
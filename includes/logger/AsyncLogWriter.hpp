@@ -0,0 +1,98 @@
+#ifndef ASYNCLOGWRITER_HPP
+#define ASYNCLOGWRITER_HPP
+
+/*
+ * AsyncLogWriter.hpp
+ * Writes log records to their files from a dedicated thread
+ *
+ * With log_async on, the Logger hands its formatted records to this writer
+ * instead of the BufferManager, so that writing the logs never competes with
+ * the clients for the event loop. The event loop is the only producer: it
+ * copies each record into the next slot of a fixed ring and publishes it by
+ * moving the head forward. The writer thread is the only consumer: it takes
+ * the records between the tail and the head, writes consecutive records of a
+ * file with a single writev, and frees their slots by moving the tail forward.
+ * Neither side takes a lock, the head and the tail are each written by one
+ * side only.
+ *
+ * The writer sleeps on a pipe when the ring is empty, the producer only wakes
+ * it up when it is asleep. The slots keep their string across records, so a
+ * record is copied without allocating once the ring has warmed up.
+ *
+ * If the ring is full, the record is written by the producer itself rather
+ * than waiting for the writer, which may then write it ahead of records still
+ * in the ring.
+ *
+ * The thread is only started by the first record of a configured worker, so
+ * the master process never starts one and worker processes are forked without
+ * any thread. Stopping the writer writes the records left in the ring.
+ */
+
+#include <pthread.h>
+#include <string>
+
+// Number of records in the ring, a power of two
+#define LOG_RING_SIZE 1024
+
+// Largest number of records written with a single writev
+#define LOG_WRITER_BATCH 64
+
+// Record waiting in the ring
+struct LogRecord
+{
+    int file_descriptor; // File the record is written to
+    std::string message; // Formatted record, kept allocated across records
+};
+
+class AsyncLogWriter
+{
+private:
+    LogRecord m_records[ LOG_RING_SIZE ];
+    unsigned long m_head;   // Next slot to fill, written by the producer
+    unsigned long m_tail;   // Next slot to write, written by the writer
+    int m_sleeping;         // Set while the writer waits on the pipe
+    int m_stopping;         // Set when the writer must drain and exit
+    int m_wakeup_pipe[ 2 ]; // Pipe the writer sleeps on
+    bool m_running;
+    pthread_t m_thread;
+
+    // Body of the writer thread
+    static void *m_run(void *writer);
+
+    // Write records until the writer is stopped and the ring is empty
+    void m_drain();
+
+    // Write the records of a file starting at a slot, up to the head
+    // Returns the slot following the last record written
+    unsigned long m_writeBatch(unsigned long tail, unsigned long head);
+
+    // Wake the writer up
+    void m_wakeUp();
+
+    AsyncLogWriter(const AsyncLogWriter &src);
+    AsyncLogWriter &operator=(const AsyncLogWriter &src);
+
+public:
+    // Constructor, the thread is not started
+    AsyncLogWriter();
+
+    // Destructor, stops the thread
+    ~AsyncLogWriter();
+
+    // Start the thread, if not started yet
+    // Returns false if it could not be started
+    bool start();
+
+    // Write the records left in the ring and stop the thread
+    void stop();
+
+    // Check if the thread was started
+    bool running() const;
+
+    // Queue a record to be written to a file
+    void push(int file_descriptor, const std::string &message);
+};
+
+#endif // ASYNCLOGWRITER_HPP
+
+// Path: includes/logger/AsyncLogWriter.hpp
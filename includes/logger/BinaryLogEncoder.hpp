@@ -0,0 +1,48 @@
+#ifndef BINARYLOGENCODER_HPP
+#define BINARYLOGENCODER_HPP
+
+/*
+ * BinaryLogEncoder.hpp
+ * Encodes the access records of a binary access log
+ *
+ * One encoder is kept per binary log file, it owns the string table of the
+ * worker for that file: the URIs and User-Agents already written are
+ * interned, so that a record only refers to them by offset and only new
+ * strings are written out. See BinaryLogRecord.hpp for the layout.
+ */
+
+#include "../connection/IConnection.hpp"
+#include "../core/IClock.hpp"
+#include "BinaryLogRecord.hpp"
+#include <map>
+#include <string>
+
+class BinaryLogEncoder
+{
+private:
+    std::map<std::string, uint32_t> m_strings; // Interned strings, by value
+    uint32_t m_table_size;                     // Size of the string table
+    uint32_t m_pid;                            // Worker writing the table
+
+    // Get the offset of a string in the table, appending its string record
+    // to the buffer if it is not there yet
+    uint32_t m_intern(const std::string &string, std::string &record);
+
+    // Start the string table, appending a header record to the buffer
+    void m_startTable(std::string &record);
+
+public:
+    // Constructor, the table is started by the first record
+    BinaryLogEncoder();
+
+    // Destructor
+    ~BinaryLogEncoder();
+
+    // Append the records of a served request to a buffer
+    void render(const IConnection &connection, const IClock &clock,
+                std::string &record);
+};
+
+#endif // BINARYLOGENCODER_HPP
+
+// Path: includes/logger/BinaryLogEncoder.hpp
@@ -0,0 +1,93 @@
+#ifndef BINARYLOGRECORD_HPP
+#define BINARYLOGRECORD_HPP
+
+/*
+ * BinaryLogRecord.hpp
+ * Layout of the binary access logs
+ *
+ * An access_log written with the "binary" format is a sequence of fixed-size
+ * records, each starting with a magic number and its type. Access records
+ * hold numbers only: the
+ * URI and the User-Agent are written once as string records, and referred to
+ * by their offset in the string table of the worker that wrote them. Workers
+ * share the log file, so every record carries the pid of its worker, and
+ * decoders keep one string table per pid.
+ *
+ * A worker starts its table with a header record, before its first string,
+ * and starts it again with a new header once it grew past
+ * BINARY_LOG_TABLE_SIZE bytes, so that neither side keeps every URI ever
+ * served. Decoders drop the table of a pid when they read its header.
+ *
+ * Workers append to the file on their own, and a write falling short can
+ * leave a record torn, with the records of another worker following it. The
+ * magic number starting every record lets decoders find the next record
+ * again: a record is only trusted if it is followed by a magic number or the
+ * end of the file, and the bytes up to the next magic number are skipped
+ * otherwise.
+ *
+ * Records are written in the byte order of the host, the magic number reads
+ * "WSAL" in a file written on a little-endian host.
+ *
+ * webserv-logcat decodes these files back to text or JSON lines.
+ */
+
+#include <stdint.h>
+
+// Magic number starting every record
+#define BINARY_LOG_MAGIC 0x4c415357
+
+// Version of the layout
+#define BINARY_LOG_VERSION 2
+
+// Record types
+#define BINARY_LOG_HEADER 'H'
+#define BINARY_LOG_STRING 'S'
+#define BINARY_LOG_ACCESS 'A'
+
+// Size of the string table after which a worker starts it again
+#define BINARY_LOG_TABLE_SIZE (1 << 20)
+
+// Header record, starting the string table of a worker
+struct BinaryLogHeader
+{
+    uint32_t magic;    // BINARY_LOG_MAGIC
+    uint8_t type;      // BINARY_LOG_HEADER
+    uint8_t version;   // BINARY_LOG_VERSION
+    uint16_t reserved; // Zero
+    uint32_t pid;      // Worker writing the records that follow
+};
+
+// String record, followed by the characters of the string
+struct BinaryLogString
+{
+    uint32_t magic;     // BINARY_LOG_MAGIC
+    uint8_t type;       // BINARY_LOG_STRING
+    uint8_t reserved;   // Zero
+    uint16_t reserved2; // Zero
+    uint32_t pid;       // Worker the string table belongs to
+    uint32_t offset;    // Offset of the string in the table, where each
+                        // string is followed by a NUL
+    uint32_t length;    // Number of characters that follow, at most
+                        // BINARY_LOG_TABLE_SIZE
+};
+
+// Access record, one per request
+struct BinaryLogAccess
+{
+    uint32_t magic;      // BINARY_LOG_MAGIC
+    uint8_t type;        // BINARY_LOG_ACCESS
+    uint8_t method;      // HttpMethod of the request
+    uint16_t status;     // Status code of the response
+    uint32_t pid;        // Worker that served the request
+    uint32_t client_ip;  // IPv4 address of the client, 0 if unknown
+    uint64_t time;       // Time of the response, microseconds since the epoch
+    uint64_t bytes_sent; // Bytes sent to the client, head included
+    uint32_t duration;   // Microseconds since the first bytes of the request
+    uint32_t uri;        // Offset of the request URI in the string table
+    uint32_t user_agent; // Offset of the User-Agent in the string table
+    uint32_t reserved;   // Zero
+};
+
+#endif // BINARYLOGRECORD_HPP
+
+// Path: includes/logger/BinaryLogRecord.hpp
@@ -10,6 +10,13 @@
  * ILogger allows for polymorphic behavior and dependency injection,
  * thereby enabling us to create a MockLogger class for isolated unit testing.
  *
+ * Messages below WARN should be logged with the LOG macro, which checks the
+ * level before the message is built: a filtered out message costs a single
+ * call, instead of the strings concatenated for it.
+ *
+ * Example:
+ * LOG(m_logger, VERBOSE, "Socket: " + Converter::toString(socket));
+ *
  */
 
 #include "../constants/LogLevelHelper.hpp"
@@ -19,6 +26,15 @@
 class IConnection;
 class ILoggerConfiguration;
 
+// Log a message only if its level is enabled, the message is not evaluated
+// otherwise
+#define LOG(logger, level, message)                                            \
+    do                                                                         \
+    {                                                                          \
+        if ((logger).isEnabled(level))                                         \
+            (logger).log(level, message);                                      \
+    } while (0)
+
 // Logger interface
 class ILogger
 {
@@ -31,6 +47,10 @@ public:
                     const std::string &) = 0; // Method to log error messages
     virtual int log(const IConnection &) = 0; // Method to log access events
 
+    // Level check
+    virtual bool isEnabled(const LogLevel) const = 0; // Method to check if a
+                                                      // log level is logged
+
     // Configuration method
     virtual void configure(ILoggerConfiguration &) = 0; // Method to configure
                                                         // the Logger instance
@@ -6,6 +6,19 @@
 
 #include <string>
 
+class LogFormat;
+class BinaryLogEncoder;
+
+// Access log of a server block
+struct AccessLog
+{
+    std::string server_name;   // First server_name of the block
+    std::string listen;        // listen of the block
+    int file_descriptor;       // Log file, or -2 if access_log is off
+    const LogFormat *format;   // Format of the text records
+    BinaryLogEncoder *encoder; // Encoder of the binary records, or NULL
+};
+
 class ILoggerConfiguration
 {
 public:
@@ -21,6 +34,10 @@ public:
     virtual LogLevel getLogLevel() const = 0;
     virtual bool getErrorLogEnabled() const = 0;
     virtual bool getAccessLogEnabled() const = 0;
+    virtual bool getAsyncEnabled() const = 0;
+    virtual const AccessLog &
+    getAccessLog(const std::string &host_name,
+                 const std::string &host_port) const = 0;
     virtual void requestFlush(int descriptor) = 0;
 };
 
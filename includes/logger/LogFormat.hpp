@@ -0,0 +1,97 @@
+#ifndef LOGFORMAT_HPP
+#define LOGFORMAT_HPP
+
+/*
+ * LogFormat.hpp
+ * Access log format, compiled once from a log_format directive
+ *
+ * A format is a string of literals and nginx-style variables, such as
+ * '$remote_addr - $remote_user [$time_local] "$request" $status'. It is
+ * compiled when the configuration is loaded into a list of segments, each
+ * either a literal or the getter of a variable, so that rendering a record
+ * only appends strings to a buffer the Logger reuses. Empty values are
+ * rendered as "-", and quotes, backslashes, control and non-ASCII bytes in
+ * values are written as \xHH, as nginx does, so that a header can not break
+ * the quoted fields of a record.
+ *
+ * Supported variables: $remote_addr, $remote_port, $remote_user,
+ * $time_local, $time_iso8601, $msec, $request, $request_method, $request_uri,
+ * $uri, $query_string, $server_protocol, $host, $status, $body_bytes_sent,
+ * $bytes_sent, $request_time, $connection_requests and $http_<header>.
+ * $request_uri is the URI as received, with its query string, and $uri its
+ * path alone; webserv neither decodes nor normalizes either. $remote_user is
+ * always "-", as is $http_<header> for headers webserv does not know. Any
+ * other variable is a configuration error, UnknownLogVariableError being
+ * thrown when the format is compiled.
+ *
+ * With escape=json, the values are escaped to be written inside JSON strings
+ * and empty values are left empty. The built-in "json" format writes one JSON
+ * object per request this way.
+ */
+
+#include "../connection/IConnection.hpp"
+#include "../constants/HttpHeaderHelper.hpp"
+#include "../core/IClock.hpp"
+#include <string>
+#include <vector>
+
+// Format used when an access_log names none, the nginx "combined" format
+#define LOG_FORMAT_COMBINED                                                    \
+    "$remote_addr - $remote_user [$time_local] \"$request\" $status "          \
+    "$body_bytes_sent \"$http_referer\" \"$http_user_agent\""
+
+// Format of the json access logs, one JSON object per line
+#define LOG_FORMAT_JSON                                                        \
+    "{\"time\":\"$time_iso8601\",\"msec\":$msec,"                              \
+    "\"remote_addr\":\"$remote_addr\",\"method\":\"$request_method\","         \
+    "\"uri\":\"$request_uri\",\"status\":$status,\"bytes_sent\":$bytes_sent,"  \
+    "\"request_time\":$request_time,\"user_agent\":\"$http_user_agent\"}"
+
+// Getter appending the value of a variable to a record
+typedef void (*LogVariableGetter)(const IConnection &connection,
+                                  const IClock &clock, HttpHeader header,
+                                  std::string &record);
+
+// Literal or variable of a format
+struct LogFormatSegment
+{
+    std::string literal;      // Text appended as is, if there is no getter
+    LogVariableGetter getter; // Getter of the variable, or NULL
+    HttpHeader header;        // Header read by the $http_ getter
+};
+
+class LogFormat
+{
+private:
+    std::vector<LogFormatSegment> m_segments;
+    bool m_escape_json; // Escape the values for JSON strings
+
+    // Compile a format into segments
+    void m_compile(const std::string &format);
+
+    // Add a literal segment, merged with the previous one if it is a literal
+    void m_addLiteral(const std::string &literal);
+
+    // Add the segment of a variable, throws UnknownLogVariableError if the
+    // name is none of the supported ones
+    void m_addVariable(const std::string &name);
+
+public:
+    // Constructor, compiles the combined format
+    LogFormat();
+
+    // Constructor, compiles a format, escaping the values for JSON strings
+    // with escape=json
+    LogFormat(const std::string &format, bool escape_json = false);
+
+    // Destructor
+    ~LogFormat();
+
+    // Append the record of a served request to a buffer
+    void render(const IConnection &connection, const IClock &clock,
+                std::string &record) const;
+};
+
+#endif // LOGFORMAT_HPP
+
+// Path: includes/logger/LogFormat.hpp
@@ -34,23 +34,33 @@
  * - Classes with access to the access Logger instance can log access events
  * using the log() method.
  *
+ * Asynchronous Logging:
+ * With log_async on, the records are handed to an AsyncLogWriter instead, and
+ * written to the log files by a dedicated thread. The records written before
+ * the Logger is configured, or while log files are disabled, keep going
+ * through the buffer and are copied to stderr.
+ *
  * Example error log:
  * m_logger.log(INFO, "listening on port 8080");
  * Output in error log: timestamp="2011-01-01T01:11:11" level="[info]"
  * message="listening on port 8080"
  *
  * Example access log:
- * m_logger.log(request, response);
- * Output in access log: timestamp="2011-01-01T01:11:11" clientIP="127.0.0.1"
- * method="GET" requestURI="/index.php" httpVersion="HTTP/1.1" etc.
+ * m_logger.log(connection);
+ * Output in access log, with the combined format of the server:
+ * 127.0.0.1 - - [01/Jan/2011:01:11:11 +0000] "GET /index.php HTTP/1.1" 200
+ * 612 "-" "curl/8.0"
  */
 
 #include "../buffer/IBufferManager.hpp"
 #include "../connection/IConnection.hpp"
 #include "../constants/LogLevelHelper.hpp"
+#include "../core/IClock.hpp"
 #include "ILogger.hpp"
+#include "AsyncLogWriter.hpp"
+#include "BinaryLogEncoder.hpp"
 #include "ILoggerConfiguration.hpp"
-#include <sstream>
+#include "LogFormat.hpp"
 #include <string>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -60,22 +70,25 @@ class Logger : public ILogger
 private:
     ILoggerConfiguration *m_configuration;
     IBufferManager &m_buffer_manager;
+    IClock &m_clock;
     const LogLevelHelper m_log_level_helper;
+    AsyncLogWriter m_async_writer;
+    const LogFormat m_default_format;   // Format used until configured
+    std::string m_access_record;        // Access record, reused by records
+    std::vector<char> m_message_vector; // Message handed to the buffers
 
     // Private methods
-    std::string
+    const std::string &
     m_getCurrentTimestamp() const; // Method to get the current timestamp
-    void m_appendMapToLog(std::ostringstream &ss, const std::string &field_name,
-                          const std::map<std::string, std::string> &data_map)
-        const; // Method to append a map to the log message
     int m_pushToBuffer(const std::string &log_message,
                        const int file_descriptor); // Method to push log
                                                    // messages to the buffer
+    bool m_startAsyncWriter(); // Method to start the writer thread
 
 public:
     // Constructors and Destructor
-    Logger(IBufferManager &buffer_manager); // Constructor
-    virtual ~Logger();                      // Destructor
+    Logger(IBufferManager &buffer_manager, IClock &clock); // Constructor
+    virtual ~Logger();                                     // Destructor
 
     // Getter method
     // virtual int getLogFileDescriptor() const; // Getter method for log file
@@ -89,6 +102,10 @@ public:
     virtual int
     log(const IConnection &connection); // Method to log access events
 
+    // Level check
+    virtual bool isEnabled(const LogLevel logLevel)
+        const; // Method to check if a log level is logged
+
     // Configuration method
     virtual void
     configure(ILoggerConfiguration
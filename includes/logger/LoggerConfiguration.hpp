@@ -7,12 +7,27 @@
  *
  * It expects the following configuration directives:
  *   - in the main block: error_log <path> <level>
- *   - in the http block: access_log <path>
+ *   - in the http block: log_format <name> [escape=json] <format>, see
+ *     LogFormat.hpp
+ *   - in the server blocks: access_log <path> [<format name>], the records
+ *     of a server going to its own file in the named format, "combined" by
+ *     default
+ *   - in the main block: log_async on|off, to write the logs from a
+ *     dedicated thread rather than from the event loop (default off)
  *
  * To disable error logging, set the error_log directive to "off": 'error_log
  * off' To disable access logging, set the access_log directive to "off":
  * 'access_log off'
  *
+ * NOTE: the configuration is split on whitespace, so the quoted strings of a
+ * format are glued back with single spaces. Several log_format directives are
+ * told apart by their name, the first unquoted word without a variable.
+ *
+ * Besides the formats of the configuration, "combined" writes the nginx
+ * combined format, "json" one JSON object per line, and "binary" the fixed
+ * size records of BinaryLogRecord.hpp, decoded by webserv-logcat. The servers
+ * sharing a file should share its format.
+ *
  * NOTE: supported log levels currently are: exhaustive, verbose, debug, info,
  * warn, error, critical
  */
@@ -26,8 +41,12 @@
 #include "../configuration/IConfiguration.hpp"
 #include "../constants/LogLevelHelper.hpp"
 #include "../pollfd/IPollfdManager.hpp"
+#include "BinaryLogEncoder.hpp"
 #include "ILoggerConfiguration.hpp"
+#include "LogFormat.hpp"
 #include <fcntl.h>
+#include <map>
+#include <vector>
 
 class LoggerConfiguration : public ILoggerConfiguration
 {
@@ -42,7 +61,22 @@ private:
     int m_access_log_file_descriptor;
     bool m_error_log_enabled;
     bool m_access_log_enabled;
+    bool m_async_enabled;
     LogLevelHelper m_log_level_helper;
+    std::map<std::string, LogFormat> m_log_formats; // Formats by name
+    std::vector<AccessLog> m_access_logs;           // One per server block
+    std::map<std::string, int> m_access_log_files;  // Files opened, by path
+    std::map<std::string, BinaryLogEncoder>
+        m_binary_encoders; // Encoders of the binary files, by path
+
+    // Compile the log_format directives of the http block
+    void m_loadLogFormats(const IConfiguration &http);
+
+    // Read the access_log directive of a server block
+    void m_loadAccessLog(const IConfiguration &server);
+
+    // Open a log file, once for all the servers sharing it
+    int m_openAccessLogFile(const std::string &path);
 
 public:
     LoggerConfiguration(IBufferManager &buffer_manager,
@@ -60,6 +94,9 @@ public:
     virtual LogLevel getLogLevel() const;
     virtual bool getErrorLogEnabled() const;
     virtual bool getAccessLogEnabled() const;
+    virtual bool getAsyncEnabled() const;
+    virtual const AccessLog &getAccessLog(const std::string &host_name,
+                                          const std::string &host_port) const;
     virtual void requestFlush(int descriptor);
 };
 
@@ -12,6 +12,8 @@
 
 #include <string>
 #include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
 #include <vector>
 
 // Interface for socket operations
@@ -47,12 +49,30 @@ public:
     virtual int sendAll(int recipient_socket_fd,
                         const std::vector<char> &data) const = 0;
 
+    // Sends the content of several buffers over the socket at once
+    virtual ssize_t writev(int recipient_socket_fd, const struct iovec *iov,
+                           int iovcnt, bool blocking = false) const = 0;
+
+    // Sends data over the socket, holding it back to be coalesced with the data
+    // sent next
+    virtual int sendMore(int recipient_socket_fd,
+                         const std::vector<char> &data) const = 0;
+
+    // Sends up to count bytes of a file over the socket, starting at offset
+    // and advancing it past the bytes sent
+    virtual ssize_t sendFile(int recipient_socket_fd, int file_descriptor,
+                             off_t &offset, size_t count) const = 0;
+
     // Receives data from the socket
     virtual ssize_t recv(int socket_descriptor, char *buffer,
                          size_t len) const = 0;
 
     // Forcibly bind a socket to a port in use
     virtual int setReuseAddr(int fd) const = 0;
+
+    // Let several sockets bind the same port, the kernel spreading the
+    // incoming connections between them
+    virtual int setReusePort(int fd) const = 0;
 };
 
 #endif // ISOCKET_HPP
@@ -29,6 +29,7 @@ private:
     IConnectionManager
         &m_connection_manager; // Reference to the ConnectionManager
     ILogger &m_logger;         // Reference to the error logger
+    bool m_reuse_port; // Whether worker processes share the endpoints
 
     void m_initializeServerSocket(
         int ip, int port,
@@ -0,0 +1,87 @@
+#ifndef EPOLLPOLLFDMANAGER_HPP
+#define EPOLLPOLLFDMANAGER_HPP
+
+/*
+ * EpollPollfdManager.hpp
+ *
+ * This file defines the EpollPollfdManager class, a PollfdManager that mirrors
+ * every registration of the PollfdQueue into an epoll instance. The PollfdQueue
+ * stays the owner of the descriptors and their types, while the epoll instance
+ * lets the EpollPollingService retrieve only the ready descriptors instead of
+ * scanning the whole set on every cycle.
+ *
+ * NOTE - epoll refuses regular files (EPERM). They are always ready for I/O, so
+ * they are kept aside and reported ready on every cycle by the polling
+ * service.
+ *
+ * With 'edge_triggered on;' in the events block, client sockets and pipes are
+ * registered with EPOLLET: readiness is only reported when it changes, so their
+ * handlers must drain them until they would block.
+ */
+
+#ifdef __linux__
+
+#include "PollfdManager.hpp" // Include the header file for PollfdManager
+#include <sys/epoll.h>       // Include the epoll library
+
+class EpollPollfdManager : public PollfdManager
+{
+private:
+    int m_epoll_descriptor; // Descriptor of the epoll instance
+    bool m_edge_triggered;  // Whether sockets and pipes use EPOLLET
+    std::vector<int>
+        m_regular_file_descriptors; // Descriptors epoll cannot watch
+    ILogger &m_logger;              // Reference to the logger object
+
+    // Method to translate the poll events of a descriptor to epoll events
+    uint32_t m_toEpollEvents(short events, int position);
+
+    // Method to update the registration of a descriptor after its events
+    // changed
+    void m_updateRegistration(int position);
+
+protected:
+    // Method to add a polling file descriptor
+    virtual void m_addPollfd(pollfd pollFd);
+
+public:
+    // Constructor for EpollPollfdManager class
+    EpollPollfdManager(IConfiguration &configuration, ILogger &logger,
+                       DescriptorTable &descriptors);
+
+    // Destructor for EpollPollfdManager class
+    ~EpollPollfdManager();
+
+    // Method to remove a polling file descriptor
+    virtual void removePollfd(int position);
+
+    // Method to add the POLLOUT event for a specific position in the
+    // PollfdQueue
+    virtual void addPollOut(int position);
+
+    // Method to remove the POLLOUT event for a specific position in the
+    // PollfdQueue
+    virtual void removePollOut(int position);
+
+    // Method to add the POLLIN event for a specific position in the
+    // PollfdQueue
+    virtual void addPollIn(int position);
+
+    // Method to remove the POLLIN event for a specific position in the
+    // PollfdQueue
+    virtual void removePollIn(int position);
+
+    // Method to check if readiness is only reported on state changes
+    virtual bool isEdgeTriggered() const;
+
+    // Method to get the descriptor of the epoll instance
+    int getEpollDescriptor() const;
+
+    // Method to get the regular file descriptors, which are always ready
+    const std::vector<int> &getRegularFileDescriptors() const;
+};
+
+#endif // __linux__
+
+#endif // EPOLLPOLLFDMANAGER_HPP
+// Path: includes/pollfd/EpollPollfdManager.hpp
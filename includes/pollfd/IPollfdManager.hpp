@@ -14,6 +14,7 @@
 
 #include <cstddef>
 #include <poll.h>
+#include <vector>
 
 enum DescriptorType
 {
@@ -30,8 +31,6 @@ public:
 
     // Method to add a regular file pollfd to the pollfdQueue
     virtual void addRegularFilePollfd(pollfd pollfd) = 0;
-    virtual void addBodyFilePollfd(pollfd pollfd) = 0;
-    virtual bool isBodyFile(int position) = 0;
 
     // Method to add a server socket pollfd to the pollfdQueue
     virtual void addServerSocketPollfd(pollfd pollfd) = 0;
@@ -49,6 +48,18 @@ public:
     // pollfdQueue
     virtual void addPollOut(int position) = 0;
 
+    // Method to remove the POLLOUT event for a specific position in the
+    // pollfdQueue
+    virtual void removePollOut(int position) = 0;
+
+    // Method to add the POLLIN event for a specific position in the
+    // pollfdQueue
+    virtual void addPollIn(int position) = 0;
+
+    // Method to remove the POLLIN event for a specific position in the
+    // pollfdQueue, a client not being read while its response is pending
+    virtual void removePollIn(int position) = 0;
+
     // Method to close all file descriptors in the pollfdQueue
     virtual void closeAllFileDescriptors() = 0;
 
@@ -70,6 +81,18 @@ public:
 
     // Method to get the current pollfd queue index given a file descriptor
     virtual int getPollfdQueueIndex(int fd) = 0;
+
+    // Method to register a descriptor reported ready by the polling service
+    virtual void addReadyDescriptor(int fd) = 0;
+
+    // Method to clear the descriptors reported ready in the last poll cycle
+    virtual void clearReadyDescriptors() = 0;
+
+    // Method to get the descriptors reported ready in the last poll cycle
+    virtual const std::vector<int> &getReadyDescriptors() const = 0;
+
+    // Method to check if readiness is only reported on state changes
+    virtual bool isEdgeTriggered() const = 0;
 };
 
 #endif // IPOLLFDMANAGER_HPP
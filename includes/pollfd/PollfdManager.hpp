@@ -19,9 +19,9 @@
 
 #include "../configuration/BlockList.hpp"
 #include "../configuration/IConfiguration.hpp" // Include the header file for IConfiguration
+#include "../core/DescriptorTable.hpp" // Include the DescriptorTable
 #include "IPollfdManager.hpp" // Include the header file for IPollfdManager
 #include "PollfdQueue.hpp"    // Include the header file for PollfdQueue
-#include <map>                // Include the map library
 
 // Forward declaration of Server class
 class IServer;
@@ -30,26 +30,26 @@ class IServer;
 class PollfdManager : public IPollfdManager
 {
 private:
-    PollfdQueue m_pollfds; // Queue for storing polling file descriptors
-    std::map<int, DescriptorType>
-        m_descriptor_type_map; // Map for storing the type of descriptor
-    ILogger &m_logger;         // Reference to the logger object
-    std::vector<int> m_body_file_descriptors;
+    PollfdQueue m_pollfds;          // Queue of the polled descriptors
+    ILogger &m_logger;              // Reference to the logger object
+    DescriptorTable &m_descriptors; // Queue index and type by descriptor
+    std::vector<int>
+        m_ready_descriptors; // Descriptors ready in the last poll cycle
 
+protected:
     // Method to add a polling file descriptor
     virtual void m_addPollfd(pollfd pollFd);
 
 public:
     // Constructor for PollfdManager class
-    PollfdManager(IConfiguration &configuration, ILogger &logger);
+    PollfdManager(IConfiguration &configuration, ILogger &logger,
+                  DescriptorTable &descriptors);
 
     // Destructor for PollfdManager class
     ~PollfdManager();
 
     // Method to add a regular file pollfd to the pollfdQueue
     virtual void addRegularFilePollfd(pollfd pollFd);
-    virtual void addBodyFilePollfd(pollfd pollfd);
-    virtual bool isBodyFile(int position);
 
     // Method to add a server socket pollfd to the pollfdQueue
     virtual void addServerSocketPollfd(pollfd pollFd);
@@ -67,6 +67,18 @@ public:
     // PollfdQueue
     virtual void addPollOut(int position);
 
+    // Method to remove the POLLOUT event for a specific position in the
+    // PollfdQueue
+    virtual void removePollOut(int position);
+
+    // Method to add the POLLIN event for a specific position in the
+    // PollfdQueue
+    virtual void addPollIn(int position);
+
+    // Method to remove the POLLIN event for a specific position in the
+    // PollfdQueue
+    virtual void removePollIn(int position);
+
     // Method to close all file descriptors in the PollfdQueue
     virtual void closeAllFileDescriptors();
 
@@ -88,6 +100,18 @@ public:
 
     // Method to get the current pollfd queue index given a file descriptor
     virtual int getPollfdQueueIndex(int fd);
+
+    // Method to register a descriptor reported ready by the polling service
+    virtual void addReadyDescriptor(int fd);
+
+    // Method to clear the descriptors reported ready in the last poll cycle
+    virtual void clearReadyDescriptors();
+
+    // Method to get the descriptors reported ready in the last poll cycle
+    virtual const std::vector<int> &getReadyDescriptors() const;
+
+    // Method to check if readiness is only reported on state changes
+    virtual bool isEdgeTriggered() const;
 };
 
 #endif // POLLFDMANAGER_HPP
@@ -89,6 +89,18 @@ public:
     // at the specified index.
     void pollout(size_t index);
 
+    // Pollin: Removes the POLLOUT event from the events field of the pollfd
+    // object at the specified index.
+    void pollin(size_t index);
+
+    // Unpollin: Removes the POLLIN event from the events field of the pollfd
+    // object at the specified index.
+    void unpollin(size_t index);
+
+    // Repollin: Adds the POLLIN event back to the events field of the pollfd
+    // object at the specified index.
+    void repollin(size_t index);
+
     // HasReachedCapacity: Checks if the PollfdQueue has reached its maximum
     // capacity. Returns true if the size equals the capacity, indicating that
     // no more pollfd objects can be added.
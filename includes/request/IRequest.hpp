@@ -18,9 +18,13 @@
 #include "../response/IRoute.hpp"
 #include <cstddef>
 #include <map>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
+class MultipartParser;
+class Arena;
+
 // BodyParameter represents a single part of a multipart/form-data request.
 // This can be a file (for upload) or a form field (for regular form data).
 struct BodyParameter
@@ -28,8 +32,10 @@ struct BodyParameter
     std::string filename;     // Name of the file; applicable for file uploads
     std::string content_type; // MIME type of the content; applicable for file
                               // uploads
-    std::vector<char> data;   // Data of the file or field; contains the content
-                              // of the part
+    std::vector<char> data;   // Data of the field; contains the content of the
+                              // part
+    std::string file_path;    // Temporary file holding the content of a file
+                              // part, written as it arrives
     std::string disposition_type; // Disposition type (e.g., "form-data",
                                   // "attachment", "inline")
     std::string field_name;       // Name of the form field; applicable for form
@@ -39,6 +45,71 @@ struct BodyParameter
                  // for both files and form fields
 };
 
+// Span of bytes in the receive buffer of a request
+struct BufferSpan
+{
+    size_t start;  // Offset of the first byte
+    size_t length; // Number of bytes
+};
+
+// Stages of the request head parser, named after what it expects next
+enum HeadParsingStage
+{
+    HEAD_LEADING_CRLF,    // Empty lines tolerated before the request line
+    HEAD_METHOD,          // Method, up to a space
+    HEAD_URI,             // URI, up to a space
+    HEAD_HTTP_VERSION,    // HTTP version, up to a CR
+    HEAD_REQUEST_LINE_LF, // LF ending the request line
+    HEAD_HEADER_START,    // First byte of a header line or of the empty line
+    HEAD_HEADER_NAME,     // Header name, up to a colon
+    HEAD_HEADER_VALUE,    // Header value, up to a CR
+    HEAD_HEADER_LF,       // LF ending a header line
+    HEAD_END_LF,          // LF ending the empty line
+    HEAD_DONE             // Head fully parsed
+};
+
+// Progress of the request head parser, kept across reads so that no byte is
+// scanned twice
+struct HeadParsingState
+{
+    HeadParsingStage stage;
+    size_t offset;      // Buffer bytes already scanned
+    size_t line_start;  // Start of the line being scanned
+    size_t token_start; // Start of the token being scanned
+    BufferSpan method;
+    BufferSpan uri;
+    BufferSpan http_version;
+    BufferSpan header_name; // Name of the header being scanned
+    std::vector<std::pair<BufferSpan, BufferSpan> >
+        headers; // Name and value of the headers scanned
+};
+
+// Stages of the chunked body decoder, named after what it expects next
+enum ChunkParsingStage
+{
+    CHUNK_SIZE,          // Hexadecimal size of the chunk
+    CHUNK_EXTENSION,     // Chunk extensions, up to a CR
+    CHUNK_SIZE_LF,       // LF ending the chunk size line
+    CHUNK_DATA,          // Data of the chunk
+    CHUNK_DATA_CR,       // CR ending the chunk data
+    CHUNK_DATA_LF,       // LF ending the chunk data
+    CHUNK_TRAILER_START, // First byte of a trailer field or of the empty line
+    CHUNK_TRAILER,       // Trailer field, up to a CR
+    CHUNK_TRAILER_LF,    // LF ending a trailer field
+    CHUNK_END_LF         // LF ending the empty line, and the body
+};
+
+// Progress of the chunked body decoder, kept across reads so that the buffer
+// only holds the bytes not decoded yet
+struct ChunkParsingState
+{
+    ChunkParsingStage stage;
+    size_t size;        // Size of the chunk
+    size_t size_digits; // Digits of the size scanned
+    size_t remaining;   // Bytes of chunk data still expected
+    size_t line_length; // Bytes of the size line or trailer field scanned
+};
+
 class RequestState
 {
 private:
@@ -48,6 +119,11 @@ private:
     bool m_headers;
     bool m_finished;
     IRoute *m_route;
+    HeadParsingState m_head;
+    ChunkParsingState m_chunk;
+
+    void m_resetHead(void);
+    void m_resetChunk(void);
 
 public:
     RequestState();
@@ -57,6 +133,8 @@ public:
     int getContentRed(void) const;
     int getContentLength(void) const;
     IRoute *getRoute(void) const;
+    HeadParsingState &getHead(void);
+    ChunkParsingState &getChunk(void);
 
     void finished(bool value);
     void headers(bool value);
@@ -81,6 +159,8 @@ public:
     virtual std::string getHttpVersionString() const = 0;
     virtual const std::map<HttpHeader, std::string> getHeaders() const = 0;
     virtual std::string getHeaderValue(HttpHeader header) const = 0;
+    virtual void appendHeaderValue(HttpHeader header,
+                                   std::string &string) const = 0;
     virtual std::map<std::string, std::string> getHeadersStringMap() const = 0;
     virtual std::map<std::string, std::string> getQueryParameters() const = 0;
     virtual std::map<std::string, std::string> getCookies() const = 0;
@@ -100,7 +180,11 @@ public:
     virtual RequestState &getState(void) = 0;
     virtual std::vector<char> &getBody(void) = 0;
     virtual std::string getBodyFilePath() const = 0;
+    virtual int getBodyFileDescriptor() const = 0;
     virtual const std::vector<char> &getBuffer() const = 0;
+    virtual MultipartParser &getMultipartParser(void) = 0;
+    virtual Arena &getArena(void) const = 0;
+    virtual uint64_t getStartTime() const = 0;
 
     // Setters
     virtual void setMethod(const std::string &method) = 0;
@@ -108,10 +192,14 @@ public:
     virtual void setHttpVersion(const std::string &http_version) = 0;
     virtual void addHeader(const std::string &key,
                            const std::string &value) = 0;
+    virtual void addHeader(const std::string &key, const char *value,
+                           size_t size) = 0;
     virtual void setBody(const std::vector<char> &body) = 0;
     virtual void setBody(const std::string &body) = 0;
     virtual void addCookie(const std::string &key,
                            const std::string &value) = 0;
+    virtual void addCookie(const char *key, size_t key_size, const char *value,
+                           size_t value_size) = 0;
     virtual void setAuthority() = 0;
     virtual void addBodyParameter(const BodyParameter &body_parameter) = 0;
     virtual void setUploadRequest(bool upload_request) = 0;
@@ -121,6 +209,7 @@ public:
     virtual void clearBuffer() = 0;
     virtual void trimBuffer(ptrdiff_t) = 0;
     virtual void setBodyFilePath(const std::string &body_file_path) = 0;
+    virtual void setBodyFileDescriptor(int body_file_descriptor) = 0;
 };
 
 #endif // IREQUEST_HPP
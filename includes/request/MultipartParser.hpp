@@ -0,0 +1,115 @@
+#ifndef MULTIPARTPARSER_HPP
+#define MULTIPARTPARSER_HPP
+
+/*
+ * MultipartParser.hpp
+ *
+ * Parses a multipart/form-data body as it arrives, one read at a time.
+ * File parts are written straight to a temporary file in client_body_temp_path,
+ * so an upload is never held in memory nor served half-written, and renamed to
+ * their final name by the upload response generator once the request is
+ * complete: the directory must be on the same filesystem as the upload roots.
+ * Form fields are kept in memory, up to client_body_buffer_size bytes in all.
+ * Only the bytes that could be the start of a boundary split between two reads
+ * are held back until the next read.
+ *
+ */
+
+#include "../utils/DelimiterScanner.hpp"
+#include "IRequest.hpp"
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Maximum length of a part header line
+#define MULTIPART_MAX_HEADER_LINE 8192
+
+// Prefix of the temporary files uploads are written to
+#define MULTIPART_TEMPORARY_PREFIX ".upload_"
+
+// Stages of the multipart parser, named after what it expects next
+enum MultipartStage
+{
+    MULTIPART_IDLE,         // Not a multipart body, or not started
+    MULTIPART_PREAMBLE,     // Anything up to the first boundary
+    MULTIPART_BOUNDARY_END, // "--" closing the body or CRLF after a boundary
+    MULTIPART_HEADERS,      // Header lines of a part, up to an empty line
+    MULTIPART_DATA,         // Data of a part, up to the next boundary
+    MULTIPART_DONE          // Closing boundary seen, the rest is ignored
+};
+
+class MultipartParser
+{
+private:
+    MultipartStage m_stage;
+    std::string m_delimiter;        // CRLF, "--" and the boundary
+    std::string m_temporary_directory; // Directory the files are written to
+    size_t m_max_field_size; // Bytes of form fields kept at most, in all
+    size_t m_field_size;     // Bytes of form fields kept
+    std::vector<char> m_pending;    // Bytes held back until the next read
+    BodyParameter m_part;           // Part being parsed
+    int m_file_descriptor;          // Temporary file of the part, or -1
+    std::vector<std::pair<std::string, ino_t> >
+        m_files; // Temporary files written, with their inode
+    const DelimiterScanner m_carriage_return_scanner; // CR
+
+    // Parse as many bytes as possible, returns the number of bytes consumed
+    size_t m_parse(IRequest &request, const char *data, size_t size);
+
+    // Find the next boundary, the start of a boundary cut off by the end of
+    // the data, or the end of the data
+    const char *m_findDelimiter(const char *begin, const char *end) const;
+
+    // Parse a header line of the part
+    void m_parseHeaderLine(const std::string &line);
+
+    // Open the temporary file of a file part
+    void m_startPart();
+
+    // Write data of the part to its file or to its parameter
+    void m_writePart(const char *data, size_t size);
+
+    // Close the part and hand it over to the request
+    void m_finishPart(IRequest &request);
+
+    // Close the file of an unfinished part and remove the temporary files
+    // not renamed
+    void m_removeFiles();
+
+    // Trim leading and trailing whitespace from a string
+    static std::string m_trimWhitespace(const std::string &string);
+
+    // Remove quotes from a string
+    static void m_removeQuotes(std::string &string);
+
+    MultipartParser(const MultipartParser &src);
+    MultipartParser &operator=(const MultipartParser &src);
+
+public:
+    // Constructor
+    MultipartParser();
+
+    // Destructor, removes the temporary files not renamed
+    ~MultipartParser();
+
+    // Start parsing a body with a boundary, writing files to a temporary
+    // directory and keeping at most max_field_size bytes of form fields
+    void begin(const std::string &boundary,
+               const std::string &temporary_directory, size_t max_field_size);
+
+    // Parse the next bytes of the body
+    void feed(IRequest &request, const char *data, size_t size);
+
+    // Forget the body, so that the parser can be reused for another request
+    void reset();
+
+    // Check if the parser was started
+    bool started() const;
+
+    // Check if the closing boundary was parsed
+    bool done() const;
+};
+
+#endif // MULTIPARTPARSER_HPP
+
+// Path: includes/request/MultipartParser.hpp
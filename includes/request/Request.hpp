@@ -35,22 +35,46 @@
 
 #include "../configuration/IConfiguration.hpp"
 #include "../constants/HttpHelper.hpp"
+#include "../core/IClock.hpp"
+#include "../utils/Arena.hpp"
 #include "IRequest.hpp"
+#include "MultipartParser.hpp"
 #include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
 
+// Capacity of the buffers kept by a request reset for reuse, larger buffers
+// are freed so that a pooled request does not pin a large body
+#define REQUEST_RETAINED_CAPACITY 65536
+
 class Request : public IRequest
 {
 private:
+    // Headers, keyed by their enum, with nodes and values drawn from the
+    // arena
+    typedef std::map<HttpHeader, ArenaString, std::less<HttpHeader>,
+                     ArenaAllocator<std::pair<const HttpHeader, ArenaString> > >
+        HeaderMap_t;
+
+    // Cookies, keyed by their name, with nodes, names and values drawn from
+    // the arena
+    typedef std::map<
+        ArenaString, ArenaString, ArenaStringLess,
+        ArenaAllocator<std::pair<const ArenaString, ArenaString> > >
+        CookieMap_t;
+
+    // Arena for the short-lived allocations of the request, reset with it
+    // Declared first, so that it outlives the containers drawing from it
+    mutable Arena m_arena;
+
     // Request line components
     HttpMethod m_method;
     std::string m_uri;
     HttpVersion m_http_version;
 
     // Request headers
-    std::map<HttpHeader, std::string> m_headers;
+    HeaderMap_t m_headers;
 
     // Request body
     std::vector<char> m_body;
@@ -64,7 +88,7 @@ private:
     std::string m_authority;
     std::map<std::string, std::string> m_query_parameters;
     std::pair<std::string, std::string> m_remote_address;
-    std::map<std::string, std::string> m_cookies;
+    CookieMap_t m_cookies;
     std::vector<BodyParameter> m_body_parameters;
     bool m_upload_request;
     std::string m_request_id;
@@ -73,20 +97,40 @@ private:
 
     // Helper
     const HttpHelper &m_http_helper;
+    const IClock &m_clock;
     RequestState m_state;
 
+    // Time the first bytes of the request were buffered, in microseconds
+    uint64_t m_start_time;
+
     // Body File Path
     std::string m_body_file_path;
 
+    // Body File Descriptor, open while the body is written to the file
+    int m_body_file_descriptor;
+
+    // Parser streaming a multipart body to the upload directory
+    MultipartParser m_multipart_parser;
+
+    // Empty a buffer, freeing it if it grew past the retained capacity
+    static void m_clearBuffer(std::vector<char> &buffer);
+
+    // Close and remove the body file
+    void m_removeBodyFile();
+
 public:
     // Constructor and Destructor
-    Request(const IConfiguration &configuration, const HttpHelper &http_helper);
+    Request(const IConfiguration &configuration, const HttpHelper &http_helper,
+            const IClock &clock);
     Request(const Request &src);
     ~Request();
 
     // Assignment operator
     Request &operator=(const Request &src);
 
+    // Forget the request, so that it can be reused for the next one
+    void reset();
+
     // Getters
     HttpMethod getMethod() const;
     std::string getMethodString() const;
@@ -95,6 +139,7 @@ public:
     std::string getHttpVersionString() const;
     const std::map<HttpHeader, std::string> getHeaders() const;
     std::string getHeaderValue(HttpHeader header) const;
+    void appendHeaderValue(HttpHeader header, std::string &string) const;
     std::map<std::string, std::string> getHeadersStringMap() const;
     std::map<std::string, std::string> getQueryParameters() const;
     std::map<std::string, std::string> getCookies() const;
@@ -115,16 +160,23 @@ public:
     RequestState &getState(void);
     const std::vector<char> &getBuffer() const;
     std::string getBodyFilePath() const;
+    int getBodyFileDescriptor() const;
+    MultipartParser &getMultipartParser(void);
+    Arena &getArena(void) const;
+    uint64_t getStartTime() const;
 
     // Setters
     void setMethod(const std::string &method);
     void setUri(const std::string &uri);
     void setHttpVersion(const std::string &http_version);
     void addHeader(const std::string &key, const std::string &value);
+    void addHeader(const std::string &key, const char *value, size_t size);
     void setBody(const std::vector<char> &body);
     void setBody(const std::string &body);
     void addBodyChar(char value);
     void addCookie(const std::string &key, const std::string &value);
+    void addCookie(const char *key, size_t key_size, const char *value,
+                   size_t value_size);
     void setAuthority();
     void addBodyParameter(const BodyParameter &body_parameter);
     void setUploadRequest(bool upload_request);
@@ -134,6 +186,7 @@ public:
     void clearBuffer(void);
     void trimBuffer(ptrdiff_t new_start);
     void setBodyFilePath(const std::string &body_file_path);
+    void setBodyFileDescriptor(int body_file_descriptor);
 };
 
 #endif // REQUEST_HPP
@@ -12,6 +12,8 @@
 #include "../configuration/IConfiguration.hpp"
 #include "../logger/ILogger.hpp"
 #include "../request/IRequest.hpp"
+#include "../request/MultipartParser.hpp"
+#include "../utils/DelimiterScanner.hpp"
 #include <string>
 #include <vector>
 
@@ -22,75 +24,77 @@ private:
     const IConfiguration
         &m_configuration; // Reference to the server IConfiguration
 
-    // Function to parse the request line of an HTTP request
-    void m_parseRequestLine(std::vector<char>::const_iterator &it,
-                            const std::vector<char> &raw_request,
-                            IRequest &parsed_request) const;
-
-    // Functions to parse the components of the request line
-    std::string m_parseMethod(std::vector<char>::const_iterator &it,
-                              const std::vector<char> &raw_request) const;
-    std::string m_parseUri(std::vector<char>::const_iterator &it,
-                           const std::vector<char> &raw_request) const;
-    std::string m_parseHttpVersion(std::vector<char>::const_iterator &it,
-                                   const std::vector<char> &raw_request) const;
-
-    // Function to parse the headers of an HTTP request
-    void m_parseHeaders(std::vector<char>::const_iterator &it,
-                        const std::vector<char> &raw_request,
-                        IRequest &parsed_request) const;
-
-    // Function to parse an individual header
-    void m_parseHeader(std::vector<char>::const_iterator &it,
-                       const std::vector<char> &raw_request,
-                       IRequest &parsed_request) const;
+    // Scanners for the delimiters ending the tokens of a request
+    const DelimiterScanner m_request_line_scanner; // SP, CR or LF
+    const DelimiterScanner m_header_name_scanner;  // ':', CR or LF
+    const DelimiterScanner m_line_end_scanner;     // CR or LF
+
+    // Limits, read once rather than looked up by name on every request
+    const size_t m_client_header_buffer_size; // Bytes of a header line
+    const size_t m_client_max_uri_size;       // Bytes of the URI
+    const size_t m_head_limit;                // Bytes of the head as a whole
+    const size_t m_client_body_buffer_size;   // Bytes of a body in memory
+    const std::string m_client_body_temp_path; // Directory of the uploads
+
+    // Function to add an individual header, its value staying in the buffer
+    void m_addHeader(const std::string &header_name, const char *header_value,
+                     size_t header_value_size, IRequest &parsed_request) const;
+
+    // Function to start streaming a multipart body to its route
+    void m_startMultipart(IRequest &request) const;
+
+    // Function to hand body bytes over to the multipart parser or the body
+    void m_appendBody(IRequest &request,
+                      std::vector<char>::const_iterator begin,
+                      std::vector<char>::const_iterator end) const;
+
+    // Function to write body bytes to the body file of the request
+    void m_writeBodyFile(IRequest &request, const char *data,
+                         size_t size) const;
+
+    // Function to mark the body as complete
+    void m_finishBody(IRequest &request) const;
 
     // Function to unchunk the body of an HTTP request
     void m_unchunkBody(const std::vector<char> &raw_request,
                        IRequest &request) const;
 
-    // Function to parse a Cookie header
-    void m_parseCookie(std::string &cookie_header_value,
+    // Function to parse a Cookie header, in place
+    void m_parseCookie(const char *cookie_header_value, size_t size,
                        IRequest &parsed_request) const;
 
-    // Function to check if a character is whitespace
-    bool m_isWhitespace(char c) const;
+    // Function to get the scanner finding the end of the token of a head
+    // parsing stage
+    const DelimiterScanner *m_getHeadScanner(HeadParsingStage stage) const;
 
-    // Function to check if an iterator points to CRLF (carriage return + line
-    // feed)
-    bool m_isCRLF(std::vector<char>::const_iterator it) const;
+    // Function to make a span of the bytes from start up to end
+    BufferSpan m_span(size_t start, size_t end) const;
 
-    // Function to check if an iterator points to a character that is in a given
-    // set
-    bool m_isCharInSet(std::vector<char>::const_iterator it,
-                       const std::string &set) const;
+    // Function to copy the bytes of a span out of the buffer
+    std::string m_spanString(const std::vector<char> &buffer,
+                             const BufferSpan &span) const;
 
     // Function to trim leading and trailing whitespace from a string
     std::string m_trimWhitespace(const std::string &string) const;
 
+    // Function to trim leading and trailing whitespace from the bytes
+    // between begin and end, moving them
+    void m_trimSpan(const char *&begin, const char *&end) const;
+
     // Function to remove quotes from a string
     void m_removeQuotes(std::string &string) const;
 
-    // Custom getline function to remove carriage returns
-    std::istream &m_getlineNoCr(std::istream &is, std::string &line) const;
-
-    // Function to read a stringstream into a char vector until the boundary is
-    // found
-    void m_assignUntilBoundary(std::istringstream &iss,
-                               const std::string &boundary,
-                               std::vector<char> &dest) const;
-
 public:
     // Constructor to initialize the RequestParser with required references
     RequestParser(const IConfiguration &configuration, ILogger &logger);
 
-    // Function to parse a raw HTTP request and convert it into a IRequest
-    // object
+    // Function to scan the head of a request as it arrives, returns true once
+    // it is complete, throws 431 once it outgrows large_client_header_buffers
+    bool parseHead(IRequest &request) const;
+    // Function to fill a IRequest object from its scanned head
     void parseRequest(IRequest &request) const;
-    // Function to parse the body of an HTTP request
+    // Function to parse the body of an HTTP request, once it is routed
     void parseBody(IRequest &parsed_request) const;
-    // Function to parse the Upload Chunked Body
-    void parseBodyParameters(IRequest &parsed_request) const;
 };
 
 #endif // REQUESTPARSER_HPP
@@ -3,14 +3,16 @@
 
 #include "../logger/ILogger.hpp"
 #include "IResponseGenerator.hpp"
+#include "OpenFileCache.hpp"
 
 class DeleteResponseGenerator : public IResponseGenerator
 {
 private:
     ILogger &m_logger;
+    OpenFileCache &m_open_file_cache;
 
 public:
-    DeleteResponseGenerator(ILogger &logger);
+    DeleteResponseGenerator(ILogger &logger, OpenFileCache &open_file_cache);
     ~DeleteResponseGenerator();
     Triplet_t generateResponse(const IRoute &route, const IRequest &request,
                                IResponse &response,
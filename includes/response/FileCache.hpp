@@ -0,0 +1,104 @@
+#ifndef FILECACHE_HPP
+#define FILECACHE_HPP
+
+/*
+ * FileCache.hpp
+ * In-memory cache of the hot static files
+ *
+ * Most GET requests ask for the same few files: the front page and its
+ * stylesheets, scripts and images. The cache keeps their body in memory along
+ * with the headers built from their metadata, so that serving them again
+ * neither opens, reads nor stats the file.
+ *
+ * Entries are keyed by the path the request resolved to before the index was
+ * appended, so that a directory request is served from the entry of its index
+ * file. An entry is checked against the file with stat once every
+ * file_cache_valid seconds, and dropped if its inode, size or modification
+ * time changed.
+ *
+ * The bodies are bounded by file_cache_size bytes, the least recently used
+ * entries being evicted first. Files larger than file_cache_max_file_size
+ * are never cached, and a size of 0 disables the cache.
+ */
+
+#include "../core/IClock.hpp"
+#include <list>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+// Cached file, with the headers built from its metadata
+struct FileCacheEntry
+{
+    std::string file_path;      // File the body was read from
+    std::vector<char> body;     // Content of the file
+    std::string content_type;   // Content-Type header
+    std::string content_encoding; // Content-Encoding header, empty if none
+    std::string content_length; // Content-Length header
+    std::string etag;           // ETag header
+    std::string last_modified;  // Last-Modified header
+    dev_t device;               // Device of the file, checked on validation
+    ino_t inode;                // Inode of the file, checked on validation
+    off_t size;                 // Size of the file, checked on validation
+    time_t modified;            // Modification time, checked on validation
+    time_t validated;           // Time of the last check against the file
+    std::list<std::string>::iterator position; // Position in the LRU list
+};
+
+class FileCache
+{
+private:
+    const IClock &m_clock;
+    const size_t m_size;          // Byte budget of the bodies, 0 if disabled
+    const size_t m_max_file_size; // Largest file cached
+    const time_t m_valid;         // Seconds an entry is trusted unchecked
+    size_t m_used;                // Bytes of the bodies cached
+
+    std::map<std::string, FileCacheEntry> m_entries; // Entries by key
+    std::list<std::string> m_lru; // Keys, most recently used first
+
+    // Remove an entry
+    void m_evict(std::map<std::string, FileCacheEntry>::iterator entry);
+
+    FileCache(const FileCache &src);
+    FileCache &operator=(const FileCache &src);
+
+public:
+    // Constructor
+    FileCache(const IClock &clock, size_t size, size_t max_file_size,
+              time_t valid);
+
+    // Destructor
+    ~FileCache();
+
+    // Get the entry of a key, checking it against the file if it was not
+    // checked recently
+    // Returns NULL if the key is not cached or the file changed
+    const FileCacheEntry *lookup(const std::string &key);
+
+    // Read a file, open by the caller, into the cache under a key, evicting
+    // the least recently used entries to make room
+    // Returns NULL if the file cannot be read or is not worth caching
+    const FileCacheEntry *load(const std::string &key,
+                               const std::string &file_path,
+                               int file_descriptor, const struct stat &info,
+                               const std::string &content_type,
+                               const std::string &content_encoding);
+
+    // Read a file from an offset, filling a body
+    // Returns false if the file ended before the body was full
+    static bool readFile(int file_descriptor, std::vector<char> &body,
+                         off_t offset = 0);
+
+    // Get the weak entity tag of a file, from its inode, size and
+    // modification time
+    static std::string makeEntityTag(const struct stat &info);
+
+    // Get the Last-Modified header of a file
+    static std::string makeLastModified(const struct stat &info);
+};
+
+#endif // FILECACHE_HPP
+
+// Path: includes/response/FileCache.hpp
@@ -39,6 +39,15 @@ public:
     virtual void setBody(std::string body) = 0;
     virtual void setBody(std::vector<char> body) = 0;
 
+    // File body, sent from its descriptor instead of being read into memory,
+    // size bytes from an offset
+    virtual void setBodyFile(int file_descriptor, off_t offset,
+                             size_t size) = 0;
+    virtual bool hasBodyFile() const = 0;
+    virtual int releaseBodyFile() = 0;
+    virtual off_t getBodyFileOffset() const = 0;
+    virtual size_t getContentLength() const = 0;
+
     // Set error response with appropriate status code
     virtual void setErrorResponse(HttpStatusCode status_code) = 0;
     virtual void setErrorResponse(int status_code) = 0;
@@ -59,6 +68,10 @@ public:
     // Convert headers to map or string
     virtual std::map<std::string, std::string> getHeadersStringMap() const = 0;
     virtual std::vector<char> serialise() = 0;
+    virtual std::vector<char> serialiseHead() = 0;
+
+    // Hand the in-memory body over to the caller, leaving it empty
+    virtual void releaseBody(std::vector<char> &body) = 0;
 
     // Append data to the buffer
     virtual void appendBuffer(std::vector<char> &data) = 0;
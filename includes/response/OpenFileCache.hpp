@@ -0,0 +1,108 @@
+#ifndef OPENFILECACHE_HPP
+#define OPENFILECACHE_HPP
+
+/*
+ * OpenFileCache.hpp
+ * Cache of the open descriptors, metadata and lookup errors of files
+ *
+ * Serving a static file resolves its path twice, once to check whether it is
+ * a directory and once to open it, and a missing asset is looked up again on
+ * every request. The cache keeps, by path, the descriptor of the regular
+ * files along with their stat result, the stat result of the directories and,
+ * with open_file_cache_errors, the errno of the failed lookups, so that the
+ * same path is only resolved again once open_file_cache_valid seconds have
+ * passed.
+ *
+ *   open_file_cache max=1000 inactive=20s;
+ *   open_file_cache_valid 30s;
+ *   open_file_cache_errors on;
+ *
+ * At most max entries are kept, the least recently used ones being closed
+ * first, and the entries not used for inactive seconds are closed as new
+ * lookups come. "open_file_cache off" disables the cache, every lookup then
+ * going to the filesystem.
+ *
+ * The cache belongs to a worker: a file changed by another worker or process
+ * is seen once the validity window is over, while the generators changing
+ * files themselves invalidate their paths.
+ */
+
+#include "../configuration/IConfiguration.hpp"
+#include "../core/IClock.hpp"
+#include <list>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+
+// Entries closed per lookup, once inactive
+#define OPEN_FILE_CACHE_EXPIRE 2
+
+// Cached lookup of a path
+struct OpenFileCacheEntry
+{
+    int file_descriptor; // Descriptor of a regular file, -1 otherwise
+    struct stat info;    // Metadata of the file, if found
+    int error;           // errno of the lookup, 0 if the file was found
+    time_t validated;    // Time of the lookup
+    time_t used;         // Time of the last use
+    std::list<std::string>::iterator position; // Position in the LRU list
+};
+
+class OpenFileCache
+{
+private:
+    const IClock &m_clock;
+    size_t m_max;       // Entries kept at most, 0 if disabled
+    time_t m_inactive;  // Seconds an unused entry is kept
+    time_t m_valid;     // Seconds an entry is trusted unchecked
+    bool m_errors;      // Cache the failed lookups as well
+
+    std::map<std::string, OpenFileCacheEntry> m_entries; // Entries by path
+    std::list<std::string> m_lru; // Paths, most recently used first
+
+    // Get the entry of a path, looking it up again if it is missing or was
+    // not checked recently
+    // Returns NULL if the lookup failed and errors are not cached, with errno
+    // set
+    const OpenFileCacheEntry *m_lookup(const std::string &path);
+
+    // Look a path up, filling an entry
+    static void m_load(const std::string &path, OpenFileCacheEntry &entry);
+
+    // Close the entries not used for too long, a few at a time
+    void m_expire(time_t now);
+
+    // Remove an entry, closing its descriptor
+    void m_evict(std::map<std::string, OpenFileCacheEntry>::iterator entry);
+
+    // Read the open_file_cache directives of the http block
+    void m_loadConfiguration(const IConfiguration &http);
+
+    // Parse a time such as 30, 30s, 5m, 1h or 1d into seconds
+    static time_t m_parseTime(const std::string &time);
+
+    OpenFileCache(const OpenFileCache &src);
+    OpenFileCache &operator=(const OpenFileCache &src);
+
+public:
+    // Constructor, reads the open_file_cache directives of the http block
+    OpenFileCache(const IClock &clock, const IConfiguration &http);
+
+    // Destructor, closes the cached descriptors
+    ~OpenFileCache();
+
+    // Get the metadata of a file, as stat does
+    // Returns -1 with errno set if the file cannot be found
+    int stat(const std::string &path, struct stat &info);
+
+    // Open a regular file for reading and get its metadata
+    // Returns a descriptor belonging to the caller, or -1 with errno set
+    int open(const std::string &path, struct stat &info);
+
+    // Forget a path, once it was changed
+    void invalidate(const std::string &path);
+};
+
+#endif // OPENFILECACHE_HPP
+
+// Path: includes/response/OpenFileCache.hpp
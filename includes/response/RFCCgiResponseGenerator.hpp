@@ -21,16 +21,17 @@ private:
 
     void m_setCgiArguments(const std::string &cgi_script,
                            const std::string &script, const IRoute &route,
+                           const IRequest &request,
                            std::vector<char *> &cgi_args);
     void m_setCgiEnvironment(const std::string &cgi_script, const IRoute &route,
                              const IRequest &request,
                              std::vector<char *> &cgi_env);
-    char *m_getScriptPath(const std::string &script_name,
-                          const IRoute &route) const;
+    std::string m_getScriptPath(const std::string &script_name,
+                                const IRoute &route) const;
     std::string m_getPathTranslated(std::string &script_name,
                                     const IRoute &route) const;
-    void m_cleanUp(char *cgi_args[], char *cgi_env[] = NULL,
-                   int response_pipe_fd[ 2 ] = NULL, short option = 0x0) const;
+    void m_cleanUp(int response_pipe_fd[ 2 ] = NULL,
+                   short option = 0x0) const;
 
 public:
     RFCCgiResponseGenerator(ILogger &logger, const std::string &bin_path);
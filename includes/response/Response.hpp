@@ -10,20 +10,42 @@
  */
 
 #include "../../includes/constants/HttpHelper.hpp"
+#include "../core/IClock.hpp"
+#include "../utils/Arena.hpp"
 #include "IResponse.hpp"
 
+// Capacity of the buffers kept by a response reset for reuse, larger buffers
+// are freed so that a pooled response does not pin a large body
+#define RESPONSE_RETAINED_CAPACITY 65536
+
 class Response : public IResponse
 {
 private:
+    // Headers, with nodes and values drawn from the arena
+    typedef std::map<
+        std::string, ArenaString, std::less<std::string>,
+        ArenaAllocator<std::pair<const std::string, ArenaString> > >
+        HeaderMap_t;
+
+    // Arena for the short-lived allocations of the response, reset with it
+    // Declared first, so that it outlives the containers drawing from it
+    Arena m_arena;
+
     // Response Status line
     std::string m_status_line;
 
     // Response headers
-    std::map<std::string, std::string> m_headers;
+    HeaderMap_t m_headers;
 
     // Response body
     std::vector<char> m_body;
 
+    // Body file descriptor, -1 when the body is in memory
+    int m_body_file_descriptor;
+
+    // Offset of the body in the body file
+    off_t m_body_file_offset;
+
     // Body size
     size_t m_content_length;
 
@@ -33,13 +55,32 @@ private:
     // Helper
     const HttpHelper &m_http_helper;
 
+    // Clock, for the Date header
+    const IClock &m_clock;
+
     // Response buffer - used to store incomplete cgi responses
     std::vector<char> m_buffer;
 
+    // Close the body file if the response still owns one
+    void m_closeBodyFile();
+
+    // Empty a buffer, freeing it if it grew past the retained capacity
+    static void m_clearBuffer(std::vector<char> &buffer);
+
+    // Size of the header lines, without building them
+    size_t m_getHeadersSize() const;
+
+    // Set a header, its value being copied into the arena
+    void m_setHeader(const std::string &header_name, const char *value,
+                     size_t size);
+
 public:
-    Response(const HttpHelper &http_helper);
+    Response(const HttpHelper &http_helper, const IClock &clock);
     ~Response();
 
+    // Forget the response, so that it can be reused for the next one
+    void reset();
+
     // Getters for status line, headers, body, and buffer
     virtual std::string getStatusLine() const;
     virtual std::string getHeaders() const;
@@ -60,6 +101,14 @@ public:
     virtual void setBody(std::string body);
     virtual void setBody(std::vector<char> body);
 
+    // File body, sent from its descriptor instead of being read into memory,
+    // size bytes from an offset
+    virtual void setBodyFile(int file_descriptor, off_t offset, size_t size);
+    virtual bool hasBodyFile() const;
+    virtual int releaseBodyFile();
+    virtual off_t getBodyFileOffset() const;
+    virtual size_t getContentLength() const;
+
     // Set error response with appropriate status code
     virtual void setErrorResponse(HttpStatusCode status_code);
     virtual void setErrorResponse(int status_code);
@@ -80,6 +129,10 @@ public:
     // Convert headers to map or string
     virtual std::map<std::string, std::string> getHeadersStringMap() const;
     virtual std::vector<char> serialise();
+    virtual std::vector<char> serialiseHead();
+
+    // Hand the in-memory body over to the caller, leaving it empty
+    virtual void releaseBody(std::vector<char> &body);
 
     // Append data to the buffer
     virtual void appendBuffer(std::vector<char> &data);
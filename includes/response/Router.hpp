@@ -10,12 +10,14 @@
 
 #include "../configuration/IConfiguration.hpp"
 #include "../constants/HttpHelper.hpp"
+#include "../core/IClock.hpp"
 #include "../logger/ILogger.hpp"
 #include "../request/IRequest.hpp"
 #include "IResponse.hpp"
 #include "IResponseGenerator.hpp"
 #include "IRoute.hpp"
 #include "IRouter.hpp"
+#include "OpenFileCache.hpp"
 #include "URIMatcher.hpp"
 
 class Router : public IRouter
@@ -24,6 +26,7 @@ private:
     IConfiguration &m_configuration;
     ILogger &m_logger;
     HttpHelper m_http_helper;
+    OpenFileCache m_open_file_cache; // Shared by the response generators
 
     // std::vector<IRoute *>			m_routes;
     std::vector<std::vector<IRoute *> *> m_routes;
@@ -39,7 +42,8 @@ private:
     void m_createRoutes(IConfiguration &server, std::vector<IRoute *> &routes);
 
 public:
-    Router(IConfiguration &Configuration, ILogger &logger);
+    Router(IConfiguration &Configuration, ILogger &logger,
+           const IClock &clock);
     ~Router();
 
     virtual IRoute *getRoute(IRequest *req, IResponse *res);
@@ -1,24 +1,78 @@
 #ifndef STATICFILERESPONSEGENERATOR_HPP
 #define STATICFILERESPONSEGENERATOR_HPP
 
+#include "../core/IClock.hpp"
 #include "../logger/ILogger.hpp"
+#include "FileCache.hpp"
 #include "IResponseGenerator.hpp"
+#include "OpenFileCache.hpp"
+
+// Ranges of a request served at most, the Range header being ignored beyond
+#define RANGE_MAX_RANGES 32
+
+// Bytes of the ranges of a multipart/byteranges response at most, as its
+// body is built in memory, the Range header being ignored beyond
+#define RANGE_MULTIPART_MAX_SIZE 1048576
+
+// First and last byte of a range, inclusive
+typedef std::pair<off_t, off_t> ByteRange_t;
+
+// Content coding of a precompressed sidecar, and the suffix of its file
+typedef std::pair<std::string, std::string> Encoding_t;
+
+// File served for a request, the file itself or a precompressed sidecar
+struct ServedFile
+{
+    std::string path;             // File read
+    std::string cache_key;        // Key of the file in the file cache
+    std::string content_type;     // Content-Type, of the uncompressed file
+    std::string content_encoding; // Content-Encoding, empty if uncompressed
+};
 
 class StaticFileResponseGenerator : public IResponseGenerator
 {
 private:
     const std::map<std::string, std::string> m_mime_types;
     ILogger &m_logger;
+    const IClock &m_clock; // Time a Last-Modified is judged strong against
+    OpenFileCache &m_open_file_cache; // Descriptors and metadata of files
+    const bool m_sendfile; // Send file bodies from their descriptor
+    FileCache m_file_cache; // Hot files, served from memory
+    unsigned long m_boundary; // Last multipart/byteranges boundary
+    const bool m_gzip_static;   // Serve the .gz sidecars of the files
+    const bool m_brotli_static; // Serve the .br sidecars of the files
 
     std::map<std::string, std::string> m_initialiseMimeTypes() const;
     std::string m_getMimeType(const std::string &file_path) const;
-    bool m_isDirectory(const std::string &path) const;
-    int m_serveFile(const std::string &file_path, IResponse &response);
+    bool m_isDirectory(const std::string &path);
+    std::vector<Encoding_t>
+    m_getAcceptedEncodings(const IRequest &request) const;
+    int m_serveFile(const std::string &file_path, const IRequest &request,
+                    IResponse &response, const std::string &cache_key);
+    void m_addFileHeaders(const ServedFile &file, const struct stat &info,
+                          IResponse &response) const;
+    bool m_isNotModified(const IRequest &request, const std::string &etag,
+                         time_t modified) const;
+    void m_serveNotModified(const std::string &etag,
+                            const std::string &last_modified,
+                            IResponse &response);
+    bool m_isRangeFresh(const IRequest &request, const struct stat &info) const;
+    int m_parseRanges(const std::string &range, off_t size,
+                      std::vector<ByteRange_t> &ranges) const;
+    int m_serveRanges(const ServedFile &file, int file_descriptor,
+                      const struct stat &info,
+                      const std::vector<ByteRange_t> &ranges,
+                      IResponse &response);
+    void m_serveCachedFile(const FileCacheEntry &entry, IResponse &response);
+    void m_serveFileDescriptor(const ServedFile &file, int file_descriptor,
+                               const struct stat &info, IResponse &response);
     void m_serveDirectoryListing(const std::string &directory_path,
                                  IResponse &response);
 
 public:
-    StaticFileResponseGenerator(ILogger &logger);
+    StaticFileResponseGenerator(ILogger &logger, const IClock &clock,
+                                const IConfiguration &http,
+                                OpenFileCache &open_file_cache);
     ~StaticFileResponseGenerator();
     Triplet_t generateResponse(const IRoute &route, const IRequest &request,
                                IResponse &response,
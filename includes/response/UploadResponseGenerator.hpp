@@ -8,14 +8,16 @@ this class is derived from AResponseGenerator, and is selected by 'Router'*/
 #include "../../includes/configuration/IConfiguration.hpp"
 #include "../../includes/logger/ILogger.hpp"
 #include "../../includes/response/IResponseGenerator.hpp"
+#include "../../includes/response/OpenFileCache.hpp"
 
 class UploadResponseGenerator : public IResponseGenerator
 {
 private:
     ILogger &m_logger;
+    OpenFileCache &m_open_file_cache;
 
 public:
-    UploadResponseGenerator(ILogger &logger);
+    UploadResponseGenerator(ILogger &logger, OpenFileCache &open_file_cache);
     ~UploadResponseGenerator();
     Triplet_t generateResponse(const IRoute &route, const IRequest &request,
                                IResponse &response,
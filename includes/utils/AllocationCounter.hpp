@@ -0,0 +1,32 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+/*
+ * AllocationCounter
+ *
+ * Counts the calls to the global operator new, through which the strings and
+ * containers of the server allocate. Counting is only compiled in with
+ * WEBSERV_ALLOCATION_STATS defined, "make re ALLOCATION_STATS=1", which
+ * replaces the global operator new and delete: the count stays 0 otherwise.
+ * Memory taken with malloc directly, as by the C library, is not counted.
+ *
+ */
+
+#include <cstddef>
+
+class AllocationCounter
+{
+private:
+    AllocationCounter();
+
+public:
+    // Check if the allocations are counted in this build
+    static bool enabled();
+
+    // Get the number of calls to operator new made by the process so far
+    static size_t count();
+};
+
+#endif // ALLOCATIONCOUNTER_HPP
+
+// Path: includes/utils/AllocationCounter.hpp
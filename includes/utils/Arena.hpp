@@ -0,0 +1,145 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+/*
+ * Arena
+ *
+ * Bump allocator for the short-lived objects of a request. Memory is handed
+ * out from fixed-size blocks by moving an offset forward, and is never freed
+ * one object at a time: the whole arena is reset when the request is done.
+ * The blocks are kept across resets, so a reused request draws from memory
+ * it already owns. Allocations too large for a block get their own, which
+ * are freed on reset.
+ *
+ * ArenaAllocator lets the standard containers draw their nodes from an arena,
+ * and ArenaString refers to bytes copied into one.
+ *
+ * The request headers and cookies, the response headers, the Set-Cookie
+ * lines and the CGI argv and environment draw from the arena of their request
+ * or response. The URI, the read buffers, the status line and the strings
+ * built by the generators (ETag, Last-Modified) still come from the heap,
+ * their owners keeping them as std::string.
+ *
+ */
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+// Size of the blocks memory is handed out from
+#define ARENA_BLOCK_SIZE 4096
+
+// Allocations larger than this get their own block
+#define ARENA_LARGE_ALLOCATION (ARENA_BLOCK_SIZE / 4)
+
+// Alignment of every allocation
+#define ARENA_ALIGNMENT 16
+
+// Bytes copied into an arena, valid until the arena is reset
+struct ArenaString
+{
+    const char *data;
+    size_t size;
+
+    // Copy the bytes out of the arena
+    std::string str() const { return std::string(data, size); }
+};
+
+// Byte-wise order of arena strings, as for std::string
+struct ArenaStringLess
+{
+    bool operator()(const ArenaString &lhs, const ArenaString &rhs) const;
+};
+
+class Arena
+{
+private:
+    std::vector<char *> m_blocks; // Blocks, kept across resets
+    size_t m_block;               // Block memory is handed out from
+    size_t m_offset;              // Offset of the free memory in the block
+    std::vector<void *> m_large;  // Large allocations, freed on reset
+
+    Arena(const Arena &src);
+    Arena &operator=(const Arena &src);
+
+public:
+    // Constructor, no memory is allocated until it is needed
+    Arena();
+
+    // Destructor, frees all the blocks
+    ~Arena();
+
+    // Allocate memory, valid until the next reset
+    void *allocate(size_t size);
+
+    // Copy a string to a C string, valid until the next reset
+    char *duplicate(const std::string &string);
+
+    // Copy bytes, valid until the next reset
+    ArenaString copy(const char *data, size_t size);
+
+    // Forget all the allocations, keeping the blocks for reuse
+    void reset();
+};
+
+// Allocator for the standard containers, drawing from an arena
+// Memory is only given back when the arena is reset
+template <typename T> class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U> struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    // Arena the memory is drawn from
+    Arena *arena;
+
+    ArenaAllocator(Arena *arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &src) : arena(src.arena)
+    {
+    }
+
+    pointer address(reference value) const { return &value; }
+    const_pointer address(const_reference value) const { return &value; }
+
+    pointer allocate(size_type count, const void * = 0)
+    {
+        return static_cast<pointer>(arena->allocate(count * sizeof(T)));
+    }
+    void deallocate(pointer, size_type) {}
+
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+    void construct(pointer position, const T &value)
+    {
+        new (static_cast<void *>(position)) T(value);
+    }
+    void destroy(pointer position) { position->~T(); }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs)
+{
+    return lhs.arena == rhs.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs)
+{
+    return lhs.arena != rhs.arena;
+}
+
+#endif // ARENA_HPP
+
+// Path: includes/utils/Arena.hpp
@@ -1,6 +1,7 @@
 #ifndef CONVERTER_HPP
 #define CONVERTER_HPP
 
+#include <ctime>
 #include <sstream>
 #include <string>
 
@@ -24,6 +25,13 @@ public:
     static std::string toString(float value);
     static std::string toString(unsigned long value);
     static std::string toString(long value);
+
+    // Format a time as an IMF-fixdate, "Sat, 01 Jan 2011 00:11:11 GMT"
+    static std::string toHttpDate(time_t time);
+
+    // Parse an HTTP-date, in the IMF-fixdate, RFC 850 or asctime format
+    // Returns -1 if the date is not valid
+    static time_t fromHttpDate(const std::string &date);
 };
 
 #endif // CONVERTER_HPP
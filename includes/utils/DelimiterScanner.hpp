@@ -0,0 +1,62 @@
+#ifndef DELIMITERSCANNER_HPP
+#define DELIMITERSCANNER_HPP
+
+/*
+ * DelimiterScanner
+ *
+ * Finds the first occurrence of any of a few delimiter bytes (CR, LF, ':',
+ * SP...) in a buffer. Parsing HTTP mostly means skipping over bytes that are
+ * not one of these, so the scanner compares 32 bytes at a time with AVX2 or
+ * 16 with SSE2. The implementation is chosen once from the features of the
+ * CPU, with a scalar loop for other CPUs and for the tail of the buffer.
+ *
+ * Setting up the vectors costs more than it saves on tokens of a few bytes,
+ * so scanners for short tokens (header names) always use the scalar loop, as
+ * do builds without optimization, where the intrinsics are not inlined (see
+ * webserv-scanbench).
+ */
+
+#include <cstddef>
+
+// Maximum number of delimiters a scanner looks for
+#define DELIMITER_SCANNER_MAX_DELIMITERS 4
+
+class DelimiterScanner
+{
+public:
+    // Signature of the scanning implementations
+    typedef const char *(*ScanFunction)(const char *begin, const char *end,
+                                        const char *delimiters);
+
+private:
+    // Delimiters, the last one repeated to fill the set
+    char m_delimiters[ DELIMITER_SCANNER_MAX_DELIMITERS ];
+
+    // Implementation used by this scanner
+    ScanFunction m_scan;
+
+    // Implementation picked for this CPU
+    static const ScanFunction s_scan;
+
+    // Pick the fastest implementation the CPU supports
+    static ScanFunction m_selectScanFunction();
+
+public:
+    // Constructor, from a string of 1 to 4 delimiters
+    // Scanners for short tokens use the scalar loop
+    DelimiterScanner(const char *delimiters, bool short_tokens = false);
+
+    // Find the first delimiter in [begin, end), or end if there is none
+    const char *find(const char *begin, const char *end) const;
+
+    // Get the name of the implementation in use
+    static const char *implementation();
+
+    // Get an implementation by name, "avx2", "sse2" or "scalar", or NULL if
+    // the CPU does not support it
+    static ScanFunction getScanFunction(const char *name);
+};
+
+#endif // DELIMITERSCANNER_HPP
+
+// Path: includes/utils/DelimiterScanner.hpp
@@ -7,7 +7,7 @@ class SignalHandler
 {
 private:
     static void m_sigintHandler(int param, siginfo_t *info, void *context);
-    volatile sig_atomic_t m_sigint_received;
+    static volatile sig_atomic_t m_sigint_received;
 
 public:
     SignalHandler();
@@ -15,6 +15,7 @@ public:
 
     void sigint();
     void checkState();
+    bool sigintReceived() const;
 };
 
 #endif
@@ -3,16 +3,23 @@
 #include "includes/connection/ClientHandler.hpp"
 #include "includes/connection/ConnectionManager.hpp"
 #include "includes/connection/RequestHandler.hpp"
+#include "includes/core/Clock.hpp"
+#include "includes/core/DescriptorTable.hpp"
+#include "includes/core/EpollPollingService.hpp"
 #include "includes/core/EventManager.hpp"
+#include "includes/core/MasterProcess.hpp"
 #include "includes/core/PollingService.hpp"
+#include "includes/core/TimerWheel.hpp"
 #include "includes/exception/ExceptionHandler.hpp"
 #include "includes/factory/Factory.hpp"
 #include "includes/logger/Logger.hpp"
 #include "includes/logger/LoggerConfiguration.hpp"
 #include "includes/network/Server.hpp"
 #include "includes/network/Socket.hpp"
+#include "includes/pollfd/EpollPollfdManager.hpp"
 #include "includes/pollfd/PollfdManager.hpp"
 #include "includes/response/Router.hpp"
+#include "includes/utils/Converter.hpp"
 #include "includes/utils/SignalHandler.hpp"
 
 /*
@@ -32,6 +39,10 @@
  * is ready. All the while, the Logger class registers errors and access log
  * entries with the BufferManager, who writes them non-blockingly to the log
  * file. This process continues in a loop.
+ *
+ * With several worker processes, the initial process becomes a master that
+ * forks the workers, each running the cycle above on its own server sockets,
+ * and respawns the ones that die.
  */
 
 int main(int argc, char **argv)
@@ -52,11 +63,17 @@ int main(int argc, char **argv)
     // Instantiate the Socket instance.
     Socket socket;
 
+    // Instantiate the DescriptorTable, before the objects indexing it.
+    DescriptorTable descriptor_table;
+
     // Instantiate the buffer_manager.
-    BufferManager buffer_manager(socket);
+    BufferManager buffer_manager(socket, descriptor_table);
+
+    // Instantiate the Clock, shared by the logger and the responses.
+    Clock clock;
 
     // Instantiate the logger.
-    Logger logger(buffer_manager);
+    Logger logger(buffer_manager, clock);
 
     // Instantiate the Client Handler.
     ClientHandler client_handler(socket, logger);
@@ -66,27 +83,73 @@ int main(int argc, char **argv)
 
     ConfigurationLoader conf_loader(logger);
 
+    // Declare the polling backend, selected once the configuration is loaded.
+    PollfdManager *pollfd_manager_ptr = NULL;
+    IPollingService *polling_service_ptr = NULL;
+
     try
     {
         // load configuration from file and create the configuration object.
         IConfiguration &configuration =
             conf_loader.loadConfiguration(config_path);
 
-        // parse the configuration file
-
-        // Instantiate the PollfdManager.
-        PollfdManager pollfd_manager(configuration, logger);
+        // Apply the descriptor limit, inherited by the workers, and size the
+        // descriptor table from it.
+        if (!descriptor_table.setLimit(
+                configuration.getSize_t("worker_rlimit_nofile")))
+            logger.log(WARN, "Could not set worker_rlimit_nofile, using " +
+                                 Converter::toString(descriptor_table.size()));
+
+        // Fork the worker processes, the master process supervises them and
+        // returns once they all exited.
+        MasterProcess master_process(configuration, buffer_manager, logger,
+                                     signalHandler);
+        if (!master_process.run())
+            return master_process.getExitStatus();
+
+        // Select the polling backend, 'use poll;' or 'use epoll;' in the
+        // events block.
+        std::string polling_method =
+            configuration.getBlocks("events")[ 0 ]->getString("use");
+
+        // Instantiate the PollfdManager and the PollingService.
+#ifdef __linux__
+        if (polling_method == "epoll")
+        {
+            EpollPollfdManager *epoll_pollfd_manager =
+                new EpollPollfdManager(configuration, logger, descriptor_table);
+            pollfd_manager_ptr = epoll_pollfd_manager;
+            polling_service_ptr =
+                new EpollPollingService(*epoll_pollfd_manager, logger);
+        }
+        else
+#endif
+        {
+            if (polling_method != "poll")
+                logger.log(WARN, "Polling method '" + polling_method +
+                                     "' unavailable, using poll.");
+            pollfd_manager_ptr =
+                new PollfdManager(configuration, logger, descriptor_table);
+            polling_service_ptr =
+                new PollingService(*pollfd_manager_ptr, logger);
+        }
+        PollfdManager &pollfd_manager = *pollfd_manager_ptr;
+        IPollingService &polling_service = *polling_service_ptr;
 
         // Configure the logger
         LoggerConfiguration *logger_configuration = new LoggerConfiguration(
             buffer_manager, configuration, pollfd_manager);
         logger.configure(*logger_configuration);
 
+        // Instantiate the TimerWheel, before the objects holding timers.
+        TimerWheel timer_wheel;
+
         // Instantiate the Factory.
-        Factory factory(configuration, logger);
+        Factory factory(configuration, logger, timer_wheel, clock);
 
         // Instantiate the ConnectionManager.
-        ConnectionManager connection_manager(logger, factory);
+        ConnectionManager connection_manager(logger, factory,
+                                             descriptor_table);
 
         // Instantiate the Server.
         Server server(socket, pollfd_manager, connection_manager, configuration,
@@ -94,34 +157,36 @@ int main(int argc, char **argv)
 
         // Instantiate the Router.
         // Router router(configuration, logger, HttpHelper());
-        Router router(configuration, logger);
+        Router router(configuration, logger, clock);
 
         // Instantiate the RequestHandler.
         RequestHandler request_handler(buffer_manager, connection_manager,
                                        configuration, router, logger,
-                                       exception_handler, client_handler);
-
-        // Instantiate the PollingService.
-        PollingService polling_service(pollfd_manager, logger);
+                                       exception_handler, client_handler,
+                                       descriptor_table);
 
         // Instantiate the EventManager.
         EventManager event_manager(pollfd_manager, buffer_manager,
                                    connection_manager, server, request_handler,
-                                   logger);
+                                   timer_wheel, logger);
 
         // Start the webserv core cycle.
         while (true)
         {
             try
             {
+                // Wait until the next timer may expire.
+                polling_service.setPollingTimeout(
+                    timer_wheel.getNextTimeout(MAX_POLLING_TIMEOUT));
+
                 // Poll events.
                 polling_service.pollEvents();
 
-                // Handle events.
-                event_manager.handleEvents();
+                // Read the clock once for all the events.
+                clock.update();
 
-                // Collect garbage.
-                connection_manager.collectGarbage();
+                // Handle events and expired timers.
+                event_manager.handleEvents();
 
                 // Check for signals.
                 signalHandler.checkState();
@@ -142,8 +207,17 @@ int main(int argc, char **argv)
 
         // Handle setup exceptions.
         exception_handler.handleException(e, "webserv setup: ");
+
+        // Let the master process know this worker cannot start.
+        delete polling_service_ptr;
+        delete pollfd_manager_ptr;
+        return WORKER_SETUP_FAILURE;
     }
 
+    // Destroy the polling backend.
+    delete polling_service_ptr;
+    delete pollfd_manager_ptr;
+
     // Configure the logger with a null configuration.
     // LoggerConfiguration *null = NULL;
     // logger.configure(*null);
@@ -1,5 +1,6 @@
 #include "../../includes/buffer/BufferManager.hpp"
 #include "../../includes/buffer/FileBuffer.hpp"
+#include "../../includes/buffer/SendfileBuffer.hpp"
 #include "../../includes/buffer/SocketBuffer.hpp"
 
 /*
@@ -24,8 +25,9 @@
  */
 
 // Constructor
-BufferManager::BufferManager(ISocket &socket)
-    : m_flush_threshold(DEFAULT_FLUSH_THRESHOLD), m_socket(socket)
+BufferManager::BufferManager(ISocket &socket, DescriptorTable &descriptors)
+    : m_flush_threshold(DEFAULT_FLUSH_THRESHOLD), m_socket(socket),
+      m_descriptors(descriptors)
 {
 }
 
@@ -33,22 +35,18 @@ BufferManager::BufferManager(ISocket &socket)
 BufferManager::~BufferManager()
 {
     // Clean up all buffers
-    std::map<int, IBuffer *>::iterator it = m_buffers.begin();
-    while (it != m_buffers.end())
+    for (size_t descriptor = 0; descriptor < m_descriptors.size();
+         descriptor++)
     {
+        IBuffer *buffer = m_descriptors.at(descriptor).buffer;
+        if (buffer == NULL)
+            continue;
+
         // Flush remaining data in each buffer and then destroy it
-        while (it->second->flush(it->first, true) >
+        while (buffer->flush(descriptor, true) >
                0) // flush remaining data blockingly (true)
             ;
-
-        // Duplicate itertor to avoid invalidating it
-        std::map<int, IBuffer *>::iterator it2 = it;
-
-        // Increment iterator before destroying buffer
-        it++;
-
-        // Destroy buffer
-        this->destroyBuffer(it2->first);
+        this->destroyBuffer(descriptor);
     }
 }
 
@@ -58,13 +56,12 @@ ssize_t BufferManager::pushFileBuffer(int file_descriptor,
                                       size_t flush_threshold)
 {
     // If the buffer for this file descriptor doesn't exist, create it
-    if (m_buffers.find(file_descriptor) == m_buffers.end())
-    {
-        m_buffers[ file_descriptor ] = new FileBuffer(flush_threshold);
-    }
+    IBuffer *&buffer = m_descriptors[ file_descriptor ].buffer;
+    if (buffer == NULL)
+        buffer = new FileBuffer(flush_threshold);
+
     // Push data into the file buffer
-    return m_buffers[ file_descriptor ]->push(
-        data); // returns 1 if a flush is requested
+    return buffer->push(data); // returns 1 if a flush is requested
 }
 
 // Push a socket buffer into the manager
@@ -72,64 +69,97 @@ ssize_t BufferManager::pushSocketBuffer(int socket_descriptor,
                                         const std::vector<char> &data)
 {
     // If the buffer for this socket descriptor doesn't exist, create it
-    if (m_buffers.find(socket_descriptor) == m_buffers.end())
-    {
-        m_buffers[ socket_descriptor ] = new SocketBuffer(m_socket);
-    }
+    IBuffer *&buffer = m_descriptors[ socket_descriptor ].buffer;
+    if (buffer == NULL)
+        buffer = new SocketBuffer(m_socket);
+
     // Push data into the socket buffer
-    return m_buffers[ socket_descriptor ]->push(
-        data); // returns the number of bytes pushed
+    return buffer->push(data); // returns the number of bytes pushed
+}
+
+// Hand data over to a socket buffer without copying it, leaving the vector
+// empty
+ssize_t BufferManager::pushSocketSegment(int socket_descriptor,
+                                         std::vector<char> &data)
+{
+    // If the buffer for this socket descriptor doesn't exist, create it
+    IBuffer *&buffer = m_descriptors[ socket_descriptor ].buffer;
+    if (buffer == NULL)
+        buffer = new SocketBuffer(m_socket);
+
+    // Push the data into the socket buffer as a segment of its own
+    return buffer->pushSegment(data); // returns the number of bytes pushed
+}
+
+// Push a response with a file body into a socket buffer, taking ownership of
+// the file descriptor
+ssize_t BufferManager::pushSendfileBuffer(int socket_descriptor,
+                                          const std::vector<char> &head,
+                                          int file_descriptor, off_t offset,
+                                          size_t size)
+{
+    // Keep the bytes still waiting in a previous buffer ahead of the response
+    std::vector<char> data = this->peekBuffer(socket_descriptor);
+    data.insert(data.end(), head.begin(), head.end());
+    this->destroyBuffer(socket_descriptor);
+
+    // Create the buffer, the file is sent from its descriptor when flushed
+    m_descriptors[ socket_descriptor ].buffer =
+        new SendfileBuffer(m_socket, data, file_descriptor, offset, size);
+
+    // Return the number of bytes pushed
+    return data.size() + size;
 }
 
 // Flush the buffer for a specific descriptor
 // Returns bytes remaining in buffer, or -1 in case of error
 ssize_t BufferManager::flushBuffer(int descriptor, bool blocking)
 {
-    if (m_buffers.find(descriptor) != m_buffers.end())
-    {
-        // Flush the buffer and get the number of remaining bytes
-        ssize_t remaining_bytes =
-            m_buffers[ descriptor ]->flush(descriptor, blocking);
+    IBuffer *buffer = m_descriptors.at(descriptor).buffer;
+    if (buffer == NULL)
+        return -1;
 
-        // If the buffer is completely flushed, destroy it
-        if (remaining_bytes == 0)
-            this->destroyBuffer(descriptor);
+    // Flush the buffer and get the number of remaining bytes
+    ssize_t remaining_bytes = buffer->flush(descriptor, blocking);
 
-        // Return the number of remaining bytes
-        return remaining_bytes;
-    }
-    return -1;
+    // If the buffer is completely flushed, destroy it
+    if (remaining_bytes == 0)
+        this->destroyBuffer(descriptor);
+
+    // Return the number of remaining bytes
+    return remaining_bytes;
 }
 
 // Flush all buffers
 void BufferManager::flushBuffers()
 {
-    std::map<int, IBuffer *>::iterator it;
-    for (it = m_buffers.begin(); it != m_buffers.end(); it++)
+    for (size_t descriptor = 0; descriptor < m_descriptors.size();
+         descriptor++)
     {
         // Flush each buffer
-        this->flushBuffer(it->first);
+        if (m_descriptors.at(descriptor).buffer != NULL)
+            this->flushBuffer(descriptor);
     }
 }
 
 // Destroy the buffer for a specific descriptor
 void BufferManager::destroyBuffer(int descriptor)
 {
-    if (m_buffers.find(descriptor) != m_buffers.end())
-    {
-        // Delete the buffer and remove it from the map
-        delete m_buffers[ descriptor ];
-        m_buffers.erase(descriptor);
-    }
+    if (m_descriptors.at(descriptor).buffer == NULL)
+        return;
+
+    // Delete the buffer and forget it
+    IBuffer *&buffer = m_descriptors[ descriptor ].buffer;
+    delete buffer;
+    buffer = NULL;
 }
 
 // Peek at the buffer for a specific descriptor
 std::vector<char> BufferManager::peekBuffer(int descriptor) const
 {
-    if (m_buffers.find(descriptor) != m_buffers.end())
-    {
-        return m_buffers.at(descriptor)->peek();
-    }
+    const IBuffer *buffer = m_descriptors.at(descriptor).buffer;
+    if (buffer != NULL)
+        return buffer->peek();
     return std::vector<char>();
 }
 
@@ -142,12 +172,13 @@ void BufferManager::setFlushThreshold(size_t threshold)
 // Transfer the buffer from one descriptor to another
 void BufferManager::transferBuffer(int from_descriptor, int to_descriptor)
 {
-    if (m_buffers.find(from_descriptor) != m_buffers.end())
-    {
-        // Transfer the buffer to the new descriptor
-        m_buffers[ to_descriptor ] = m_buffers[ from_descriptor ];
-        m_buffers.erase(from_descriptor);
-    }
+    IBuffer *buffer = m_descriptors.at(from_descriptor).buffer;
+    if (buffer == NULL)
+        return;
+
+    // Transfer the buffer to the new descriptor
+    m_descriptors[ to_descriptor ].buffer = buffer;
+    m_descriptors[ from_descriptor ].buffer = NULL;
 }
 
 // Path: srcs/FileBuffer.cpp
@@ -41,6 +41,15 @@ ssize_t FileBuffer::push(const std::vector<char> &data)
     return (m_buffer.size() > m_flush_threshold);
 }
 
+// Push data into the buffer, leaving the vector empty
+ssize_t FileBuffer::pushSegment(std::vector<char> &data)
+{
+    // The data is gathered in a single buffer for the writes anyway
+    ssize_t return_value = this->push(data);
+    data.clear();
+    return return_value;
+}
+
 // Flush the buffer to the file descriptor
 // Returns the remaining size of the buffer (or -1 in case of error)
 ssize_t FileBuffer::flush(int file_descriptor, bool regardless_of_threshold)
@@ -52,22 +61,30 @@ ssize_t FileBuffer::flush(int file_descriptor, bool regardless_of_threshold)
                                 // return the remaining size of the buffer
     }
 
-    // Write the buffer to the file descriptor
-    ssize_t bytes_written =
-        ::write(file_descriptor, m_buffer.data(), m_buffer.size());
-
-    if (bytes_written == -1)
+    // Write the buffer to the file descriptor until it is empty or the write
+    // falls short
+    size_t bytes_written = 0;
+    ssize_t write_return_value = 0;
+    while (bytes_written < m_buffer.size())
     {
-        return -1; // Error writing to file descriptor
+        write_return_value =
+            ::write(file_descriptor, m_buffer.data() + bytes_written,
+                    m_buffer.size() - bytes_written);
+        if (write_return_value <= 0)
+            break;
+        bytes_written += write_return_value;
     }
-    else
+
+    if (write_return_value == -1 && bytes_written == 0)
     {
-        // Update buffer state after successful write
-        size_t bytes_remaining = m_buffer.size() - bytes_written;
-        // Shift the remaining data to the beginning of the buffer
-        memmove(&m_buffer[ 0 ], &m_buffer[ bytes_written ], bytes_remaining);
-        m_buffer.resize(bytes_remaining);
+        return -1; // Error writing to file descriptor
     }
+
+    // Update buffer state after successful write
+    size_t bytes_remaining = m_buffer.size() - bytes_written;
+    // Shift the remaining data to the beginning of the buffer
+    memmove(&m_buffer[ 0 ], &m_buffer[ bytes_written ], bytes_remaining);
+    m_buffer.resize(bytes_remaining);
     return m_buffer.size(); // Return the remaining size of the buffer
 }
 
@@ -0,0 +1,149 @@
+#include "../../includes/buffer/SendfileBuffer.hpp"
+
+/*
+ * SendfileBuffer.cpp
+ *
+ * Holds a response whose body is a file, for socket descriptors.
+ *
+ */
+
+// Constructor
+SendfileBuffer::SendfileBuffer(ISocket &socket, const std::vector<char> &head,
+                               int file_descriptor, off_t offset, size_t size)
+    : m_head(head), m_file_descriptor(file_descriptor), m_offset(offset),
+      m_end(offset + static_cast<off_t>(size)), m_socket(socket)
+{
+}
+
+// Destructor
+SendfileBuffer::~SendfileBuffer()
+{
+    // Close the file, whether it was fully sent or not
+    if (m_file_descriptor != -1)
+        close(m_file_descriptor);
+}
+
+// Push data to send after the file
+ssize_t SendfileBuffer::push(const std::vector<char> &data)
+{
+    // Append data to the tail
+    m_tail.insert(m_tail.end(), data.begin(), data.end());
+
+    // Return the number of bytes pushed
+    return data.size();
+}
+
+// Push data to send after the file, leaving the vector empty
+ssize_t SendfileBuffer::pushSegment(std::vector<char> &data)
+{
+    ssize_t bytes_pushed = this->push(data);
+    data.clear();
+    return bytes_pushed;
+}
+
+// Send the buffer to the socket descriptor: the head, then the file, then the
+// tail
+// Returns its remaining size (or -1 in case of error)
+ssize_t SendfileBuffer::flush(int socket_descriptor, bool blocking)
+{
+    // Send the head first, coalesced with the start of the file if any
+    ssize_t bytes_sent = 0;
+    if (!m_head.empty())
+    {
+        bytes_sent =
+            m_sendBytes(socket_descriptor, m_head, blocking, m_offset < m_end);
+        if (bytes_sent == -1)
+            return -1;
+        if (!m_head.empty())
+            return m_remaining();
+    }
+
+    // Send the file, a failure after some progress only means the socket is
+    // full
+    if (m_offset < m_end)
+    {
+        ssize_t file_bytes_sent = m_sendFile(socket_descriptor);
+        if (file_bytes_sent == -1 && bytes_sent == 0)
+            return -1;
+        if (m_offset < m_end)
+            return m_remaining();
+        bytes_sent += file_bytes_sent;
+    }
+
+    // Send the tail
+    if (!m_tail.empty() &&
+        m_sendBytes(socket_descriptor, m_tail, blocking, false) == -1 &&
+        bytes_sent == 0)
+        return -1;
+
+    return m_remaining(); // Return the remaining size of the buffer
+}
+
+// Peek at the in-memory part of the buffer
+std::vector<char> SendfileBuffer::peek() const
+{
+    // Return a copy of the head and the tail
+    std::vector<char> buffer(m_head);
+    buffer.insert(buffer.end(), m_tail.begin(), m_tail.end());
+    return buffer;
+}
+
+// Send in-memory bytes and drop them from the vector
+ssize_t SendfileBuffer::m_sendBytes(int socket_descriptor,
+                                    std::vector<char> &data, bool blocking,
+                                    bool more)
+{
+    // Attempt to send the bytes to the socket
+    ssize_t bytes_sent = 0;
+    if (blocking == true) // will block until all data is sent
+        bytes_sent = m_socket.sendAll(socket_descriptor, data);
+    else if (more == true) // will be sent along with the data following it
+        bytes_sent = m_socket.sendMore(socket_descriptor, data);
+    else // will send as much data as possible without blocking
+        bytes_sent = m_socket.send(socket_descriptor, data);
+
+    // Drop the bytes sent
+    if (bytes_sent > 0)
+        data.erase(data.begin(), data.begin() + bytes_sent);
+    return bytes_sent;
+}
+
+// Send the file until it is done or the socket is full, so that an edge
+// triggered socket reports its write readiness again
+ssize_t SendfileBuffer::m_sendFile(int socket_descriptor)
+{
+    ssize_t total_bytes_sent = 0;
+    while (m_offset < m_end)
+    {
+        // Send the next chunk of the file
+        size_t count = static_cast<size_t>(m_end - m_offset);
+        if (count > SENDFILE_CHUNK_SIZE)
+            count = SENDFILE_CHUNK_SIZE;
+        ssize_t bytes_sent = m_socket.sendFile(
+            socket_descriptor, m_file_descriptor, m_offset, count);
+
+        // The socket is full, or is in error if nothing went through
+        if (bytes_sent == -1)
+            return total_bytes_sent > 0 ? total_bytes_sent : -1;
+
+        // The file was truncated since the response was generated, the
+        // promised content length can no longer be honoured
+        if (bytes_sent == 0)
+            return -1;
+
+        // Stop on a partial send, the socket is full
+        total_bytes_sent += bytes_sent;
+        if (static_cast<size_t>(bytes_sent) < count)
+            break;
+    }
+    return total_bytes_sent;
+}
+
+// Get the number of bytes left to send
+ssize_t SendfileBuffer::m_remaining() const
+{
+    return m_head.size() + static_cast<size_t>(m_end - m_offset) +
+           m_tail.size();
+}
+
+// Path: srcs/buffer/SendfileBuffer.cpp
@@ -1,4 +1,5 @@
 #include "../../includes/buffer/SocketBuffer.hpp"
+#include <sys/uio.h>
 
 /*
  * SocketBuffer.hpp
@@ -7,64 +8,131 @@
  */
 
 // Constructor
-SocketBuffer::SocketBuffer(ISocket &socket) : m_socket(socket)
-
+SocketBuffer::SocketBuffer(ISocket &socket)
+    : m_offset(0), m_size(0), m_socket(socket)
 {
-    // Reserve initial memory for the buffer
-    m_buffer.reserve(4096);
 }
 
 // Destructor
 SocketBuffer::~SocketBuffer()
 {
     // Clear the buffer
-    m_buffer.clear();
+    m_segments.clear();
 }
 
-// Push data into the buffer
+// Push a copy of the data into the buffer
 ssize_t SocketBuffer::push(const std::vector<char> &data)
 {
-    // Append data to the buffer
-    m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+    // Append the data as a new segment
+    std::vector<char> segment(data);
+    return this->pushSegment(segment);
+}
+
+// Hand the data over to the buffer without copying it, leaving it empty
+ssize_t SocketBuffer::pushSegment(std::vector<char> &data)
+{
+    // Empty segments would only take a slot in the vectored send
+    size_t size = data.size();
+    if (size == 0)
+        return 0;
+
+    // Take the content of the vector as a new segment
+    m_segments.push_back(std::vector<char>());
+    m_segments.back().swap(data);
+    m_size += size;
 
     // Return the number of bytes pushed
-    return data.size();
+    return size;
 }
 
 // Send the buffer to the socket descriptor
 // Returns its remaining size (or -1 in case of error)
 ssize_t SocketBuffer::flush(int socket_descriptor, bool blocking)
 {
-    // Attempt to send the buffer to the socket
-    ssize_t bytes_sent = 0;
-    if (blocking == true) // will block until all data is sent
-        bytes_sent = m_socket.sendAll(socket_descriptor, m_buffer);
-    else // will send as much data as possible without blocking
-        bytes_sent = m_socket.send(socket_descriptor, m_buffer);
-
-    if (bytes_sent == -1)
-    {
-        // Error occurred during send
-        // Since we call this only when poll() returns POLLOUT, we assume the
-        // error is not related to blocking Clear the buffer and return -1
-        m_buffer.clear();
-        return -1;
-    }
-    else
+    size_t total_bytes_sent = 0;
+    while (m_size > 0)
     {
+        // Point at the unsent part of the first segments
+        struct iovec iov[ SOCKET_BUFFER_MAX_IOVECS ];
+        int iovcnt = 0;
+        size_t batch_size = 0;
+        std::deque<std::vector<char> >::iterator it = m_segments.begin();
+        for (; it != m_segments.end() && iovcnt < SOCKET_BUFFER_MAX_IOVECS;
+             it++, iovcnt++)
+        {
+            size_t offset = (iovcnt == 0) ? m_offset : 0;
+            iov[ iovcnt ].iov_base = &(*it)[ offset ];
+            iov[ iovcnt ].iov_len = it->size() - offset;
+            batch_size += iov[ iovcnt ].iov_len;
+        }
+
+        // Attempt to send the segments to the socket, blocking will block
+        // until all of them are sent
+        ssize_t bytes_sent =
+            m_socket.writev(socket_descriptor, iov, iovcnt, blocking);
+
+        if (bytes_sent == -1)
+        {
+            // The socket is full if the previous batch went through
+            if (total_bytes_sent > 0)
+                break;
+
+            // Error occurred during send
+            // Since we call this only when poll() returns POLLOUT, we assume
+            // the error is not related to blocking. Clear the buffer and
+            // return -1
+            m_segments.clear();
+            m_offset = 0;
+            m_size = 0;
+            return -1;
+        }
+
         // Update buffer state after successful send
-        size_t bytesRemaining =
-            m_buffer.size() - static_cast<size_t>(bytes_sent);
-        memmove(&m_buffer[ 0 ], &m_buffer[ bytes_sent ], bytesRemaining);
-        m_buffer.resize(bytesRemaining);
+        m_consume(bytes_sent);
+        total_bytes_sent += bytes_sent;
+
+        // A partial send leaves the socket drained until it becomes writable
+        // again
+        if (static_cast<size_t>(bytes_sent) < batch_size && !blocking)
+            break;
     }
-    return m_buffer.size(); // Return the remaining size of the buffer
+    return m_size; // Return the remaining size of the buffer
 }
 
 // Peek at the buffer
 std::vector<char> SocketBuffer::peek() const
 {
-    return m_buffer; // Return a copy of the buffer
+    // Return a copy of the unsent data
+    std::vector<char> buffer;
+    buffer.reserve(m_size);
+    std::deque<std::vector<char> >::const_iterator it = m_segments.begin();
+    for (; it != m_segments.end(); it++)
+    {
+        size_t offset = (it == m_segments.begin()) ? m_offset : 0;
+        buffer.insert(buffer.end(), it->begin() + offset, it->end());
+    }
+    return buffer;
+}
+
+// Drop the bytes sent from the front of the buffer
+void SocketBuffer::m_consume(size_t bytes_sent)
+{
+    m_size -= bytes_sent;
+    while (bytes_sent > 0)
+    {
+        // Advance the read offset within the first segment
+        size_t left = m_segments.front().size() - m_offset;
+        if (bytes_sent < left)
+        {
+            m_offset += bytes_sent;
+            return;
+        }
+
+        // Drop the segment once it is fully sent
+        bytes_sent -= left;
+        m_segments.pop_front();
+        m_offset = 0;
+    }
 }
 
-// Path: srcs/SocketBuffer.cpp
+// Path: srcs/buffer/SocketBuffer.cpp
@@ -47,8 +47,8 @@ const BlockList &ConfigurationBlock::getBlocks(const std::string &key)
     }
     catch (std::exception &e)
     {
-        m_logger.log(DEBUG, "ConfigurationBlock::getBlocks: " + key +
-                                " not found using default");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getBlocks: " + key +
+                             " not found using default");
         BlockList *blk = &m_blocks[ key ];
         blk->push_back(new ConfigurationBlock(this, key, m_defaults));
         return *blk;
@@ -64,8 +64,8 @@ ConfigurationBlock::getStringVector(const std::string &key) const
     }
     catch (const std::exception &e)
     {
-        m_logger.log(DEBUG, "ConfigurationBlock::getString: " + key +
-                                " not found using default");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getString: " + key +
+                             " not found using default");
         return m_defaults.getDirectiveParameters(key);
     }
 }
@@ -81,9 +81,9 @@ const std::string &ConfigurationBlock::getString(const std::string &key,
     {
         const std::string &res =
             m_defaults.getDirectiveParameters(key)[ index ];
-        m_logger.log(DEBUG, "ConfigurationBlock::getString: " + key + "[" +
-                                Converter::toString(index) +
-                                "] not found defaulting to " + res);
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getString: " + key + "[" +
+                             Converter::toString(index) +
+                             "] not found defaulting to " + res);
         return res;
     }
 }
@@ -97,14 +97,14 @@ int ConfigurationBlock::getInt(const std::string &key, size_t index = 0) const
     }
     catch (const std::out_of_range &e)
     {
-        m_logger.log(DEBUG,
-                     "ConfigurationBlock::getInt: " + key + " not found");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getInt: " + key +
+                             " not found");
     }
     catch (const std::invalid_argument &e)
     {
-        m_logger.log(DEBUG, "ConfigurationBlock::getInt: " + key + " " +
-                                m_directives.at(key)->at(index) +
-                                " not an integer");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getInt: " + key + " " +
+                             m_directives.at(key)->at(index) +
+                             " not an integer");
     }
     return Converter::toInt(m_defaults.getDirectiveParameters(key)[ index ]);
 }
@@ -118,14 +118,14 @@ size_t ConfigurationBlock::getSize_t(const std::string &key,
     }
     catch (const std::out_of_range &e)
     {
-        m_logger.log(DEBUG,
-                     "ConfigurationBlock::getSize_t: " + key + " not found");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getSize_t: " + key +
+                             " not found");
     }
     catch (const std::invalid_argument &e)
     {
-        m_logger.log(DEBUG, "ConfigurationBlock::getSize_t: " + key + " " +
-                                m_directives.at(key)->at(index) +
-                                " not an unsigned long");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getSize_t: " + key + " " +
+                             m_directives.at(key)->at(index) +
+                             " not an unsigned long");
     }
     return Converter::toUInt(m_defaults.getDirectiveParameters(key)[ index ]);
 }
@@ -146,14 +146,13 @@ bool ConfigurationBlock::getBool(const std::string &key, size_t index = 0) const
     }
     catch (const std::out_of_range &e)
     {
-        m_logger.log(DEBUG,
-                     "ConfigurationBlock::getBool: " + key + " not found");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getBool: " + key +
+                             " not found");
     }
     catch (const std::invalid_argument &e)
     {
-        m_logger.log(DEBUG, "ConfigurationBlock::getBool: " + key + " " +
-                                m_directives.at(key)->at(index) +
-                                " not a bool");
+        LOG(m_logger, DEBUG, "ConfigurationBlock::getBool: " + key + " " +
+                             m_directives.at(key)->at(index) + " not a bool");
     }
     return false;
 }
@@ -32,7 +32,7 @@ ConfigurationLoader::ConfigurationLoader(ILogger &logger) : m_logger(logger)
     m_reserved_symbols.push_back("~");
 
     m_config = new ConfigurationBlock(m_logger, "main", m_defaults);
-    m_logger.log(VERBOSE, "ConfigurationLoader created.");
+    LOG(m_logger, VERBOSE, "ConfigurationLoader created.");
 }
 
 // todo: delete all the blocks.
@@ -151,7 +151,7 @@ IConfiguration &ConfigurationLoader::loadConfiguration(const std::string &path)
         throw InvalidConfigFileError();
 
     // Log the loading of the configuration file.
-    m_logger.log(INFO, "Loading configuration file: '" + path + "'.");
+    LOG(m_logger, INFO, "Loading configuration file: '" + path + "'.");
     Grammar grammar;
     SubsetSymbolMatching subset_matching;
     EqualSymbolMatching equal_matching;
@@ -267,6 +267,6 @@ IConfiguration &ConfigurationLoader::loadConfiguration(const std::string &path)
     conf_stream.close();
 
     // Log the end of loading of the configuration file.
-    m_logger.log(VERBOSE, "Configuration file loaded successfully.");
+    LOG(m_logger, VERBOSE, "Configuration file loaded successfully.");
     return *m_config;
 }
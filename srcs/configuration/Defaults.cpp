@@ -4,13 +4,17 @@ Defaults::Defaults()
 {
     m_directive_parameters[ "client_header_buffer_size" ].push_back("1024");
     m_directive_parameters[ "client_max_uri_size" ].push_back("1024");
+    m_directive_parameters[ "large_client_header_buffers" ].push_back("4");
+    m_directive_parameters[ "large_client_header_buffers" ].push_back("8192");
     m_directive_parameters[ "client_body_buffer_size" ].push_back("1024");
     m_directive_parameters[ "client_max_body_size" ].push_back("110000000");
+    m_directive_parameters[ "client_body_temp_path" ].push_back("tmp");
     m_directive_parameters[ "listen" ].push_back("8080");
     m_directive_parameters[ "server_name" ].push_back("default");
     m_directive_parameters[ "error_log" ].push_back("logs/error.log");
     m_directive_parameters[ "error_log" ].push_back("verbose");
     m_directive_parameters[ "access_log" ].push_back("logs/access.log");
+    m_directive_parameters[ "log_async" ].push_back("off");
     m_directive_parameters[ "deny" ].push_back("all");
     m_block_parameters[ "location" ].push_back("/");
     m_block_parameters[ "limit_except" ].push_back("GET");
@@ -22,8 +26,23 @@ Defaults::Defaults()
     m_directive_parameters[ "index" ].push_back("index.html");
     m_directive_parameters[ "path" ].push_back("/"); // temp for testing
     m_directive_parameters[ "python_cgi_path" ].push_back("/usr/bin/python3");
+    m_directive_parameters[ "keepalive_timeout" ].push_back("75");
+    m_directive_parameters[ "keepalive_requests" ].push_back("1000");
     m_directive_parameters[ "worker_connections" ].push_back("1024");
+    m_directive_parameters[ "worker_processes" ].push_back("1");
+    m_directive_parameters[ "worker_rlimit_nofile" ].push_back("0");
+    m_directive_parameters[ "use" ].push_back("poll");
+    m_directive_parameters[ "edge_triggered" ].push_back("off");
     m_directive_parameters[ "autoindex" ].push_back("off");
+    m_directive_parameters[ "sendfile" ].push_back("off");
+    m_directive_parameters[ "file_cache_size" ].push_back("0");
+    m_directive_parameters[ "file_cache_max_file_size" ].push_back("1048576");
+    m_directive_parameters[ "file_cache_valid" ].push_back("1");
+    m_directive_parameters[ "open_file_cache" ].push_back("off");
+    m_directive_parameters[ "open_file_cache_valid" ].push_back("60");
+    m_directive_parameters[ "open_file_cache_errors" ].push_back("off");
+    m_directive_parameters[ "gzip_static" ].push_back("off");
+    m_directive_parameters[ "brotli_static" ].push_back("off");
     m_directive_parameters[ "default_port" ].push_back("80");
 }
 
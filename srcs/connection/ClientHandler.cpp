@@ -1,6 +1,7 @@
 #include "../../includes/connection/ClientHandler.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
 #include "../../includes/utils/Converter.hpp"
+#include <cerrno>
 
 /*
  * Summary:
@@ -14,14 +15,14 @@ ClientHandler::ClientHandler(const ISocket &socket, ILogger &logger)
     : m_socket(socket), m_logger(logger)
 {
     // Log the creation of the ClientHandler
-    m_logger.log(VERBOSE, "Clienthandler created.");
+    LOG(m_logger, VERBOSE, "Clienthandler created.");
 }
 
 // Destructor
 ClientHandler::~ClientHandler()
 {
     // Log the destruction of the ClientHandler
-    m_logger.log(VERBOSE, "Clienthandler destroyed.");
+    LOG(m_logger, VERBOSE, "Clienthandler destroyed.");
 }
 
 // Setter method to set the socket descriptor
@@ -39,10 +40,13 @@ const std::vector<char> ClientHandler::readRequest() const
     ssize_t bytes_read = 0;
     std::vector<char> buffer(buffer_size);
 
-    // Read data from the client socket
+    // Read data from the client socket until it is drained, a short read
+    // meaning the socket has no more data for now, or until the maximum read
+    // size is reached
     // Double the buffer as long as necessary
     while ((bytes_read = m_socket.recv(m_socket_descriptor, &buffer[ offset ],
-                                       max_read_size)) == max_read_size)
+                                       max_read_size)) == max_read_size &&
+           buffer_size < CLIENT_READ_MAX_SIZE)
     {
         // Move the offset to the end of the buffer
         offset += bytes_read;
@@ -58,7 +62,12 @@ const std::vector<char> ClientHandler::readRequest() const
     // NOTE that MSG_DONTWAIT might cause -1 to be returned
     // it is unclear if this is an error (ECONNRESET) or not
     // (EWOULDBLOCK/EAGAIN) without reading errno
-    if (bytes_read == -1)
+    // After filling the buffer, EWOULDBLOCK/EAGAIN only means the socket is
+    // drained
+    if (bytes_read == -1 && offset > 0 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK))
+        bytes_read = 0;
+    else if (bytes_read == -1)
     {
         buffer.clear();
         throw WebservException(ERROR,
@@ -71,10 +80,10 @@ const std::vector<char> ClientHandler::readRequest() const
     buffer.resize(offset + bytes_read);
 
     // Log the request read from the client
-    m_logger.log(EXHAUSTIVE,
-                 "[CLIENTHANDLER] Request on socket: " +
-                     Converter::toString(m_socket_descriptor) + ": \"" +
-                     std::string(buffer.begin(), buffer.end()) + "\"");
+    LOG(m_logger, EXHAUSTIVE,
+        "[CLIENTHANDLER] Request on socket: " +
+            Converter::toString(m_socket_descriptor) + ": \"" +
+            std::string(buffer.begin(), buffer.end()) + "\"");
 
     // Return the buffer containing the request
     return buffer;
@@ -89,10 +98,10 @@ ssize_t ClientHandler::sendResponse(const std::vector<char> &response) const
                                 Converter::toString(m_socket_descriptor));
 
     // Log the response sent to the client
-    m_logger.log(VERBOSE,
-                 "[CLIENTHANDLER] Responded on socket: " +
-                     Converter::toString(m_socket_descriptor) + ": \"" +
-                     std::string(response.begin(), response.end()) + "\"");
+    LOG(m_logger, VERBOSE, "[CLIENTHANDLER] Responded on socket: " +
+                           Converter::toString(m_socket_descriptor) + ": \"" +
+                           std::string(response.begin(), response.end()) +
+                           "\"");
 
     // Return the number of bytes sent
     return bytesSent;
@@ -10,8 +10,8 @@
  * This class represents a network connection and interaction with a client.
  * It stores the socket descriptor, client IP address, port number, and remote
  * address, as well as pointers to the request and response objects. Its
- * lifetime is determined either by the 'Connection' header in the request or
- * the timeout value.
+ * lifetime is determined either by the 'Connection' header in the request,
+ * the number of requests served or the timeout value.
  *
  * It is owned by the ConnectionManager.
  *
@@ -20,21 +20,30 @@
 // Constructor
 Connection::Connection(
     std::pair<int, std::pair<std::string, std::string> > client_info,
-    ILogger &logger, IRequest *request, IResponse *response, time_t timeout)
+    ILogger &logger, IRequest *request, IResponse *response,
+    ITimerWheel &timer_wheel, time_t keepalive_timeout,
+    size_t keepalive_requests, time_t timeout)
     : m_socket_descriptor(client_info.first), m_ip(client_info.second.first),
       m_port(Converter::toInt(client_info.second.second)),
       m_remote_address(m_ip + ":" + client_info.second.second),
       m_cgi_output_pipe_read_end(-1), m_cgi_pid(-1), m_logger(logger),
-      m_request(request), m_response(response), m_timeout(timeout)
+      m_request(request), m_response(response), m_session(NULL),
+      m_timer_wheel(timer_wheel), m_timeout(timeout),
+      m_keepalive_timeout(keepalive_timeout),
+      m_keepalive_requests(keepalive_requests), m_request_count(0),
+      m_keep_alive(false),
+      m_timer(CONNECTION_TIMER, m_socket_descriptor),
+      m_cgi_timer(CGI_TIMER, m_socket_descriptor)
 {
-    m_last_access = time(NULL);
+    this->touch();
 }
 
 // Destructor
+// The request and the response belong to the factory, which takes them back
 Connection::~Connection()
 {
-    delete m_request;
-    delete m_response;
+    m_timer_wheel.cancel(m_timer);
+    m_timer_wheel.cancel(m_cgi_timer);
     if (m_cgi_pid != -1)
     {
         kill(m_cgi_pid, SIGKILL);
@@ -48,10 +57,18 @@ void Connection::setSession(ISession *session) { m_session = session; }
 // Clear CGI PID
 void Connection::clearCgiInfo()
 {
+    m_timer_wheel.cancel(m_cgi_timer);
     m_cgi_pid = -1;
     m_cgi_output_pipe_read_end = -1;
 }
 
+// Keep the connection after the response, within the configured limits
+void Connection::setKeepAlive(bool keep_alive)
+{
+    m_keep_alive = keep_alive && m_keepalive_timeout > 0 &&
+                   m_request_count + 1 < m_keepalive_requests;
+}
+
 // Getters
 int Connection::getSocketDescriptor() const { return m_socket_descriptor; }
 
@@ -74,46 +91,38 @@ ISession &Connection::getSession() const { return *m_session; }
 
 int Connection::getCgiPid() const { return m_cgi_pid; }
 
+bool Connection::isKeepAlive() const { return m_keep_alive; }
+
+size_t Connection::getRequestCount() const { return m_request_count; }
+
 void Connection::setCgiInfo(int cgi_pid, int cgi_output_pipe_read_end)
 {
     m_cgi_pid = cgi_pid;
-    m_cgi_start_time = time(NULL);
     m_cgi_output_pipe_read_end = cgi_output_pipe_read_end;
+
+    // Arm the CGI timeout
+    m_timer_wheel.schedule(m_cgi_timer, CGI_DEFAULT_TIMEOUT * 1000UL);
 }
 
 // Connection management
 void Connection::touch()
 {
-    // Get the current time
-    time_t now = time(NULL);
-
-    // Set time strings for logging
-    std::string last_access_string = ctime(&m_last_access);
-    std::string now_string = ctime(&now);
-
-    // Remove the newline characters from the strings; introduced by ctime
-    last_access_string.erase(last_access_string.length() - 1);
-    now_string.erase(now_string.length() - 1);
-
-    // Log the last access update
-    m_logger.log(VERBOSE, "Updating last access for connection with: " +
-                              m_remote_address + " from " + last_access_string +
-                              " to " + now_string);
-
-    // Update the last access time
-    m_last_access = now;
+    // Re-arm the idle timeout
+    m_timer_wheel.schedule(m_timer, m_timeout * 1000UL);
 }
 
-bool Connection::hasExpired() const
+// Replace the request and response of the served request and wait for the
+// next one
+// The caller hands the previous request and response back to the factory
+void Connection::reset(IRequest *request, IResponse *response)
 {
-    return time(NULL) - m_last_access > m_timeout;
-}
+    m_request = request;
+    m_response = response;
+    m_request_count++;
+    m_keep_alive = false;
 
-bool Connection::cgiHasExpired() const
-{
-    if (m_cgi_pid == -1)
-        return false;
-    return time(NULL) - m_cgi_start_time > CGI_DEFAULT_TIMEOUT;
+    // The next request must start within the keep-alive timeout
+    m_timer_wheel.schedule(m_timer, m_keepalive_timeout * 1000UL);
 }
 
 // Path: srcs/Connection.cpp
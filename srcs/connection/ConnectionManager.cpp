@@ -18,25 +18,28 @@
  */
 
 // Constructor
-ConnectionManager::ConnectionManager(ILogger &logger, IFactory &factory)
-    : m_last_garbage_collection(std::time(NULL)), m_factory(factory),
-      m_logger(logger)
+ConnectionManager::ConnectionManager(ILogger &logger, IFactory &factory,
+                                     DescriptorTable &descriptors)
+    : m_descriptors(descriptors), m_factory(factory), m_logger(logger)
 {
     std::srand(static_cast<unsigned int>(
         std::time(NULL))); // Seed srand, to create session id's
 
     // Log the creation of the ConnectionManager
-    m_logger.log(VERBOSE, "ConnectionManager created.");
+    LOG(m_logger, VERBOSE, "ConnectionManager created.");
 }
 
 // Destructor
 ConnectionManager::~ConnectionManager()
 {
-    // Delete all connections
-    for (std::map<SocketDescriptor_t, IConnection *>::iterator it =
-             m_connections.begin();
-         it != m_connections.end(); it++)
-        delete it->second;
+    // Hand all connections back to the factory
+    for (size_t descriptor = 0; descriptor < m_descriptors.size();
+         descriptor++)
+    {
+        IConnection *&connection = m_descriptors[ descriptor ].connection;
+        m_factory.releaseConnection(connection);
+        connection = NULL;
+    }
 
     // Delete all sessions
     for (std::map<SessionId_t, ISession *>::iterator it = m_sessions.begin();
@@ -44,7 +47,7 @@ ConnectionManager::~ConnectionManager()
         delete it->second;
 
     // Log the destruction of the ConnectionManager
-    m_logger.log(VERBOSE, "ConnectionManager destroyed.");
+    LOG(m_logger, VERBOSE, "ConnectionManager destroyed.");
 }
 
 // Add a new connection
@@ -52,11 +55,10 @@ void ConnectionManager::addConnection(
     std::pair<int, std::pair<std::string, std::string> > client_info)
 {
     IConnection *connection = m_factory.createConnection(client_info);
-    m_connections[ client_info.first ] = connection;
+    m_descriptors[ client_info.first ].connection = connection;
 
     // Log the new connection
-    m_logger.log(
-        VERBOSE,
+    LOG(m_logger, VERBOSE,
         "[CONNECTIONMANAGER] New connection created. Remote address: " +
             client_info.second.first + ":" + client_info.second.second +
             " Socket: " + Converter::toString(client_info.first));
@@ -69,19 +71,47 @@ void ConnectionManager::removeConnection(SocketDescriptor_t socket_descriptor)
     close(socket_descriptor);
 
     // Remove the connection
-    delete m_connections[ socket_descriptor ];
-    m_connections[ socket_descriptor ] = NULL;
+    IConnection *connection = m_descriptors.at(socket_descriptor).connection;
+    if (connection != NULL)
+    {
+        m_factory.releaseConnection(connection);
+        m_descriptors[ socket_descriptor ].connection = NULL;
+    }
 
     // Log the removed connection
-    m_logger.log(VERBOSE, "Connection removed. Socket: " +
-                              Converter::toString(socket_descriptor));
+    LOG(m_logger, VERBOSE, "Connection removed. Socket: " +
+                           Converter::toString(socket_descriptor));
+}
+
+// Reset a kept-alive connection for its next request
+void ConnectionManager::resetConnection(SocketDescriptor_t socket_descriptor)
+{
+    IConnection &connection = this->getConnection(socket_descriptor);
+
+    // Carry the bytes pipelined behind the served request over to the next
+    IRequest *request = m_factory.createRequest();
+    request->appendBuffer(connection.getRequest().getBuffer());
+
+    // Replace the request and the response, handing the served ones back to
+    // the factory
+    IRequest *served_request = &connection.getRequest();
+    IResponse *served_response = &connection.getResponse();
+    connection.reset(request, m_factory.createResponse());
+    m_factory.releaseRequest(served_request);
+    m_factory.releaseResponse(served_response);
+
+    // Log the reset connection
+    LOG(m_logger, VERBOSE, "Connection kept alive. Socket: " +
+                           Converter::toString(socket_descriptor) +
+                           " Requests served: " +
+                           Converter::toString(connection.getRequestCount()));
 }
 
 // Get a reference to a connection
 IConnection &
 ConnectionManager::getConnection(SocketDescriptor_t socket_descriptor)
 {
-    IConnection *connection = m_connections.at(socket_descriptor);
+    IConnection *connection = m_descriptors.at(socket_descriptor).connection;
     if (connection == NULL)
         throw std::runtime_error("[CONNECTIONMANAGER] Connection not found.");
     return *connection;
@@ -90,7 +120,7 @@ ConnectionManager::getConnection(SocketDescriptor_t socket_descriptor)
 // Get a reference to a request
 IRequest &ConnectionManager::getRequest(SocketDescriptor_t socket_descriptor)
 {
-    return m_connections[ socket_descriptor ]->getRequest();
+    return this->getConnection(socket_descriptor).getRequest();
 }
 
 // Get a reference to a response
@@ -100,7 +130,7 @@ IResponse &ConnectionManager::getResponse(SocketDescriptor_t socket_descriptor)
     //     throw std::runtime_error("[CONNECTIONMANAGER] Connection not
     //     found.");
 
-    return m_connections[ socket_descriptor ]->getResponse();
+    return this->getConnection(socket_descriptor).getResponse();
 }
 
 // Add a new session
@@ -116,8 +146,8 @@ SessionId_t ConnectionManager::addSession()
     m_sessions[ session_id ] = session;
 
     // Log the new session
-    m_logger.log(VERBOSE, "New session created. Session ID: " +
-                              Converter::toString(session_id));
+    LOG(m_logger, VERBOSE, "New session created. Session ID: " +
+                           Converter::toString(session_id));
 
     // Return the session id
     return session_id;
@@ -126,12 +156,17 @@ SessionId_t ConnectionManager::addSession()
 // Remove a session
 void ConnectionManager::removeSession(SessionId_t session_id)
 {
-    delete m_sessions[ session_id ];
-    m_sessions[ session_id ] = NULL;
+    std::map<SessionId_t, ISession *>::iterator it =
+        m_sessions.find(session_id);
+    if (it != m_sessions.end())
+    {
+        delete it->second;
+        m_sessions.erase(it);
+    }
 
     // Log the removed session
-    m_logger.log(VERBOSE, "Session removed. Session ID: " +
-                              Converter::toString(session_id));
+    LOG(m_logger, VERBOSE, "Session removed. Session ID: " +
+                           Converter::toString(session_id));
 }
 
 // Get a reference to a session
@@ -186,8 +221,11 @@ void ConnectionManager::assignSessionToConnection(IConnection &connection,
         else
         {
             // Log the session assignment
-            m_logger.log(VERBOSE, "Existing session found. Session ID: " +
-                                      Converter::toString(session_id));
+            LOG(m_logger, VERBOSE, "Existing session found. Session ID: " +
+                                   Converter::toString(session_id));
+
+            // Keep the session alive
+            m_sessions[ session_id ]->touch();
         }
     }
 
@@ -198,108 +236,25 @@ void ConnectionManager::assignSessionToConnection(IConnection &connection,
     response.addCookie("session", Converter::toString(session_id));
 
     // Log the session assignment
-    m_logger.log(INFO,
-                 "Session ID: " + Converter::toString(session_id) +
-                     " Assigned to connection on Socket: " +
-                     Converter::toString(connection.getSocketDescriptor()) +
-                     " with client: " + connection.getRemoteAddress());
+    LOG(m_logger, INFO, "Session ID: " + Converter::toString(session_id) +
+                        " Assigned to connection on Socket: " +
+                        Converter::toString(connection.getSocketDescriptor()) +
+                        " with client: " + connection.getRemoteAddress());
 }
-#include <iostream>
-#include <unistd.h>
-// Retire idle sessions and reap zombie processes
+// Reap zombie processes; idle connections, sessions and CGI processes are
+// retired by their timers
 void ConnectionManager::collectGarbage()
 {
-    // Check if it is time to collect garbage
-    time_t now = std::time(NULL);
-    if (now - m_last_garbage_collection < GARBAGE_COLLECTOR_INTERVAL)
-    {
-        return; // Not yet time for garbage collection
-    }
-
-    // Update the last garbage collection time
-    m_last_garbage_collection = now;
-
     // Log the garbage collection
-    m_logger.log(VERBOSE, "Garbage collection started.");
+    LOG(m_logger, VERBOSE, "Garbage collection started.");
 
     // Reap zombie processes
     while (waitpid(-1, NULL, WNOHANG) > 0)
         ; // Reap all zombie processes
 
-    // Make note of the number of sessions before garbage collection
-    size_t session_count = m_sessions.size();
-    std::vector<SessionId_t> sessions_to_erase;
-
-    // Iterate over all sessions
-    for (std::map<SessionId_t, ISession *>::iterator it = m_sessions.begin();
-         it != m_sessions.end(); it++)
-    {
-        // Check if the session has expired
-        if (it->second && it->second->hasExpired())
-        {
-            // Log the expired session
-            m_logger.log(VERBOSE, "Session expired. Session ID: " +
-                                      Converter::toString(it->first));
-
-            // Remove the session
-            this->removeSession(it->first);
-            sessions_to_erase.push_back(it->first);
-        }
-    }
-
-    for (size_t i = 0; i < sessions_to_erase.size(); i++)
-    {
-        m_sessions.erase(sessions_to_erase[ i ]);
-    }
-
-    std::vector<SocketDescriptor_t> connections_to_erase;
-    // Iterate over all connections
-    for (std::map<SocketDescriptor_t, IConnection *>::iterator it =
-             m_connections.begin();
-         it != m_connections.end(); it++)
-    {
-        // Check if the Cgi Process has expired
-        if (it->second && it->second->cgiHasExpired())
-        {
-            // Get the Cgi Process ID
-            int cgi_process_id = it->second->getCgiPid();
-
-            // kill the Cgi Process
-            kill(cgi_process_id, SIGKILL);
-
-            // Close the associated pipe
-            close(it->second->getCgiOutputPipeReadEnd());
-
-            // Log the expired Process
-            m_logger.log(VERBOSE, "Cgi Process expired and killed. PID: " +
-                                      Converter::toString(cgi_process_id));
-        }
-        // Check if the connection has expired
-        if (it->second && it->second->hasExpired())
-        {
-            // Log the expired connection
-            m_logger.log(VERBOSE, "Connection expired. Socket: " +
-                                      Converter::toString(it->first));
-
-            // Remove the connection
-            this->removeConnection(it->first);
-            connections_to_erase.push_back(it->first);
-        }
-    }
-
-    for (size_t i = 0; i < connections_to_erase.size(); i++)
-    {
-        m_connections.erase(connections_to_erase[ i ]);
-    }
-    // Calculate the number of sessions retired
-    size_t retired_sessions = session_count - m_sessions.size();
-
     // Log the garbage collection
-    m_logger.log(DEBUG, "Garbage collection completed. Retired " +
-                            Converter::toString(retired_sessions) + " session" +
-                            (retired_sessions == 1 ? "." : "s.") +
-                            " Remaining sessions: " +
-                            Converter::toString(m_sessions.size()) + ".");
+    LOG(m_logger, DEBUG, "Garbage collection completed. Active sessions: " +
+                         Converter::toString(m_sessions.size()) + ".");
 }
 
 // Generate a unique session ID
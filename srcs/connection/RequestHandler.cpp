@@ -1,7 +1,9 @@
 #include "../../includes/connection/RequestHandler.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
 #include "../../includes/utils/Converter.hpp"
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <fcntl.h>
 #include <sys/fcntl.h>
 #include <sys/types.h>
@@ -30,27 +32,34 @@ RequestHandler::RequestHandler(IBufferManager &buffer_manager,
                                const IConfiguration &configuration,
                                IRouter &router, ILogger &logger,
                                const IExceptionHandler &exception_handler,
-                               IClientHandler &client_handler)
+                               IClientHandler &client_handler,
+                               DescriptorTable &descriptors)
     : m_buffer_manager(buffer_manager),
       m_connection_manager(connection_manager),
       m_client_handler(client_handler), m_request_parser(configuration, logger),
       m_router(router), m_http_helper(configuration), m_logger(logger),
-      m_exception_handler(exception_handler)
+      m_exception_handler(exception_handler), m_descriptors(descriptors),
+      m_client_body_temp_path(configuration.getString("client_body_temp_path"))
 {
+    // The body files are created in the directory of the uploads
+    if (m_client_body_temp_path.empty() ||
+        m_client_body_temp_path[ m_client_body_temp_path.size() - 1 ] != '/')
+        m_client_body_temp_path += "/";
+
     // Log the creation of the RequestHandler instance.
-    m_logger.log(VERBOSE, "RequestHandler instance created.");
+    LOG(m_logger, VERBOSE, "RequestHandler instance created.");
 }
 
 // Destructor
 RequestHandler::~RequestHandler()
 {
     // Log the destruction of the RequestHandler instance.
-    m_logger.log(VERBOSE, "RequestHandler instance destroyed.");
+    LOG(m_logger, VERBOSE, "RequestHandler instance destroyed.");
 }
 
 // Handles a client request
 // Returns Cgi Info for dynamic content or -1 for static content and invalid
-// requests
+// requests, -5 if the previous response is still pending
 Triplet_t RequestHandler::handleRequest(int socket_descriptor)
 {
     // Give the 'ClientHandler' the current socket descriptor
@@ -63,36 +72,96 @@ Triplet_t RequestHandler::handleRequest(int socket_descriptor)
     // Update the connection's last activity time
     connection.touch();
 
+    // Read the request in slices, each processed before the next is read, so
+    // that a large body is written out as it arrives. A full slice may leave
+    // more data in the socket, which edge-triggered polling would not report
+    // again
     // Get a reference to the Request
     IRequest &request = connection.getRequest();
 
-    // Get a reference to the Response
-    IResponse &response = connection.getResponse();
-
     RequestState &state = request.getState();
 
-    try
+    // The socket is not read while the previous response is pending, so that
+    // a client pipelining without reading its responses is held back by its
+    // socket buffers rather than by the memory of the worker
+    if (state.finished())
+    {
+        // log the situation
+        LOG(m_logger, VERBOSE,
+            "RequestHandler::handleRequest: Read suspended - previous request "
+            "pending.");
+        return Triplet_t(-5, std::pair<int, int>(-1, -1));
+    }
+
+    Triplet_t info(-2, std::pair<int, int>(-1, -1));
+    bool first_read = true;
+    bool full_read = true;
+    while (full_read && !state.finished())
     {
         // Read the raw request from the client
-        std::vector<char> raw_request = m_client_handler.readRequest();
+        std::vector<char> raw_request;
+        try
+        {
+            raw_request = m_client_handler.readRequest();
+        }
+        catch (const WebservException &e)
+        {
+            // The socket was drained by the previous slice, any error is
+            // reported again by the next poll
+            if (!first_read)
+                break;
+
+            return m_handleRequestException(socket_descriptor, e);
+        }
 
         // Check if the client has disconnected
         if (raw_request.empty())
         {
+            // EOF read after a slice, answer what was read first
+            if (!first_read)
+                break;
+
             // EOF read, indicating an orderly disconnect
             return Triplet_t(-3, std::pair<int, int>(-1, -1));
         }
+        first_read = false;
+        full_read = raw_request.size() == CLIENT_READ_MAX_SIZE;
 
         // Append the raw request to the request buffer
         request.appendBuffer(raw_request);
 
+        // Process the buffered request, the rest of a slice read past it
+        // staying buffered until the response is sent
+        info = this->processRequest(socket_descriptor);
+    }
+    return info;
+}
+
+// Processes the request bytes buffered for a client, without reading the
+// socket: used for requests pipelined behind a kept-alive request
+// Returns Cgi Info for dynamic content or -1 for static content and invalid
+// requests
+Triplet_t RequestHandler::processRequest(int socket_descriptor)
+{
+    // Get a reference to the Connection
+    IConnection &connection =
+        m_connection_manager.getConnection(socket_descriptor);
+
+    // Get a reference to the Request
+    IRequest &request = connection.getRequest();
+
+    // Get a reference to the Response
+    IResponse &response = connection.getResponse();
+
+    RequestState &state = request.getState();
+
+    try
+    {
         if (state.initial())
         {
-            // If raw request contains CRLF CRLF, we move to the next stage
+            // Resume scanning the head where the previous read left it,
             // CRLF CRLF (\r\n\r\n) marks the end of the headers
-            std::vector<char> buffer = request.getBuffer();
-            std::string buffer_str(buffer.begin(), buffer.end());
-            if (buffer_str.find("\r\n\r\n") != std::string::npos)
+            if (m_request_parser.parseHead(request))
             {
                 state.initial(false);
                 state.headers(true); // Because we now have all the headers
@@ -100,10 +169,9 @@ Triplet_t RequestHandler::handleRequest(int socket_descriptor)
             else
             {
                 // log the situation
-                m_logger.log(VERBOSE,
-                             "RequestHandler::handleRequest: Request is "
-                             "incomplete - state: initial. Buffer: " +
-                                 buffer_str.substr(0, 10));
+                LOG(m_logger, VERBOSE,
+                    "RequestHandler::handleRequest: Request is incomplete - "
+                    "state: initial.");
                 return Triplet_t(-2, std::pair<int, int>(-1, -1));
             }
         }
@@ -111,14 +179,24 @@ Triplet_t RequestHandler::handleRequest(int socket_descriptor)
         {
             m_request_parser.parseRequest(request);
             state.headers(false);
+            // Decide whether the connection outlives the response
+            m_setKeepAlive(connection, request);
             // Assign session to connection
             m_connection_manager.assignSessionToConnection(connection, request,
                                                            response);
+            // Route the request before its body arrives, so that the body is
+            // checked against the route and uploads streamed to its root
+            state.setRoute(m_router.getRoute(&request, &response));
+            // A CGI reads its body from a file, written as the body arrives
+            if (state.getRoute()->isCGI())
+                m_openBodyFile(request);
+            m_request_parser.parseBody(request);
             if (!state.finished())
             {
                 // log the situation
-                m_logger.log(VERBOSE, "RequestHandler::handleRequest: Request "
-                                      "is incomplete - state: headers done.");
+                LOG(m_logger, VERBOSE,
+                    "RequestHandler::handleRequest: Request is incomplete - "
+                    "state: headers done.");
                 return Triplet_t(-2, std::pair<int, int>(-1, -1));
             }
         }
@@ -128,50 +206,31 @@ Triplet_t RequestHandler::handleRequest(int socket_descriptor)
             if (!state.finished())
             {
                 // log the situation
-                m_logger.log(VERBOSE, "RequestHandler::handleRequest: Request "
-                                      "is incomplete - state: partial body.");
+                LOG(m_logger, VERBOSE,
+                    "RequestHandler::handleRequest: Request is incomplete - "
+                    "state: partial body.");
                 return Triplet_t(-2, std::pair<int, int>(-1, -1));
             }
         }
 
-        state.setRoute(m_router.getRoute(&request, &response));
-
-        // in case of cgi, create a temporary file
+        // in case of cgi, the body file is complete
         if (state.getRoute()->isCGI())
         {
-            // create a body file
-            std::string body_file_path;
-            int fd;
-            do
-            {
-                // Set a unique file path for the body file
-                int num = rand() % 1000000;
-                body_file_path = "tmp/body_file_" + Converter::toString(num);
-                fd = open(body_file_path.c_str(), O_CREAT | O_WRONLY, 0666);
-            } while (fd == -1); // if the file already exists, try again
-
-            // set the file descriptor in the request
-            request.setBodyFilePath(body_file_path);
+            // hand the body file over to the CGI execution, which closes it
+            int fd = request.getBodyFileDescriptor();
+            request.setBodyFileDescriptor(-1);
 
-            // set the file descriptor to non-blocking
-            fcntl(fd, F_SETFL, O_NONBLOCK);
+            // link the file descriptor to the client socket
+            m_descriptors[ fd ].client_socket = socket_descriptor;
 
-            // push the request body to the buffermanager
-            m_buffer_manager.pushFileBuffer(fd, request.getBody(), 0);
-
-            // add the file descriptor to the descriptor-to-client-socket map
-            m_pipe_routes[ fd ] = socket_descriptor;
-
-            // return -4 and the fd of the temp file
-            return Triplet_t(-4, std::pair<int, int>(fd, -1));
+            // return the CGI info
+            return this->executeCgi(fd);
         }
         else
         {
             // If the route is not CGI, we can execute the route
             m_router.execRoute(state.getRoute(), &request, &response);
 
-            state.reset();
-
             // Push the response to the buffer
             m_sendResponse(socket_descriptor);
 
@@ -182,39 +241,120 @@ Triplet_t RequestHandler::handleRequest(int socket_descriptor)
 
     catch (const WebservException &e)
     {
-        // Set the request state to finished
-        state.finished(true);
-
-        // Get the status code
-        int status_code;
-        if (dynamic_cast<const HttpStatusCodeException *>(&e))
-            status_code =
-                e.getErrorCode(); // An HttpStatusCodeException was thrown
-        else if (dynamic_cast<const HttpRedirectException *>(&e))
-            status_code = 301; // Moved Permanently (Redirect
-        else
-            status_code = 500; // Internal Server Error; Default status code for
-                               // other exceptions
+        return m_handleRequestException(socket_descriptor, e);
+    }
+}
+
+// Creates the temporary file a CGI reads its request body from, so that the
+// body can be written to it as it arrives
+void RequestHandler::m_openBodyFile(IRequest &request)
+{
+    std::string body_file_path;
+    int fd;
+    do
+    {
+        // Set a unique file path for the body file
+        int num = rand() % 1000000;
+        body_file_path =
+            m_client_body_temp_path + "body_file_" + Converter::toString(num);
+        fd = open(body_file_path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0666);
+    } while (fd == -1 && errno == EEXIST); // if the file already exists, try
+                                           // again
+    if (fd == -1)
+        throw HttpStatusCodeException(INTERNAL_SERVER_ERROR,
+                                      "Failed to create body file " +
+                                          body_file_path + ": " +
+                                          strerror(errno));
+
+    // keep the file out of the CGI processes, they open it by its path
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // set the file in the request
+    request.setBodyFilePath(body_file_path);
+    request.setBodyFileDescriptor(fd);
+}
 
-        // Log the exception
-        m_exception_handler.handleException(
-            e, "RequestHandler::processRequest socket=\"" +
-                   Converter::toString(socket_descriptor) + "\"");
+// Handles exceptions thrown while processing a request
+// Returns -1 as the error or redirect response is static
+Triplet_t RequestHandler::m_handleRequestException(int socket_descriptor,
+                                                   const WebservException &e)
+{
+    // Get a reference to the Connection
+    IConnection &connection =
+        m_connection_manager.getConnection(socket_descriptor);
 
-        if (status_code == 301) // Redirect
-        {
-            // Handle redirect response
-            this->handleRedirectResponse(socket_descriptor, e.what());
-        }
-        else
-        {
-            // Handle error response
-            this->handleErrorResponse(socket_descriptor, status_code);
-        }
+    // Get a reference to the RequestState
+    RequestState &state = connection.getRequest().getState();
+
+    // The rest of an unfinished request cannot be told apart from the next
+    // one, close the connection after the response
+    if (!state.finished())
+        connection.setKeepAlive(false);
+
+    // Set the request state to finished
+    state.finished(true);
+
+    // Get the status code
+    int status_code;
+    if (dynamic_cast<const HttpStatusCodeException *>(&e))
+        status_code = e.getErrorCode(); // An HttpStatusCodeException was thrown
+    else if (dynamic_cast<const HttpRedirectException *>(&e))
+        status_code = 301; // Moved Permanently (Redirect
+    else
+        status_code = 500; // Internal Server Error; Default status code for
+                           // other exceptions
+
+    // Log the exception
+    m_exception_handler.handleException(
+        e, "RequestHandler::processRequest socket=\"" +
+               Converter::toString(socket_descriptor) + "\"");
 
-        // return -1
-        return Triplet_t(-1, std::pair<int, int>(-1, -1));
+    if (status_code == 301) // Redirect
+    {
+        // Handle redirect response
+        this->handleRedirectResponse(socket_descriptor, e.what());
+    }
+    else
+    {
+        // Handle error response
+        this->handleErrorResponse(socket_descriptor, status_code);
     }
+
+    // return -1
+    return Triplet_t(-1, std::pair<int, int>(-1, -1));
+}
+
+// Decides whether the connection outlives the response: HTTP/1.1 keeps it
+// unless the client asks to close it, HTTP/1.0 closes it unless the client asks
+// to keep it
+void RequestHandler::m_setKeepAlive(IConnection &connection,
+                                    const IRequest &request)
+{
+    // Get the 'Connection' header in lowercase
+    std::string connection_header = request.getHeaderValue(CONNECTION);
+    for (std::string::iterator it = connection_header.begin();
+         it != connection_header.end(); ++it)
+        *it = std::tolower(static_cast<unsigned char>(*it));
+
+    if (request.getHttpVersion() == HTTP_1_1)
+        connection.setKeepAlive(connection_header.find("close") ==
+                                std::string::npos);
+    else
+        connection.setKeepAlive(connection_header.find("keep-alive") !=
+                                std::string::npos);
+}
+
+// Resets the connection for its next request if it is kept alive
+// Returns false if the connection must be closed
+bool RequestHandler::keepAlive(int socket_descriptor)
+{
+    // Check if the connection outlives the response
+    if (!m_connection_manager.getConnection(socket_descriptor).isKeepAlive())
+        return false;
+
+    // Reset the request and the response, keeping the pipelined bytes
+    m_connection_manager.resetConnection(socket_descriptor);
+    return true;
 }
 #include <iostream>
 // Execute a Cgi route
@@ -224,10 +364,10 @@ Triplet_t RequestHandler::executeCgi(int body_descriptor)
     close(body_descriptor);
 
     // Get the client socket descriptor linked to the body_fd
-    int socket_descriptor = m_pipe_routes[ body_descriptor ];
+    int socket_descriptor = m_descriptors.at(body_descriptor).client_socket;
 
-    // Remove the file descriptor from the descriptor-to-client-socket map
-    m_pipe_routes.erase(body_descriptor);
+    // Unlink the file descriptor from the client socket
+    m_descriptors[ body_descriptor ].client_socket = -1;
 
     // Get a reference to the Connection
     IConnection &connection =
@@ -249,8 +389,6 @@ Triplet_t RequestHandler::executeCgi(int body_descriptor)
     Triplet_t cgi_info =
         m_router.execRoute(state.getRoute(), &request, &response);
 
-    state.reset();
-
     // Get CGI Info
     int cgi_pid = cgi_info.first;
     int cgi_output_pipe_read_end = cgi_info.second.first;
@@ -258,8 +396,9 @@ Triplet_t RequestHandler::executeCgi(int body_descriptor)
     // Record the cgi info
     connection.setCgiInfo(cgi_pid, cgi_output_pipe_read_end);
 
-    // Record the pipes to connection socket mappings
-    m_pipe_routes[ cgi_output_pipe_read_end ] = socket_descriptor;
+    // Link the pipe to the connection socket
+    m_descriptors[ cgi_output_pipe_read_end ].client_socket =
+        socket_descriptor;
 
     return cgi_info; // cgi content
 }
@@ -269,10 +408,10 @@ Triplet_t RequestHandler::executeCgi(int body_descriptor)
 int RequestHandler::handlePipeException(int pipe_descriptor)
 {
     // Get the client socket descriptor linked to the pipe
-    int client_socket = m_pipe_routes[ pipe_descriptor ];
+    int client_socket = m_descriptors.at(pipe_descriptor).client_socket;
 
-    // Remove the pipe descriptor from the map
-    m_pipe_routes.erase(pipe_descriptor);
+    // Unlink the pipe descriptor from the client socket
+    m_descriptors[ pipe_descriptor ].client_socket = -1;
 
     // Handle error response
     this->handleErrorResponse(client_socket, INTERNAL_SERVER_ERROR);
@@ -288,7 +427,8 @@ int RequestHandler::handlePipeException(int pipe_descriptor)
 int RequestHandler::handlePipeRead(int cgi_output_pipe_read_end)
 {
     // Get the client socket descriptor linked to the pipe
-    int client_socket = m_pipe_routes[ cgi_output_pipe_read_end ];
+    int client_socket =
+        m_descriptors.at(cgi_output_pipe_read_end).client_socket;
 
     // Give the ClientHandler the current socket descriptor
     m_client_handler.setSocketDescriptor(client_socket);
@@ -303,35 +443,33 @@ int RequestHandler::handlePipeRead(int cgi_output_pipe_read_end)
     size_t read_buffer_size = 4096;
     ssize_t read_return_value;
 
-    // Read the response from the pipe until the pipe is empty or blocks
+    // Read the response from the pipe until the end of file or until it
+    // blocks
     do
     {
         // Resize the response buffer
-        response_buffer.resize(response_buffer.size() + read_buffer_size);
+        size_t buffer_size = response_buffer.size();
+        response_buffer.resize(buffer_size + read_buffer_size);
 
         // Read the response from the pipe
-        read_return_value = read(cgi_output_pipe_read_end,
-                                 response_buffer.data() +
-                                     response_buffer.size() - read_buffer_size,
-                                 read_buffer_size);
-    } while (read_return_value == static_cast<ssize_t>(read_buffer_size));
+        read_return_value =
+            read(cgi_output_pipe_read_end, response_buffer.data() + buffer_size,
+                 read_buffer_size);
 
-    // Handle blocking read
-    if (read_return_value < 0)
-    {
         // Resize the response buffer to the actual size
-        response_buffer.resize(response_buffer.size() - read_buffer_size);
+        response_buffer.resize(buffer_size +
+                               (read_return_value > 0 ? read_return_value : 0));
+    } while (read_return_value > 0);
 
+    // Handle blocking read, the CGI process has not closed its output yet
+    if (read_return_value < 0)
+    {
         // return -1 to indicate that we are not done reading
         return -1;
     }
 
-    // Resize the response buffer to the actual size
-    response_buffer.resize(response_buffer.size() - read_buffer_size +
-                           read_return_value);
-
     // print the response
-    m_logger.log(VERBOSE, "CGI response received 100%");
+    LOG(m_logger, VERBOSE, "CGI response received 100%");
 
     // Get the child process exit status without blocking
     int cgi_pid = m_connection_manager.getConnection(client_socket).getCgiPid();
@@ -369,10 +507,10 @@ int RequestHandler::handlePipeRead(int cgi_output_pipe_read_end)
         if (WIFEXITED(child_exit_status))
         {
             exit_code = WEXITSTATUS(child_exit_status);
-            m_logger.log(VERBOSE, "CGI process ID " +
-                                      Converter::toString(cgi_pid) +
-                                      " exited normally with exit code " +
-                                      Converter::toString(exit_code) + ".");
+            LOG(m_logger, VERBOSE, "CGI process ID " +
+                                   Converter::toString(cgi_pid) +
+                                   " exited normally with exit code " +
+                                   Converter::toString(exit_code) + ".");
         }
         else if (WIFSIGNALED(child_exit_status))
         {
@@ -397,8 +535,8 @@ int RequestHandler::handlePipeRead(int cgi_output_pipe_read_end)
 
     // Clean up
 
-    // Remove the descriptors from the pipe;socket map
-    m_pipe_routes.erase(cgi_output_pipe_read_end);
+    // Unlink the pipe from the client socket
+    m_descriptors[ cgi_output_pipe_read_end ].client_socket = -1;
 
     // Reset the CGI info
     m_connection_manager.getConnection(client_socket).clearCgiInfo();
@@ -410,17 +548,36 @@ int RequestHandler::handlePipeRead(int cgi_output_pipe_read_end)
 // Sends the response to the buffer
 int RequestHandler::m_sendResponse(int socket_descriptor)
 {
+    // Get a reference to the Connection
+    IConnection &connection =
+        m_connection_manager.getConnection(socket_descriptor);
+
     // Get a reference to the Response
-    IResponse &response = m_connection_manager.getResponse(socket_descriptor);
+    IResponse &response = connection.getResponse();
 
-    // Serialise the response
-    std::vector<char> serialised_response = response.serialise();
+    // Tell the client whether the connection outlives the response
+    response.addHeader(CONNECTION,
+                       connection.isKeepAlive() ? "keep-alive" : "close");
 
-    // Push the response to the buffer
-    m_buffer_manager.pushSocketBuffer(socket_descriptor, serialised_response);
+    // Serialise the head of the response, the body is handed over as is
+    std::vector<char> head = response.serialiseHead();
+
+    // Push the response to the buffer, a file body being sent from its
+    // descriptor
+    if (response.hasBodyFile())
+        m_buffer_manager.pushSendfileBuffer(
+            socket_descriptor, head, response.releaseBodyFile(),
+            response.getBodyFileOffset(), response.getContentLength());
+    else
+    {
+        std::vector<char> body;
+        response.releaseBody(body);
+        m_buffer_manager.pushSocketSegment(socket_descriptor, head);
+        m_buffer_manager.pushSocketSegment(socket_descriptor, body);
+    }
 
     // create an access log entry
-    m_logger.log(m_connection_manager.getConnection(socket_descriptor));
+    m_logger.log(connection);
 
     // return 0
     return (0);
@@ -474,14 +631,11 @@ void RequestHandler::removeConnection(int socket_descriptor)
     IConnection &connection =
         m_connection_manager.getConnection(socket_descriptor);
 
-    // Get a reference to the Request
-    IRequest &request = connection.getRequest();
+    // Make sure the connection is not kept alive anymore
+    connection.setKeepAlive(false);
 
-    // Remove the connection if the 'Connection' header is set to 'close'
-    if (request.getHeaderValue(CONNECTION) == "close")
-        m_connection_manager.removeConnection(socket_descriptor);
-    else // temp fix; close it anyway
-        m_connection_manager.removeConnection(socket_descriptor);
+    // Remove the connection
+    m_connection_manager.removeConnection(socket_descriptor);
 }
 
 // path: srcs/RequestHandler.cpp
@@ -12,21 +12,20 @@
  */
 
 // Constructor
-Session::Session(SessionId_t id, time_t timeout) : m_id(id), m_timeout(timeout)
+Session::Session(SessionId_t id, ITimerWheel &timer_wheel, time_t timeout)
+    : m_id(id), m_timer_wheel(timer_wheel), m_timeout(timeout),
+      m_timer(SESSION_TIMER, id)
 {
     this->touch();
 }
 
 // Destructor
-Session::~Session() {}
+Session::~Session() { m_timer_wheel.cancel(m_timer); }
 
-// Touch session updates last access time
-void Session::touch() { m_last_access = time(NULL); }
-
-// Check if session has expired
-bool Session::hasExpired() const
+// Touch session re-arms the idle timeout
+void Session::touch()
 {
-    return time(NULL) - m_last_access > m_timeout;
+    m_timer_wheel.schedule(m_timer, m_timeout * 1000UL);
 }
 
 // Set session data
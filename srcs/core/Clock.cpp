@@ -0,0 +1,74 @@
+#include "../../includes/core/Clock.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <sys/time.h>
+
+/*
+ * Clock.cpp
+ *
+ * Wall clock read once per turn of the event loop, see
+ * includes/core/Clock.hpp.
+ */
+
+// Constructor, reads the clock
+Clock::Clock() : m_time(0), m_microseconds(0) { this->update(); }
+
+// Destructor
+Clock::~Clock() {}
+
+// Read the wall clock, formatting the time again if a second went by
+void Clock::update()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    m_microseconds =
+        static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+    if (now.tv_sec == m_time)
+        return;
+    m_time = now.tv_sec;
+    this->m_format();
+}
+
+// Format the time of the last update
+void Clock::m_format()
+{
+    char buffer[ 64 ];
+    struct tm local_time;
+    localtime_r(&m_time, &local_time);
+
+    // Log timestamp
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local_time);
+    m_log_timestamp = buffer;
+
+    // ISO 8601, the UTC offset written as +hh:mm
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S%z", &local_time);
+    m_iso8601 = buffer;
+    if (m_iso8601.size() >= 2)
+        m_iso8601.insert(m_iso8601.size() - 2, ":");
+
+    // Common Log Format
+    strftime(buffer, sizeof(buffer), "%d/%b/%Y:%H:%M:%S %z", &local_time);
+    m_common_log = buffer;
+
+    // IMF-fixdate, always in English and in GMT
+    m_http_date = Converter::toHttpDate(m_time);
+}
+
+// Get the time of the last update
+time_t Clock::getTime() const { return m_time; }
+
+// Get the time of the last update in microseconds since the epoch
+uint64_t Clock::getMicroseconds() const { return m_microseconds; }
+
+// Get the local time of the last update, for the logs
+const std::string &Clock::getLogTimestamp() const { return m_log_timestamp; }
+
+// Get the local time of the last update, ISO 8601
+const std::string &Clock::getIso8601() const { return m_iso8601; }
+
+// Get the local time of the last update, Common Log Format
+const std::string &Clock::getCommonLogTimestamp() const { return m_common_log; }
+
+// Get the time of the last update as an IMF-fixdate
+const std::string &Clock::getHttpDate() const { return m_http_date; }
+
+// Path: srcs/core/Clock.cpp
@@ -0,0 +1,95 @@
+#include "../../includes/core/DescriptorTable.hpp"
+#include <stdexcept>
+#include <sys/resource.h>
+
+/*
+ * DescriptorTable.cpp
+ *
+ * Table of everything the worker knows about its open descriptors, indexed
+ * by the descriptor itself.
+ *
+ */
+
+// Entry of a descriptor nothing is known about
+static DescriptorEntry emptyEntry()
+{
+    DescriptorEntry entry;
+    entry.pollfd_index = -1;
+    entry.type = 0;
+    entry.buffer = NULL;
+    entry.connection = NULL;
+    entry.client_socket = -1;
+    return entry;
+}
+
+// Entry returned for descriptors outside the table
+const DescriptorEntry DescriptorTable::s_empty_entry = emptyEntry();
+
+// Constructor, with DESCRIPTOR_TABLE_DEFAULT_SIZE entries
+DescriptorTable::DescriptorTable()
+    : m_entries(DESCRIPTOR_TABLE_DEFAULT_SIZE, emptyEntry())
+{
+}
+
+// Destructor
+DescriptorTable::~DescriptorTable() {}
+
+// Set the descriptor limit of the process, 0 keeps the inherited one, and size
+// the table from the limit in effect
+// Returns false if the limit could not be set
+bool DescriptorTable::setLimit(size_t limit)
+{
+    bool success = true;
+    struct rlimit descriptor_limit;
+    if (getrlimit(RLIMIT_NOFILE, &descriptor_limit) == -1)
+        return false;
+
+    // Set the soft limit, within the hard limit
+    if (limit > 0)
+    {
+        if (descriptor_limit.rlim_max != RLIM_INFINITY &&
+            limit > descriptor_limit.rlim_max)
+        {
+            limit = descriptor_limit.rlim_max;
+            success = false;
+        }
+        descriptor_limit.rlim_cur = limit;
+        if (setrlimit(RLIMIT_NOFILE, &descriptor_limit) == -1)
+        {
+            getrlimit(RLIMIT_NOFILE, &descriptor_limit);
+            success = false;
+        }
+    }
+
+    // No descriptor can be above the limit
+    size_t size = DESCRIPTOR_TABLE_MAX_SIZE;
+    if (descriptor_limit.rlim_cur != RLIM_INFINITY &&
+        descriptor_limit.rlim_cur < DESCRIPTOR_TABLE_MAX_SIZE)
+        size = descriptor_limit.rlim_cur;
+    if (size > m_entries.size())
+        m_entries.resize(size, s_empty_entry);
+    return success;
+}
+
+// Get the entry of a descriptor, growing the table if needed
+DescriptorEntry &DescriptorTable::operator[](int descriptor)
+{
+    if (descriptor < 0)
+        throw std::out_of_range("Invalid descriptor");
+    if (static_cast<size_t>(descriptor) >= m_entries.size())
+        m_entries.resize(descriptor + 1, s_empty_entry);
+    return m_entries[ descriptor ];
+}
+
+// Get the entry of a descriptor, an empty entry if it is outside the table
+const DescriptorEntry &DescriptorTable::at(int descriptor) const
+{
+    if (descriptor < 0 || static_cast<size_t>(descriptor) >= m_entries.size())
+        return s_empty_entry;
+    return m_entries[ descriptor ];
+}
+
+// Get the number of entries
+size_t DescriptorTable::size() const { return m_entries.size(); }
+
+// Path: srcs/core/DescriptorTable.cpp
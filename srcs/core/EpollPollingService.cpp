@@ -0,0 +1,105 @@
+#include "../../includes/core/EpollPollingService.hpp"
+#include "../../includes/exception/WebservExceptions.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <cerrno>
+
+#ifdef __linux__
+
+EpollPollingService::EpollPollingService(EpollPollfdManager &pollfd_manager,
+                                         ILogger &logger, int timeout)
+    : m_pollfd_manager(pollfd_manager), m_logger(logger), m_timeout(timeout),
+      m_events(EPOLL_MAX_EVENTS)
+{
+}
+
+EpollPollingService::~EpollPollingService() {}
+
+short EpollPollingService::m_toPollEvents(uint32_t events)
+{
+    short poll_events = 0;
+
+    if (events & EPOLLIN)
+        poll_events |= POLLIN;
+    if (events & EPOLLOUT)
+        poll_events |= POLLOUT;
+    if (events & EPOLLERR)
+        poll_events |= POLLERR;
+    if (events & EPOLLHUP)
+        poll_events |= POLLHUP;
+    return poll_events;
+}
+
+void EpollPollingService::pollEvents()
+{
+    // Get the pollfd array
+    pollfd *pollfd_array = m_pollfd_manager.getPollfdArray();
+
+    // Reset the events reported in the previous cycle, epoll does not
+    // overwrite them like poll does
+    const std::vector<int> &ready_descriptors =
+        m_pollfd_manager.getReadyDescriptors();
+    for (size_t i = 0; i < ready_descriptors.size(); i++)
+    {
+        int index = m_pollfd_manager.getPollfdQueueIndex(ready_descriptors[ i ]);
+        if (index != -1)
+            pollfd_array[ index ].revents = 0;
+    }
+    m_pollfd_manager.clearReadyDescriptors();
+
+    // Regular files are always ready, don't block if some are waiting
+    const std::vector<int> &regular_files =
+        m_pollfd_manager.getRegularFileDescriptors();
+    int timeout = regular_files.empty() ? m_timeout : 0;
+
+    // Wait for events on the registered descriptors
+    int poll_result = epoll_wait(m_pollfd_manager.getEpollDescriptor(),
+                                 m_events.data(), m_events.size(), timeout);
+    if (poll_result < 0)
+    {
+        if (errno == EINTR)
+            LOG(m_logger, VERBOSE,
+                "[POLLINGSERVICE] Poll interrupted by signal");
+        throw PollError();
+    }
+
+    // Report the events of the ready descriptors
+    for (int i = 0; i < poll_result; i++)
+    {
+        int index = m_pollfd_manager.getPollfdQueueIndex(m_events[ i ].data.fd);
+        if (index == -1)
+            continue;
+        pollfd_array[ index ].revents = m_toPollEvents(m_events[ i ].events);
+        m_pollfd_manager.addReadyDescriptor(m_events[ i ].data.fd);
+    }
+
+    // Report the regular files as ready for their requested events
+    for (size_t i = 0; i < regular_files.size(); i++)
+    {
+        int index = m_pollfd_manager.getPollfdQueueIndex(regular_files[ i ]);
+        if (index == -1)
+            continue;
+        pollfd_array[ index ].revents =
+            pollfd_array[ index ].events & (POLLIN | POLLOUT);
+        m_pollfd_manager.addReadyDescriptor(regular_files[ i ]);
+    }
+
+    // Log poll result
+    if (ready_descriptors.empty()) // Timeout occurred
+        LOG(m_logger, EXHAUSTIVE,
+            "[POLLINGSERVICE] Poll returned after timeout (0 events)");
+    else // Events occurred
+        LOG(m_logger, VERBOSE,
+            "[POLLINGSERVICE] Poll returned " +
+                Converter::toString(
+                    static_cast<unsigned long>(ready_descriptors.size())) +
+                " events.");
+}
+
+void EpollPollingService::setPollingTimeout(int timeout)
+{
+    m_timeout = timeout;
+}
+
+#endif // __linux__
+
+// Path: srcs/core/EpollPollingService.cpp
@@ -1,35 +1,55 @@
 #include "../../includes/core/EventManager.hpp"
+#include "../../includes/connection/ConnectionManager.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
 #include "../../includes/utils/Converter.hpp"
+#include <csignal>
 #include <exception>
 #include <unistd.h>
 
 #define NO_EVENTS 0xC0
 #define FILE_TYPE_MASK 0xC0
 #define KEEP_DESCRIPTOR 0x01
+#define PIPELINED_REQUEST 0x01
 
 EventManager::EventManager(IPollfdManager &pollfd_manager,
                            IBufferManager &buffer_manager,
                            IConnectionManager &connection_manager,
                            IServer &server, IRequestHandler &request_handler,
-                           ILogger &logger)
+                           ITimerWheel &timer_wheel, ILogger &logger)
     : m_pollfd_manager(pollfd_manager), m_buffer_manager(buffer_manager),
       m_connection_manager(connection_manager), m_server(server),
-      m_request_handler(request_handler), m_logger(logger)
+      m_request_handler(request_handler), m_timer_wheel(timer_wheel),
+      m_logger(logger), m_garbage_collector_timer(GARBAGE_COLLECTOR_TIMER, 0)
 {
+    // Arm the first garbage collection
+    m_timer_wheel.schedule(m_garbage_collector_timer,
+                           GARBAGE_COLLECTOR_INTERVAL * 1000UL);
 }
 
-EventManager::~EventManager() {}
+EventManager::~EventManager()
+{
+    m_timer_wheel.cancel(m_garbage_collector_timer);
+}
 
 void EventManager::handleEvents()
 {
-    m_logger.log(EXHAUSTIVE, "[EVENTMANAGER] Handling events");
+    LOG(m_logger, EXHAUSTIVE, "[EVENTMANAGER] Handling events");
+
+    // Collect the timers that expired while polling
+    m_timer_wheel.advance();
 
-    for (ssize_t pollfd_index = 0;
-         pollfd_index <
-         static_cast<ssize_t>(m_pollfd_manager.getPollfdQueueSize());
-         pollfd_index++)
+    // Only visit the descriptors reported ready by the polling service
+    const std::vector<int> &ready_descriptors =
+        m_pollfd_manager.getReadyDescriptors();
+
+    for (size_t i = 0; i < ready_descriptors.size(); i++)
     {
+        // Skip descriptors removed while handling a previous event
+        ssize_t pollfd_index =
+            m_pollfd_manager.getPollfdQueueIndex(ready_descriptors[ i ]);
+        if (pollfd_index == -1)
+            continue;
+
         short events = m_pollfd_manager.getEvents(pollfd_index);
 
         if (events == NO_EVENTS)
@@ -53,61 +73,112 @@ void EventManager::handleEvents()
             m_handleRegularFileEvents(pollfd_index, events);
         }
     }
+
+    // Handle the timeouts left after the events
+    m_handleExpiredTimers();
+}
+
+void EventManager::m_handleExpiredTimers()
+{
+    // Only the expired timers are visited
+    Timer *timer;
+    while ((timer = m_timer_wheel.popExpired()) != NULL)
+    {
+        TimerType type = timer->getType();
+        size_t id = timer->getId();
+
+        if (type == CONNECTION_TIMER)
+        {
+            m_handleConnectionTimeout(id);
+        }
+        else if (type == CGI_TIMER)
+        {
+            m_handleCgiTimeout(id);
+        }
+        else if (type == SESSION_TIMER)
+        {
+            // Log the expired session
+            LOG(m_logger, VERBOSE, "Session expired. Session ID: " +
+                                   Converter::toString(id));
+
+            m_connection_manager.removeSession(id);
+        }
+        else if (type == GARBAGE_COLLECTOR_TIMER)
+        {
+            m_connection_manager.collectGarbage();
+
+            // Arm the next garbage collection
+            m_timer_wheel.schedule(m_garbage_collector_timer,
+                                   GARBAGE_COLLECTOR_INTERVAL * 1000UL);
+        }
+    }
+}
+
+void EventManager::m_handleConnectionTimeout(int client_socket)
+{
+    IConnection &connection = m_connection_manager.getConnection(client_socket);
+
+    // A connection waiting for its CGI process is timed out by the CGI timer
+    if (connection.getCgiPid() != -1)
+    {
+        connection.touch();
+        return;
+    }
+
+    // Log the expired connection
+    LOG(m_logger, VERBOSE, "Connection expired. Socket: " +
+                           Converter::toString(client_socket));
+
+    // Clear buffer, remove from polling and close socket
+    ssize_t pollfd_index = m_pollfd_manager.getPollfdQueueIndex(client_socket);
+    if (pollfd_index == -1)
+        m_request_handler.removeConnection(client_socket);
+    else
+        m_cleanUp(pollfd_index, client_socket);
+}
+
+void EventManager::m_handleCgiTimeout(int client_socket)
+{
+    IConnection &connection = m_connection_manager.getConnection(client_socket);
+    int cgi_pid = connection.getCgiPid();
+    int pipe_descriptor = connection.getCgiOutputPipeReadEnd();
+
+    // Kill the CGI process, it is reaped by the garbage collector
+    kill(cgi_pid, SIGKILL);
+
+    // Log the expired process
+    m_logger.log(ERROR, "Cgi Process expired and killed. PID: " +
+                            Converter::toString(cgi_pid));
+
+    // Let the request handler answer with an error response
+    m_request_handler.handlePipeException(pipe_descriptor);
+    connection.clearCgiInfo();
+
+    // Add the POLLOUT event for the client socket
+    ssize_t client_pollfd_index =
+        m_pollfd_manager.getPollfdQueueIndex(client_socket);
+    if (client_pollfd_index != -1)
+        m_pollfd_manager.addPollOut(client_pollfd_index);
+
+    // Clear buffer, remove from polling and close pipe
+    ssize_t pipe_pollfd_index =
+        m_pollfd_manager.getPollfdQueueIndex(pipe_descriptor);
+    if (pipe_pollfd_index == -1)
+        close(pipe_descriptor);
+    else
+        m_cleanUp(pipe_pollfd_index, pipe_descriptor);
 }
 
 void EventManager::m_handleRegularFileEvents(ssize_t &pollfd_index,
                                              short events)
 {
-    m_logger.log(EXHAUSTIVE, "[EVENTMANAGER] Handling regular file events");
+    LOG(m_logger, EXHAUSTIVE, "[EVENTMANAGER] Handling regular file events");
 
     // Check if file is ready for writing
     if (events & POLLOUT)
     {
-        // if the file is a body file for the CGI process
-        if (m_pollfd_manager.isBodyFile(pollfd_index))
-        {
-            // Get the body descriptor
-            int body_descriptor = m_pollfd_manager.getDescriptor(pollfd_index);
-
-            // Log the writing to the body file
-            m_logger.log(VERBOSE, "[EVENTMANAGER] Writing to body file '" +
-                                      Converter::toString(body_descriptor) +
-                                      "'");
-
-            // Write to the body file and check if done
-            if (!m_flushBuffer(pollfd_index, KEEP_DESCRIPTOR))
-            {
-                m_logger.log(ERROR,
-                             "[EVENTMANAGER] Finished writing to body file '" +
-                                 Converter::toString(body_descriptor) + "'");
-
-                // Let RequestHandler handle the CGI process
-                Triplet_t info = m_request_handler.executeCgi(body_descriptor);
-
-                // Get the info
-                int cgi_pid = info.first;
-                int cgi_output_pipe_read_end = info.second.first;
-
-                // Log the dynamic serving
-                m_logger.log(VERBOSE,
-                             "[EVENTMANAGER] GGI process launched with id " +
-                                 Converter::toString(cgi_pid) +
-                                 " (CGI output pipe Read end: " +
-                                 Converter::toString(cgi_output_pipe_read_end));
-
-                // Add the CGI output pipe Read end to the poll set
-                pollfd pollfd;
-                pollfd.fd = cgi_output_pipe_read_end;
-                pollfd.events = POLLIN;
-                pollfd.revents = 0;
-                m_pollfd_manager.addPipePollfd(pollfd);
-            }
-        }
-        else
-        {
-            // simply flush the buffer
-            m_flushBuffer(pollfd_index, KEEP_DESCRIPTOR);
-        }
+        // simply flush the buffer
+        m_flushBuffer(pollfd_index, KEEP_DESCRIPTOR);
     }
 
     // Check for error on the file
@@ -128,7 +199,7 @@ void EventManager::m_handleRegularFileEvents(ssize_t &pollfd_index,
 void EventManager::m_handleServerSocketEvents(ssize_t pollfd_index,
                                               short events)
 {
-    m_logger.log(EXHAUSTIVE, "[EVENTMANAGER] Handling server socket events");
+    LOG(m_logger, EXHAUSTIVE, "[EVENTMANAGER] Handling server socket events");
     // Check for errors on server socket
     if (events & POLLERR)
         throw ServerSocketError();
@@ -154,74 +225,67 @@ void EventManager::m_handleServerSocketEvents(ssize_t pollfd_index,
 void EventManager::m_handleClientSocketEvents(ssize_t &pollfd_index,
                                               short events)
 {
-    m_logger.log(EXHAUSTIVE, "[EVENTMANAGER] Handling client socket events");
+    LOG(m_logger, EXHAUSTIVE, "[EVENTMANAGER] Handling client socket events");
     // Check for exceptions
     if (events & (POLLHUP | POLLERR | POLLNVAL))
     {
         m_handleClientException(pollfd_index, events);
     }
 
-    // Read and process a new request if ready
-    else if (events & POLLIN)
+    // Send the pending response before reading more, the reading being
+    // resumed once it is sent
+    else if (events & POLLOUT)
     {
-        m_handleRequest(pollfd_index);
+        m_flushBuffer(pollfd_index);
     }
 
-    // Send response
-    else if (events & POLLOUT)
+    // Read and process a new request if ready
+    else if (events & POLLIN)
     {
-        m_flushBuffer(pollfd_index);
+        m_handleRequest(pollfd_index);
     }
 }
 
-void EventManager::m_handleRequest(ssize_t &pollfd_index)
+void EventManager::m_handleRequest(ssize_t &pollfd_index, short options)
 {
     int client_socket_descriptor = m_pollfd_manager.getDescriptor(pollfd_index);
 
-    Triplet_t info = m_request_handler.handleRequest(client_socket_descriptor);
+    // Pipelined requests are already buffered, the socket is not read
+    Triplet_t info =
+        options == PIPELINED_REQUEST
+            ? m_request_handler.processRequest(client_socket_descriptor)
+            : m_request_handler.handleRequest(client_socket_descriptor);
 
     if (info.first == -1) // served static files or bad request
     {
         // Log the static serving
-        m_logger.log(VERBOSE,
-                     "[EVENTMANAGER] Statically served client socket: " +
-                         Converter::toString(client_socket_descriptor));
+        LOG(m_logger, VERBOSE,
+            "[EVENTMANAGER] Statically served client socket: " +
+                Converter::toString(client_socket_descriptor));
 
         // Add the POLLOUT event for the socket
         m_pollfd_manager.addPollOut(pollfd_index);
     }
     else if (info.first == -2) // chunked data...
     {
-        m_logger.log(
-            VERBOSE,
+        LOG(m_logger, VERBOSE,
             "[EVENTMANAGER] Incomplete request received for client socket: " +
                 Converter::toString(client_socket_descriptor));
     }
+    else if (info.first == -5) // Previous response still pending
+    {
+        // Stop polling the socket for reading until the response is sent
+        m_pollfd_manager.removePollIn(pollfd_index);
+    }
     else if (info.first == -3) // Client closed the connection
     {
         // Log the client disconnection
-        m_logger.log(VERBOSE,
-                     "Client disconnected socket: " +
-                         Converter::toString(client_socket_descriptor));
+        LOG(m_logger, VERBOSE, "Client disconnected socket: " +
+                               Converter::toString(client_socket_descriptor));
 
         // Clear buffer, remove from polling and close socket
         m_cleanUp(pollfd_index, client_socket_descriptor);
     }
-    else if (info.first == -4) // Add the  body file for the CGI process to poll
-    {
-        int body_file_descriptor =
-            info.second.first; // the file descriptor of the body file
-
-        // Log the situation
-        m_logger.log(VERBOSE, "[EVENTMANAGER] Adding body file descriptor '" +
-                                  Converter::toString(body_file_descriptor) +
-                                  "' to poll");
-        pollfd pollfd;
-        pollfd.fd = body_file_descriptor;
-        pollfd.events = POLLOUT;
-        pollfd.revents = 0;
-        m_pollfd_manager.addBodyFilePollfd(pollfd);
-    }
     else // read pipe returned
     {
         // Get the info
@@ -229,13 +293,12 @@ void EventManager::m_handleRequest(ssize_t &pollfd_index)
         int cgi_output_pipe_read_end = info.second.first;
 
         // Log the dynamic serving
-        m_logger.log(VERBOSE,
-                     "[EVENTMANAGER] Dynamically serving client socket: " +
-                         Converter::toString(client_socket_descriptor) +
-                         " waiting for process " +
-                         Converter::toString(cgi_pid) +
-                         " (CGI output pipe Read end: " +
-                         Converter::toString(cgi_output_pipe_read_end));
+        LOG(m_logger, VERBOSE,
+            "[EVENTMANAGER] Dynamically serving client socket: " +
+                Converter::toString(client_socket_descriptor) +
+                " waiting for process " + Converter::toString(cgi_pid) +
+                " (CGI output pipe Read end: " +
+                Converter::toString(cgi_output_pipe_read_end));
 
         // Add the CGI output pipe Read end to the poll set
         pollfd pollfd;
@@ -274,19 +337,26 @@ ssize_t EventManager::m_flushBuffer(ssize_t &pollfd_index, short options)
     else if (return_value == 0) // check if all bytes were sent
     {
         // Log the flush
-        m_logger.log(VERBOSE, "Flushed buffer for descriptor: " +
-                                  Converter::toString(descriptor));
-
-        // Clear buffer, remove from polling and close socket
-        m_cleanUp(pollfd_index, descriptor, options);
+        LOG(m_logger, VERBOSE, "Flushed buffer for descriptor: " +
+                               Converter::toString(descriptor));
+
+        // Keep a client connection open for its next request if possible,
+        // otherwise clear buffer, remove from polling and close socket
+        short file_type =
+            m_pollfd_manager.getEvents(pollfd_index) & FILE_TYPE_MASK;
+        if (file_type == CLIENT_SOCKET &&
+            m_request_handler.keepAlive(descriptor))
+            m_keepAlive(pollfd_index, descriptor);
+        else
+            m_cleanUp(pollfd_index, descriptor, options);
     }
     else
     {
         // Log the flush
-        m_logger.log(VERBOSE, "Partially Flushed buffer for descriptor: " +
-                                  Converter::toString(descriptor) + " with " +
-                                  Converter::toString(return_value) +
-                                  " bytes remaining");
+        LOG(m_logger, VERBOSE, "Partially Flushed buffer for descriptor: " +
+                               Converter::toString(descriptor) + " with " +
+                               Converter::toString(return_value) +
+                               " bytes remaining");
     }
     return return_value;
 }
@@ -304,6 +374,9 @@ void EventManager::m_handleClientException(ssize_t &pollfd_index, short events)
 
         // Clear buffer, remove from polling and close socket
         m_cleanUp(pollfd_index, descriptor);
+
+        // The connection is gone, there is no one left to answer
+        return;
     }
 
     // Check for invalid request on the socket
@@ -350,32 +423,46 @@ void EventManager::m_handleClientException(ssize_t &pollfd_index, short events)
     }
 }
 
+void EventManager::m_keepAlive(ssize_t &pollfd_index, int descriptor)
+{
+    // Destroy the buffer of the sent response
+    m_buffer_manager.destroyBuffer(descriptor);
+
+    // Wait for the next request, the data received meanwhile being reported
+    // again
+    m_pollfd_manager.removePollOut(pollfd_index);
+    m_pollfd_manager.addPollIn(pollfd_index);
+
+    // Serve the requests pipelined behind the sent one, if any
+    m_handleRequest(pollfd_index, PIPELINED_REQUEST);
+}
+
 void EventManager::m_cleanUp(ssize_t &pollfd_index, int descriptor,
                              short options)
 {
     // Destroy the buffer associated with the descriptor
     m_buffer_manager.destroyBuffer(descriptor);
 
+    // Get the descriptor type before it leaves the poll set
+    short file_type = m_pollfd_manager.getEvents(pollfd_index) & FILE_TYPE_MASK;
+
+    // Remove the descriptor from the poll set before closing it, so the
+    // polling backend can unregister it while it is still valid
+    m_pollfd_manager.removePollfd(pollfd_index);
+
     // Close the descriptor
     if (options != KEEP_DESCRIPTOR)
     {
         // if it is a client socket, let request handler handle the cleanup
-        if ((m_pollfd_manager.getEvents(pollfd_index) & FILE_TYPE_MASK) ==
-            CLIENT_SOCKET)
+        if (file_type == CLIENT_SOCKET)
             m_request_handler.removeConnection(descriptor);
         else
             close(descriptor);
     }
 
-    // Remove the descriptor from the poll set
-    m_pollfd_manager.removePollfd(pollfd_index);
-
-    // Decrement i to compensate for the removal
-    pollfd_index--;
-
     // Log the cleanup
-    m_logger.log(VERBOSE,
-                 "Cleaned up descriptor: " + Converter::toString(descriptor));
+    LOG(m_logger, VERBOSE, "Cleaned up descriptor: " +
+                           Converter::toString(descriptor));
 }
 
 void EventManager::m_handlePipeEvents(ssize_t &pollfd_index, short events)
@@ -386,46 +473,13 @@ void EventManager::m_handlePipeEvents(ssize_t &pollfd_index, short events)
     // Declare the client socket descriptor linked to the pipe
     int client_socket;
 
-    // Check for exceptions
-    if (events & (POLLHUP | POLLERR | POLLNVAL))
-    {
-        // Set the error description
-        std::string error_description;
-        if (events & POLLHUP)
-            error_description = "Pipe POLLHUP - pipe is no longer connected";
-        else if (events & POLLERR)
-            error_description = "Pipe POLLERR - asynchronous error";
-        else if (events & POLLNVAL)
-            error_description = "Pipe POLLNVAL - file descriptor is not open";
-
-        // Log the error
-        m_logger.log(ERROR, error_description + " | pipe fd: " +
-                                Converter::toString(pipe_descriptor));
-
-        // Let the request handler handle the exception, returns the client
-        // socket descriptor linked to the pipe
-        client_socket = m_request_handler.handlePipeException(pipe_descriptor);
-
-        // Add the POLLOUT event for the client socket since the error response
-        // is ready
-        ssize_t client_pollfd_index =
-            m_pollfd_manager.getPollfdQueueIndex(client_socket);
-        if (client_pollfd_index == -1)
-            m_logger.log(ERROR,
-                         "[EVENTMANAGER] Client socket not found in poll set");
-        else
-            m_pollfd_manager.addPollOut(client_pollfd_index);
-
-        // Clear buffer, remove from polling and close pipe
-        m_cleanUp(pollfd_index, pipe_descriptor);
-    }
-
-    // Read the response from the Response pipe if ready
-    else if (events & POLLIN)
+    // Read the response from the Response pipe if ready. POLLHUP means the CGI
+    // process closed its end: read what is left up to the end of file
+    if (events & (POLLIN | POLLHUP))
     {
         // Log the pipe read
-        m_logger.log(VERBOSE, "Pipe read event on pipe: " +
-                                  Converter::toString(pipe_descriptor));
+        LOG(m_logger, VERBOSE, "Pipe read event on pipe: " +
+                               Converter::toString(pipe_descriptor));
 
         // Let the request handler handle the pipe read, returns the client
         // socket descriptor linked to the pipe
@@ -435,8 +489,7 @@ void EventManager::m_handlePipeEvents(ssize_t &pollfd_index, short events)
         if (client_socket ==
             -1) // -1 indicates that the pipe blocked at some point
         {
-            m_logger.log(
-                VERBOSE,
+            LOG(m_logger, VERBOSE,
                 "Pipe read buffered, waiting for unblocking on pipe: " +
                     Converter::toString(pipe_descriptor));
 
@@ -458,12 +511,44 @@ void EventManager::m_handlePipeEvents(ssize_t &pollfd_index, short events)
         m_cleanUp(pollfd_index, pipe_descriptor);
     }
 
+    // Check for exceptions
+    else if (events & (POLLERR | POLLNVAL))
+    {
+        // Set the error description
+        std::string error_description;
+        if (events & POLLERR)
+            error_description = "Pipe POLLERR - asynchronous error";
+        else if (events & POLLNVAL)
+            error_description = "Pipe POLLNVAL - file descriptor is not open";
+
+        // Log the error
+        m_logger.log(ERROR, error_description + " | pipe fd: " +
+                                Converter::toString(pipe_descriptor));
+
+        // Let the request handler handle the exception, returns the client
+        // socket descriptor linked to the pipe
+        client_socket = m_request_handler.handlePipeException(pipe_descriptor);
+
+        // Add the POLLOUT event for the client socket since the error response
+        // is ready
+        ssize_t client_pollfd_index =
+            m_pollfd_manager.getPollfdQueueIndex(client_socket);
+        if (client_pollfd_index == -1)
+            m_logger.log(ERROR,
+                         "[EVENTMANAGER] Client socket not found in poll set");
+        else
+            m_pollfd_manager.addPollOut(client_pollfd_index);
+
+        // Clear buffer, remove from polling and close pipe
+        m_cleanUp(pollfd_index, pipe_descriptor);
+    }
+
     // Write the request body to the Request pipe to the cgi process if ready
     else if (events & POLLOUT)
     {
         // Log the pipe write
-        m_logger.log(VERBOSE, "Pipe write event on pipe: " +
-                                  Converter::toString(pipe_descriptor));
+        LOG(m_logger, VERBOSE, "Pipe write event on pipe: " +
+                               Converter::toString(pipe_descriptor));
 
         // Flush the buffer
         m_flushBuffer(pollfd_index);
@@ -0,0 +1,153 @@
+#include "../../includes/core/MasterProcess.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <cerrno>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+MasterProcess::MasterProcess(IConfiguration &configuration,
+                             IBufferManager &buffer_manager, ILogger &logger,
+                             SignalHandler &signal_handler)
+    : m_exit_status(0), m_buffer_manager(buffer_manager), m_logger(logger),
+      m_signal_handler(signal_handler)
+{
+    // Get the number of worker processes, one per online CPU if 'auto'
+    const std::string &worker_processes =
+        configuration.getString("worker_processes");
+    if (worker_processes == "auto")
+        m_worker_processes = sysconf(_SC_NPROCESSORS_ONLN);
+    else
+        m_worker_processes = configuration.getInt("worker_processes");
+    if (m_worker_processes < 1)
+        m_worker_processes = 1;
+
+    m_workers.resize(m_worker_processes, -1);
+}
+
+MasterProcess::~MasterProcess() {}
+
+bool MasterProcess::run()
+{
+    // Single process mode, the core cycle runs in the current process
+    if (m_worker_processes == 1)
+        return true;
+
+    LOG(m_logger, INFO, "Starting " + Converter::toString(m_worker_processes) +
+                        " worker processes.");
+
+    // Fork the workers, they take over the startup log messages
+    for (size_t slot = 0; slot < m_workers.size(); slot++)
+    {
+        if (m_spawnWorker(slot))
+            return true;
+    }
+    m_dropLogBacklog();
+
+    // Supervise the workers until all of them exited
+    size_t running_workers = m_workers.size();
+    bool stopping = false;
+    while (running_workers > 0)
+    {
+        // Wait for a worker to exit, interrupted by signals
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+
+        // Stop the workers on SIGINT
+        if (!stopping && m_signal_handler.sigintReceived())
+        {
+            LOG(m_logger, INFO,
+                "Master process received SIGINT, stopping " "workers.");
+            m_stopWorkers();
+            stopping = true;
+        }
+
+        if (pid == -1)
+        {
+            if (errno == ECHILD)
+                break;
+            continue;
+        }
+
+        // Find the slot of the worker
+        size_t slot = 0;
+        while (slot < m_workers.size() && m_workers[ slot ] != pid)
+            slot++;
+        if (slot == m_workers.size())
+            continue;
+        m_workers[ slot ] = -1;
+        running_workers--;
+
+        // Don't respawn while stopping
+        if (stopping)
+            continue;
+
+        // A worker failing to set up would fail again, stop the others
+        if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_SETUP_FAILURE)
+        {
+            m_logger.log(CRITICAL, "Worker process " +
+                                       Converter::toString(pid) +
+                                       " failed to start, stopping workers.");
+            m_exit_status = WORKER_SETUP_FAILURE;
+            m_stopWorkers();
+            stopping = true;
+            continue;
+        }
+
+        // Respawn the worker
+        m_logger.log(ERROR,
+                     "Worker process " + Converter::toString(pid) +
+                         (WIFSIGNALED(status)
+                              ? " killed by signal " +
+                                    Converter::toString(WTERMSIG(status))
+                              : " exited with status " +
+                                    Converter::toString(WEXITSTATUS(status))) +
+                         ", respawning.");
+        if (m_spawnWorker(slot))
+            return true;
+        running_workers++;
+        m_dropLogBacklog();
+    }
+
+    LOG(m_logger, INFO, "All worker processes exited.");
+    m_dropLogBacklog();
+    return false;
+}
+
+int MasterProcess::getExitStatus() const { return m_exit_status; }
+
+bool MasterProcess::m_spawnWorker(size_t slot)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        m_logger.log(ERROR, "Failed to fork worker process.");
+        return false;
+    }
+
+    // Worker process
+    if (pid == 0)
+        return true;
+
+    // Master process
+    m_workers[ slot ] = pid;
+    LOG(m_logger, VERBOSE, "Worker process " + Converter::toString(pid) +
+                           " started.");
+    return false;
+}
+
+void MasterProcess::m_stopWorkers()
+{
+    for (size_t slot = 0; slot < m_workers.size(); slot++)
+    {
+        if (m_workers[ slot ] != -1)
+            kill(m_workers[ slot ], SIGINT);
+    }
+}
+
+void MasterProcess::m_dropLogBacklog()
+{
+    // The master opens no log file, its messages only go to stderr
+    m_buffer_manager.destroyBuffer(STDERR_FILENO);
+}
+
+// Path: srcs/core/MasterProcess.cpp
@@ -24,19 +24,30 @@ void PollingService::pollEvents()
     if (poll_result < 0)
     {
         if (errno == EINTR)
-            m_logger.log(VERBOSE,
-                         "[POLLINGSERVICE] Poll interrupted by signal");
+            LOG(m_logger, VERBOSE,
+                "[POLLINGSERVICE] Poll interrupted by signal");
         throw PollError();
     }
 
+    // Collect the descriptors with pending events, stopping once all of them
+    // have been found
+    m_pollfd_manager.clearReadyDescriptors();
+    for (size_t i = 0; i < pollfd_queue_size && poll_result > 0 &&
+                       m_pollfd_manager.getReadyDescriptors().size() <
+                           static_cast<size_t>(poll_result);
+         i++)
+    {
+        if (pollfd_array[ i ].revents != 0)
+            m_pollfd_manager.addReadyDescriptor(pollfd_array[ i ].fd);
+    }
+
     // Log poll result
     if (poll_result == 0) // Timeout occurred
-        m_logger.log(EXHAUSTIVE,
-                     "[POLLINGSERVICE] Poll returned after timeout (0 events)");
+        LOG(m_logger, EXHAUSTIVE,
+            "[POLLINGSERVICE] Poll returned after timeout (0 events)");
     else // Events occurred
-        m_logger.log(VERBOSE, "[POLLINGSERVICE] Poll returned " +
-                                  Converter::toString(poll_result) +
-                                  " events.");
+        LOG(m_logger, VERBOSE, "[POLLINGSERVICE] Poll returned " +
+                               Converter::toString(poll_result) + " events.");
 }
 
 void PollingService::setPollingTimeout(int timeout) { m_timeout = timeout; }
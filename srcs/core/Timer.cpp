@@ -0,0 +1,21 @@
+#include "../../includes/core/Timer.hpp"
+
+/*
+ * Timer.cpp
+ *
+ * Node of the TimerWheel, see includes/core/Timer.hpp.
+ */
+
+Timer::Timer(TimerType type, size_t id)
+    : m_previous(NULL), m_next(NULL), m_slot(NULL), m_expires(0), m_type(type),
+      m_id(id)
+{
+}
+
+TimerType Timer::getType() const { return m_type; }
+
+size_t Timer::getId() const { return m_id; }
+
+bool Timer::isArmed() const { return m_slot != NULL; }
+
+// Path: srcs/core/Timer.cpp
@@ -0,0 +1,185 @@
+#include "../../includes/core/TimerWheel.hpp"
+#include <ctime>
+
+/*
+ * TimerWheel.cpp
+ *
+ * Hierarchical timing wheel, see includes/core/TimerWheel.hpp.
+ */
+
+TimerWheel::TimerWheel() : m_expired(NULL), m_armed_timers(0)
+{
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for (int index = 0; index < TIMER_WHEEL_SLOTS; index++)
+            m_slots[ level ][ index ] = NULL;
+    }
+    m_now = m_readClock();
+    m_current_tick = m_now / TIMER_WHEEL_TICK;
+}
+
+TimerWheel::~TimerWheel() {}
+
+// Read the monotonic clock in milliseconds
+unsigned long TimerWheel::m_readClock()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000UL + now.tv_nsec / 1000000UL;
+}
+
+// Link a timer at the head of a list
+void TimerWheel::m_link(Timer &timer, Timer **slot)
+{
+    timer.m_slot = slot;
+    timer.m_previous = NULL;
+    timer.m_next = *slot;
+    if (*slot)
+        (*slot)->m_previous = &timer;
+    *slot = &timer;
+}
+
+// Unlink a timer from its list
+void TimerWheel::m_unlink(Timer &timer)
+{
+    if (timer.m_previous)
+        timer.m_previous->m_next = timer.m_next;
+    else
+        *timer.m_slot = timer.m_next;
+    if (timer.m_next)
+        timer.m_next->m_previous = timer.m_previous;
+    timer.m_slot = NULL;
+    timer.m_previous = NULL;
+    timer.m_next = NULL;
+}
+
+// Link a timer in the slot matching its expiry tick, at the lowest level
+// whose span covers the remaining ticks
+void TimerWheel::m_insert(Timer &timer)
+{
+    unsigned long expires = timer.m_expires;
+    unsigned long delta = expires - m_current_tick;
+
+    // Timers beyond the span of the wheel wait in its farthest slot, and are
+    // placed again when cascaded
+    unsigned long span = 1UL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS);
+    if (delta >= span)
+    {
+        delta = span - 1;
+        expires = m_current_tick + delta;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= 1UL << ((level + 1) * TIMER_WHEEL_SLOT_BITS))
+        level++;
+
+    unsigned long index =
+        (expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+    m_link(timer, &m_slots[ level ][ index ]);
+}
+
+// Move the timers of a slot of the given level to the levels below
+void TimerWheel::m_cascade(int level, unsigned long index)
+{
+    Timer *timer = m_slots[ level ][ index ];
+    m_slots[ level ][ index ] = NULL;
+
+    while (timer)
+    {
+        Timer *next = timer->m_next;
+        m_insert(*timer);
+        timer = next;
+    }
+}
+
+// Arm or re-arm a timer to expire in the given number of milliseconds
+void TimerWheel::schedule(Timer &timer, unsigned long timeout)
+{
+    if (timer.isArmed())
+        this->cancel(timer);
+
+    // Expire on the first tick after the timeout, at least one tick ahead
+    unsigned long ticks = (timeout + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK;
+    timer.m_expires = m_current_tick + (ticks ? ticks : 1);
+    m_insert(timer);
+    m_armed_timers++;
+}
+
+// Disarm a timer
+void TimerWheel::cancel(Timer &timer)
+{
+    if (!timer.isArmed())
+        return;
+    m_unlink(timer);
+    m_armed_timers--;
+}
+
+// Read the clock and move the timers of the ticks passed to the expired list
+void TimerWheel::advance()
+{
+    m_now = m_readClock();
+    unsigned long now_tick = m_now / TIMER_WHEEL_TICK;
+
+    while (m_current_tick < now_tick)
+    {
+        m_current_tick++;
+
+        // When a level wraps around, cascade the next slot of the level above
+        unsigned long index = m_current_tick & TIMER_WHEEL_SLOT_MASK;
+        for (int level = 1; index == 0 && level < TIMER_WHEEL_LEVELS; level++)
+        {
+            index = (m_current_tick >> (level * TIMER_WHEEL_SLOT_BITS)) &
+                    TIMER_WHEEL_SLOT_MASK;
+            m_cascade(level, index);
+        }
+
+        // Move the timers of the current tick to the expired list
+        Timer *&slot = m_slots[ 0 ][ m_current_tick & TIMER_WHEEL_SLOT_MASK ];
+        while (slot)
+        {
+            Timer *timer = slot;
+            m_unlink(*timer);
+            m_link(*timer, &m_expired);
+        }
+    }
+}
+
+// Pop an expired timer, NULL when none are left
+Timer *TimerWheel::popExpired()
+{
+    Timer *timer = m_expired;
+    if (timer)
+    {
+        m_unlink(*timer);
+        m_armed_timers--;
+    }
+    return timer;
+}
+
+// Get the milliseconds until the next timer may expire, at most max_timeout.
+// Only level 0 is looked at: past it, the next level wrap is a lower bound.
+int TimerWheel::getNextTimeout(int max_timeout) const
+{
+    if (m_expired)
+        return 0;
+    if (m_armed_timers == 0)
+        return max_timeout;
+
+    // Find the next non-empty slot of level 0, or the next wrap
+    unsigned long ticks = 1;
+    while (ticks < TIMER_WHEEL_SLOTS &&
+           m_slots[ 0 ][ (m_current_tick + ticks) & TIMER_WHEEL_SLOT_MASK ] ==
+               NULL &&
+           ((m_current_tick + ticks) & TIMER_WHEEL_SLOT_MASK) != 0)
+        ticks++;
+
+    // Convert to milliseconds from the clock at the last advance
+    unsigned long deadline = (m_current_tick + ticks) * TIMER_WHEEL_TICK;
+    unsigned long timeout = deadline > m_now ? deadline - m_now : 0;
+    return timeout < static_cast<unsigned long>(max_timeout)
+               ? static_cast<int>(timeout)
+               : max_timeout;
+}
+
+// Path: srcs/core/TimerWheel.cpp
@@ -33,7 +33,7 @@ ExceptionHandler::ExceptionHandler(ILogger &logger)
 {
     // Log debug message indicating the creation of an ExceptionHandler
     // instance.
-    m_logger.log(VERBOSE, "ExceptionHandler created.");
+    LOG(m_logger, VERBOSE, "ExceptionHandler created.");
 }
 
 // Constructor: Initializes ExceptionHandler with an logger instance and a
@@ -43,7 +43,7 @@ ExceptionHandler::ExceptionHandler(ILogger &logger, Server *server)
 {
     // Log debug message indicating the creation of an ExceptionHandler
     // instance.
-    m_logger.log(VERBOSE, "ExceptionHandler created.");
+    LOG(m_logger, VERBOSE, "ExceptionHandler created.");
 }
 
 // Destructor: No dynamic memory management, so a default destructor is
@@ -52,7 +52,7 @@ ExceptionHandler::~ExceptionHandler()
 {
     // Log debug message indicating the destruction of an ExceptionHandler
     // instance.
-    m_logger.log(VERBOSE, "ExceptionHandler destroyed.");
+    LOG(m_logger, VERBOSE, "ExceptionHandler destroyed.");
 }
 
 // m_handleWebservException method: Logs exception details and handles critical
@@ -3,35 +3,163 @@
 #include "../../includes/connection/Session.hpp"
 #include "../../includes/request/Request.hpp"
 #include "../../includes/response/Response.hpp"
+#include "../../includes/utils/AllocationCounter.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <new>
 
-Factory::Factory(const IConfiguration &configuration, ILogger &logger)
+Factory::Factory(const IConfiguration &configuration, ILogger &logger,
+                 ITimerWheel &timer_wheel, const IClock &clock)
     : m_configuration(configuration), m_logger(logger),
-      m_http_helper(configuration)
+      m_timer_wheel(timer_wheel), m_clock(clock), m_http_helper(configuration),
+      m_keepalive_timeout(configuration.getSize_t("keepalive_timeout")),
+      m_keepalive_requests(configuration.getSize_t("keepalive_requests")),
+      m_pool_misses(0), m_requests_created(0),
+      m_allocations(AllocationCounter::count())
 {
     // Log the creation of the Factory
-    m_logger.log(VERBOSE, "Factory created.");
+    LOG(m_logger, VERBOSE, "Factory created.");
 }
 
 Factory::~Factory()
 {
+    // Free the pooled objects
+    for (size_t i = 0; i < m_free_connections.size(); i++)
+        ::operator delete(m_free_connections[ i ]);
+    for (size_t i = 0; i < m_free_requests.size(); i++)
+        delete m_free_requests[ i ];
+    for (size_t i = 0; i < m_free_responses.size(); i++)
+        delete m_free_responses[ i ];
+
+    // Log the allocations per request, counted since the factory was
+    // created, and how often the pools were empty
+    if (m_requests_created > 0)
+    {
+        std::string statistics =
+            "Factory: " + Converter::toString(m_requests_created) +
+            " requests, ";
+        if (AllocationCounter::enabled())
+            statistics +=
+                Converter::toString(static_cast<double>(
+                                        AllocationCounter::count() -
+                                        m_allocations) /
+                                    m_requests_created) +
+                " allocations per request, ";
+        statistics += Converter::toString(m_pool_misses) + " pool misses";
+        LOG(m_logger, INFO, statistics);
+    }
+
     // Log the destruction of the Factory
-    m_logger.log(VERBOSE, "Factory destroyed.");
+    LOG(m_logger, VERBOSE, "Factory destroyed.");
 }
 
 IConnection *Factory::createConnection(
     std::pair<int, std::pair<std::string, std::string> > clientInfo)
 {
-    return new Connection(clientInfo, m_logger, this->createRequest(),
-                          this->createResponse());
+    // Take a free block, or allocate one
+    void *block;
+    if (!m_free_connections.empty())
+    {
+        block = m_free_connections.back();
+        m_free_connections.pop_back();
+    }
+    else
+    {
+        block = ::operator new(sizeof(Connection));
+        m_pool_misses++;
+    }
+
+    // Construct the connection in the block
+    IRequest *request = this->createRequest();
+    IResponse *response = this->createResponse();
+    return new (block)
+        Connection(clientInfo, m_logger, request, response, m_timer_wheel,
+                   m_keepalive_timeout, m_keepalive_requests);
 }
 
 IRequest *Factory::createRequest()
 {
-    return new Request(m_configuration, m_http_helper);
+    m_requests_created++;
+
+    // Reuse a request reset when it was released
+    if (!m_free_requests.empty())
+    {
+        Request *request = m_free_requests.back();
+        m_free_requests.pop_back();
+        return request;
+    }
+    m_pool_misses++;
+    return new Request(m_configuration, m_http_helper, m_clock);
 }
 
-IResponse *Factory::createResponse() { return new Response(m_http_helper); }
+IResponse *Factory::createResponse()
+{
+    // Reuse a response reset when it was released
+    if (!m_free_responses.empty())
+    {
+        Response *response = m_free_responses.back();
+        m_free_responses.pop_back();
+        return response;
+    }
+    m_pool_misses++;
+    return new Response(m_http_helper, m_clock);
+}
+
+ISession *Factory::createSession(SessionId_t id)
+{
+    return new Session(id, m_timer_wheel);
+}
+
+// Destroy a connection, keeping its block, request and response for reuse
+void Factory::releaseConnection(IConnection *connection)
+{
+    if (connection == NULL)
+        return;
 
-ISession *Factory::createSession(SessionId_t id) { return new Session(id); }
+    // The connection does not own its request and response
+    this->releaseRequest(&connection->getRequest());
+    this->releaseResponse(&connection->getResponse());
+
+    // Destroy the connection, keeping its block
+    Connection *block = static_cast<Connection *>(connection);
+    block->~Connection();
+    if (m_free_connections.size() < FACTORY_POOL_MAX_SIZE)
+        m_free_connections.push_back(block);
+    else
+        ::operator delete(block);
+}
+
+// Reset a request and keep it for reuse
+void Factory::releaseRequest(IRequest *request)
+{
+    if (request == NULL)
+        return;
+
+    // Reset now, so that its files are removed right away
+    Request *pooled = static_cast<Request *>(request);
+    if (m_free_requests.size() >= FACTORY_POOL_MAX_SIZE)
+    {
+        delete pooled;
+        return;
+    }
+    pooled->reset();
+    m_free_requests.push_back(pooled);
+}
+
+// Reset a response and keep it for reuse
+void Factory::releaseResponse(IResponse *response)
+{
+    if (response == NULL)
+        return;
+
+    // Reset now, so that its body file is closed right away
+    Response *pooled = static_cast<Response *>(response);
+    if (m_free_responses.size() >= FACTORY_POOL_MAX_SIZE)
+    {
+        delete pooled;
+        return;
+    }
+    pooled->reset();
+    m_free_responses.push_back(pooled);
+}
 
 // Path: srcs/Factory.cpp
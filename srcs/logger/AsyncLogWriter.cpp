@@ -0,0 +1,216 @@
+#include "../../includes/logger/AsyncLogWriter.hpp"
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+ * AsyncLogWriter.cpp
+ *
+ * Writes log records to their files from a dedicated thread, the records
+ * being handed over through a lock-free single producer ring.
+ *
+ */
+
+// Constructor, the thread is not started
+AsyncLogWriter::AsyncLogWriter()
+    : m_head(0), m_tail(0), m_sleeping(0), m_stopping(0), m_running(false)
+{
+    m_wakeup_pipe[ 0 ] = -1;
+    m_wakeup_pipe[ 1 ] = -1;
+}
+
+// Destructor, stops the thread
+AsyncLogWriter::~AsyncLogWriter() { this->stop(); }
+
+// Start the thread, if not started yet
+// Returns false if it could not be started
+bool AsyncLogWriter::start()
+{
+    if (m_running)
+        return true;
+
+    // Create the pipe the writer sleeps on, the producer never blocks on it
+    if (pipe(m_wakeup_pipe) == -1)
+        return false;
+    fcntl(m_wakeup_pipe[ 0 ], F_SETFD, FD_CLOEXEC);
+    fcntl(m_wakeup_pipe[ 1 ], F_SETFD, FD_CLOEXEC);
+    fcntl(m_wakeup_pipe[ 1 ], F_SETFL, O_NONBLOCK);
+
+    // Start the thread with every signal blocked, so that signals are still
+    // handled by the event loop
+    sigset_t all_signals;
+    sigset_t previous_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &previous_signals);
+    m_stopping = 0;
+    int error = pthread_create(&m_thread, NULL, &AsyncLogWriter::m_run, this);
+    pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+    if (error != 0)
+    {
+        close(m_wakeup_pipe[ 0 ]);
+        close(m_wakeup_pipe[ 1 ]);
+        m_wakeup_pipe[ 0 ] = -1;
+        m_wakeup_pipe[ 1 ] = -1;
+        return false;
+    }
+    m_running = true;
+    return true;
+}
+
+// Write the records left in the ring and stop the thread
+void AsyncLogWriter::stop()
+{
+    if (!m_running)
+        return;
+
+    // Let the writer drain the ring and exit
+    __atomic_store_n(&m_stopping, 1, __ATOMIC_SEQ_CST);
+    this->m_wakeUp();
+    pthread_join(m_thread, NULL);
+    m_running = false;
+
+    // Close the pipe
+    close(m_wakeup_pipe[ 0 ]);
+    close(m_wakeup_pipe[ 1 ]);
+    m_wakeup_pipe[ 0 ] = -1;
+    m_wakeup_pipe[ 1 ] = -1;
+}
+
+// Check if the thread was started
+bool AsyncLogWriter::running() const { return m_running; }
+
+// Queue a record to be written to a file
+void AsyncLogWriter::push(int file_descriptor, const std::string &message)
+{
+    // Write the record directly if the ring is full
+    unsigned long head = m_head;
+    if (head - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) == LOG_RING_SIZE)
+    {
+        this->m_wakeUp();
+        const char *data = message.data();
+        size_t size = message.size();
+        while (size > 0)
+        {
+            ssize_t bytes_written = write(file_descriptor, data, size);
+            if (bytes_written == -1 && errno == EINTR)
+                continue;
+            if (bytes_written <= 0)
+                break;
+            data += bytes_written;
+            size -= bytes_written;
+        }
+        return;
+    }
+
+    // Copy the record to the free slot, then publish it
+    LogRecord &record = m_records[ head & (LOG_RING_SIZE - 1) ];
+    record.file_descriptor = file_descriptor;
+    record.message.assign(message);
+    __atomic_store_n(&m_head, head + 1, __ATOMIC_SEQ_CST);
+
+    // Wake the writer up if it went to sleep before seeing the record
+    if (__atomic_load_n(&m_sleeping, __ATOMIC_SEQ_CST))
+        this->m_wakeUp();
+}
+
+// Body of the writer thread
+void *AsyncLogWriter::m_run(void *writer)
+{
+    static_cast<AsyncLogWriter *>(writer)->m_drain();
+    return NULL;
+}
+
+// Write records until the writer is stopped and the ring is empty
+void AsyncLogWriter::m_drain()
+{
+    while (true)
+    {
+        unsigned long tail = m_tail;
+        unsigned long head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+
+        // Write the published records, then free their slots
+        if (tail != head)
+        {
+            tail = this->m_writeBatch(tail, head);
+            __atomic_store_n(&m_tail, tail, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        // Exit once stopped with nothing left to write
+        if (__atomic_load_n(&m_stopping, __ATOMIC_SEQ_CST))
+            break;
+
+        // Sleep until woken up, unless a record was published meanwhile
+        __atomic_store_n(&m_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&m_head, __ATOMIC_SEQ_CST) == tail &&
+            !__atomic_load_n(&m_stopping, __ATOMIC_SEQ_CST))
+        {
+            char wakeups[ 64 ];
+            if (read(m_wakeup_pipe[ 0 ], wakeups, sizeof(wakeups)) == -1 &&
+                errno != EINTR)
+                break;
+        }
+        __atomic_store_n(&m_sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+// Write the records of a file starting at a slot, up to the head
+// Returns the slot following the last record written
+unsigned long AsyncLogWriter::m_writeBatch(unsigned long tail,
+                                           unsigned long head)
+{
+    // Gather the consecutive records of the same file
+    int file_descriptor =
+        m_records[ tail & (LOG_RING_SIZE - 1) ].file_descriptor;
+    struct iovec vectors[ LOG_WRITER_BATCH ];
+    int count = 0;
+    while (tail != head && count < LOG_WRITER_BATCH)
+    {
+        LogRecord &record = m_records[ tail & (LOG_RING_SIZE - 1) ];
+        if (record.file_descriptor != file_descriptor)
+            break;
+        vectors[ count ].iov_base = const_cast<char *>(record.message.data());
+        vectors[ count ].iov_len = record.message.size();
+        count++;
+        tail++;
+    }
+
+    // Write them, going on after a partial write
+    struct iovec *vector = vectors;
+    while (count > 0)
+    {
+        ssize_t bytes_written = writev(file_descriptor, vector, count);
+        if (bytes_written == -1 && errno == EINTR)
+            continue;
+        if (bytes_written <= 0)
+            break;
+
+        // Skip the records written, and the part written of the next one
+        while (count > 0 &&
+               static_cast<size_t>(bytes_written) >= vector->iov_len)
+        {
+            bytes_written -= vector->iov_len;
+            vector++;
+            count--;
+        }
+        if (count > 0)
+        {
+            vector->iov_base = static_cast<char *>(vector->iov_base) +
+                               bytes_written;
+            vector->iov_len -= bytes_written;
+        }
+    }
+    return tail;
+}
+
+// Wake the writer up
+void AsyncLogWriter::m_wakeUp()
+{
+    char wakeup = 0;
+    if (write(m_wakeup_pipe[ 1 ], &wakeup, 1) == -1)
+        return; // The pipe is full, the writer is already woken up
+}
+
+// Path: srcs/logger/AsyncLogWriter.cpp
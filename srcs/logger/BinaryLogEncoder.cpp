@@ -0,0 +1,110 @@
+#include "../../includes/logger/BinaryLogEncoder.hpp"
+#include "../../includes/request/IRequest.hpp"
+#include "../../includes/response/IResponse.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <unistd.h>
+
+/*
+ * BinaryLogEncoder.cpp
+ *
+ * Encodes the access records of a binary access log, interning the strings
+ * they refer to.
+ *
+ */
+
+// Constructor, the table is started by the first record
+BinaryLogEncoder::BinaryLogEncoder() : m_table_size(0), m_pid(0) {}
+
+// Destructor
+BinaryLogEncoder::~BinaryLogEncoder() {}
+
+// Append the records of a served request to a buffer
+void BinaryLogEncoder::render(const IConnection &connection,
+                              const IClock &clock, std::string &record)
+{
+    const IRequest &request = connection.getRequest();
+    const IResponse &response = connection.getResponse();
+
+    // Start the table in a new worker, or again once it grew too large
+    if (m_pid == 0 || m_table_size > BINARY_LOG_TABLE_SIZE)
+        this->m_startTable(record);
+
+    BinaryLogAccess access;
+    access.magic = BINARY_LOG_MAGIC;
+    access.type = BINARY_LOG_ACCESS;
+    access.method = request.getMethod();
+    access.status = atoi(response.getStatusCodeString().c_str());
+    access.pid = m_pid;
+    access.time = clock.getMicroseconds();
+
+    // Client address, in host byte order
+    struct in_addr address;
+    access.client_ip = inet_pton(AF_INET, connection.getIp().c_str(),
+                                 &address) == 1
+                           ? ntohl(address.s_addr)
+                           : 0;
+
+    // Time since the first bytes of the request
+    uint64_t start = request.getStartTime();
+    access.duration = start != 0 && access.time > start
+                          ? static_cast<uint32_t>(access.time - start)
+                          : 0;
+    access.bytes_sent = response.getResponseSize();
+
+    // Strings, written before the record referring to them
+    access.uri = this->m_intern(request.getUri(), record);
+    access.user_agent =
+        this->m_intern(request.getHeaderValue(USER_AGENT), record);
+    access.reserved = 0;
+
+    record.append(reinterpret_cast<const char *>(&access), sizeof(access));
+}
+
+// Get the offset of a string in the table, appending its string record to
+// the buffer if it is not there yet
+uint32_t BinaryLogEncoder::m_intern(const std::string &string,
+                                    std::string &record)
+{
+    std::map<std::string, uint32_t>::iterator it = m_strings.find(string);
+    if (it != m_strings.end())
+        return it->second;
+
+    // Write the string, at the end of the table, cut to the length decoders
+    // accept
+    BinaryLogString header;
+    header.magic = BINARY_LOG_MAGIC;
+    header.type = BINARY_LOG_STRING;
+    header.reserved = 0;
+    header.reserved2 = 0;
+    header.pid = m_pid;
+    header.offset = m_table_size;
+    header.length = std::min<size_t>(string.size(), BINARY_LOG_TABLE_SIZE);
+    record.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    record.append(string, 0, header.length);
+
+    // Strings are followed by a NUL in the table, so that every string,
+    // even empty, has its own offset
+    m_strings[ string ] = m_table_size;
+    m_table_size += header.length + 1;
+    return header.offset;
+}
+
+// Start the string table, appending a header record to the buffer
+void BinaryLogEncoder::m_startTable(std::string &record)
+{
+    m_strings.clear();
+    m_table_size = 0;
+    m_pid = getpid();
+
+    BinaryLogHeader header;
+    header.magic = BINARY_LOG_MAGIC;
+    header.type = BINARY_LOG_HEADER;
+    header.version = BINARY_LOG_VERSION;
+    header.reserved = 0;
+    header.pid = m_pid;
+    record.append(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+// Path: srcs/logger/BinaryLogEncoder.cpp
@@ -0,0 +1,400 @@
+#include "../../includes/logger/LogFormat.hpp"
+#include "../../includes/exception/WebservExceptions.hpp"
+#include "../../includes/request/IRequest.hpp"
+#include "../../includes/response/IResponse.hpp"
+#include <cctype>
+
+/*
+ * LogFormat.cpp
+ *
+ * Access log format, compiled once from a log_format directive.
+ *
+ */
+
+// Append an unsigned number
+static void appendNumber(std::string &record, unsigned long number)
+{
+    char digits[ 20 ];
+    size_t length = 0;
+    do
+    {
+        digits[ length++ ] = '0' + number % 10;
+        number /= 10;
+    } while (number > 0);
+    while (length > 0)
+        record += digits[ --length ];
+}
+
+// Append a duration in microseconds as seconds with a millisecond resolution
+static void appendSeconds(std::string &record, uint64_t microseconds)
+{
+    unsigned long milliseconds = microseconds / 1000;
+    appendNumber(record, milliseconds / 1000);
+    record += '.';
+    record += '0' + milliseconds / 100 % 10;
+    record += '0' + milliseconds / 10 % 10;
+    record += '0' + milliseconds % 10;
+}
+
+// Escape the end of a record for a JSON string, from an offset
+static void escapeJson(std::string &record, size_t offset)
+{
+    // Most values need no escaping
+    size_t position = offset;
+    while (position < record.size() &&
+           static_cast<unsigned char>(record[ position ]) >= 0x20 &&
+           record[ position ] != '"' && record[ position ] != '\\')
+        position++;
+    if (position == record.size())
+        return;
+
+    // Escape the rest of the value
+    static const char hex[] = "0123456789abcdef";
+    std::string value = record.substr(position);
+    record.resize(position);
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        unsigned char character = value[ i ];
+        if (character == '"' || character == '\\')
+        {
+            record += '\\';
+            record += character;
+        }
+        else if (character < 0x20)
+        {
+            record += "\\u00";
+            record += hex[ character >> 4 ];
+            record += hex[ character & 0xf ];
+        }
+        else
+            record += character;
+    }
+}
+
+// Escape the end of a record as nginx does outside JSON, from an offset
+// Quotes, backslashes, control and non-ASCII bytes are written as \xHH, so
+// that a value can not break the quoted fields of the record
+static void escapeDefault(std::string &record, size_t offset)
+{
+    // Most values need no escaping
+    size_t position = offset;
+    while (position < record.size() &&
+           static_cast<unsigned char>(record[ position ]) >= 0x20 &&
+           static_cast<unsigned char>(record[ position ]) < 0x7f &&
+           record[ position ] != '"' && record[ position ] != '\\')
+        position++;
+    if (position == record.size())
+        return;
+
+    // Escape the rest of the value
+    static const char hex[] = "0123456789ABCDEF";
+    std::string value = record.substr(position);
+    record.resize(position);
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        unsigned char character = value[ i ];
+        if (character < 0x20 || character >= 0x7f || character == '"' ||
+            character == '\\')
+        {
+            record += "\\x";
+            record += hex[ character >> 4 ];
+            record += hex[ character & 0xf ];
+        }
+        else
+            record += character;
+    }
+}
+
+// Getters of the variables
+static void getRemoteAddr(const IConnection &connection, const IClock &,
+                          HttpHeader, std::string &record)
+{
+    record += connection.getIp();
+}
+
+static void getRemotePort(const IConnection &connection, const IClock &,
+                          HttpHeader, std::string &record)
+{
+    appendNumber(record, connection.getPort());
+}
+
+static void getNothing(const IConnection &, const IClock &, HttpHeader,
+                       std::string &)
+{
+}
+
+static void getTimeLocal(const IConnection &, const IClock &clock, HttpHeader,
+                         std::string &record)
+{
+    record += clock.getCommonLogTimestamp();
+}
+
+static void getTimeIso8601(const IConnection &, const IClock &clock,
+                           HttpHeader, std::string &record)
+{
+    record += clock.getIso8601();
+}
+
+static void getMsec(const IConnection &, const IClock &clock, HttpHeader,
+                    std::string &record)
+{
+    appendSeconds(record, clock.getMicroseconds());
+}
+
+static void getRequestTime(const IConnection &connection, const IClock &clock,
+                           HttpHeader, std::string &record)
+{
+    uint64_t start = connection.getRequest().getStartTime();
+    uint64_t now = clock.getMicroseconds();
+    appendSeconds(record, start != 0 && now > start ? now - start : 0);
+}
+
+static void getRequest(const IConnection &connection, const IClock &,
+                       HttpHeader, std::string &record)
+{
+    const IRequest &request = connection.getRequest();
+    record += request.getMethodString();
+    record += ' ';
+    record += request.getUri();
+    record += ' ';
+    record += request.getHttpVersionString();
+}
+
+static void getRequestMethod(const IConnection &connection, const IClock &,
+                             HttpHeader, std::string &record)
+{
+    record += connection.getRequest().getMethodString();
+}
+
+static void getRequestUri(const IConnection &connection, const IClock &,
+                          HttpHeader, std::string &record)
+{
+    record += connection.getRequest().getUri();
+}
+
+static void getUri(const IConnection &connection, const IClock &, HttpHeader,
+                   std::string &record)
+{
+    // The path ends at the query string
+    std::string uri = connection.getRequest().getUri();
+    record.append(uri, 0, uri.find('?'));
+}
+
+static void getQueryString(const IConnection &connection, const IClock &,
+                           HttpHeader, std::string &record)
+{
+    record += connection.getRequest().getQueryString();
+}
+
+static void getServerProtocol(const IConnection &connection, const IClock &,
+                              HttpHeader, std::string &record)
+{
+    record += connection.getRequest().getHttpVersionString();
+}
+
+static void getHost(const IConnection &connection, const IClock &, HttpHeader,
+                    std::string &record)
+{
+    record += connection.getRequest().getHostName();
+}
+
+static void getStatus(const IConnection &connection, const IClock &,
+                      HttpHeader, std::string &record)
+{
+    // The status code starts the status line after the version
+    std::string status = connection.getResponse().getStatusCodeString();
+    record.append(status, 0, status.find(' '));
+}
+
+static void getBodyBytesSent(const IConnection &connection, const IClock &,
+                             HttpHeader, std::string &record)
+{
+    appendNumber(record, connection.getResponse().getContentLength());
+}
+
+static void getBytesSent(const IConnection &connection, const IClock &,
+                         HttpHeader, std::string &record)
+{
+    appendNumber(record, connection.getResponse().getResponseSize());
+}
+
+static void getConnectionRequests(const IConnection &connection,
+                                  const IClock &, HttpHeader,
+                                  std::string &record)
+{
+    appendNumber(record, connection.getRequestCount());
+}
+
+static void getHttpHeader(const IConnection &connection, const IClock &,
+                          HttpHeader header, std::string &record)
+{
+    connection.getRequest().appendHeaderValue(header, record);
+}
+
+// Variables, by name
+static const struct
+{
+    const char *name;
+    LogVariableGetter getter;
+} s_variables[] = {
+    {"remote_addr", &getRemoteAddr},
+    {"remote_port", &getRemotePort},
+    {"remote_user", &getNothing},
+    {"time_local", &getTimeLocal},
+    {"time_iso8601", &getTimeIso8601},
+    {"msec", &getMsec},
+    {"request_time", &getRequestTime},
+    {"request", &getRequest},
+    {"request_method", &getRequestMethod},
+    {"request_uri", &getRequestUri},
+    {"uri", &getUri},
+    {"query_string", &getQueryString},
+    {"server_protocol", &getServerProtocol},
+    {"host", &getHost},
+    {"status", &getStatus},
+    {"body_bytes_sent", &getBodyBytesSent},
+    {"bytes_sent", &getBytesSent},
+    {"connection_requests", &getConnectionRequests},
+};
+
+// Constructor, compiles the combined format
+LogFormat::LogFormat() : m_escape_json(false)
+{
+    this->m_compile(LOG_FORMAT_COMBINED);
+}
+
+// Constructor, compiles a format
+LogFormat::LogFormat(const std::string &format, bool escape_json)
+    : m_escape_json(escape_json)
+{
+    this->m_compile(format);
+}
+
+// Destructor
+LogFormat::~LogFormat() {}
+
+// Compile a format into segments
+void LogFormat::m_compile(const std::string &format)
+{
+    size_t position = 0;
+    while (position < format.size())
+    {
+        // Everything up to the next variable is a literal
+        size_t dollar = format.find('$', position);
+        if (dollar == std::string::npos)
+            dollar = format.size();
+        if (dollar > position)
+            this->m_addLiteral(format.substr(position, dollar - position));
+        if (dollar == format.size())
+            break;
+
+        // The name is made of letters, digits and underscores, it may be
+        // enclosed in braces
+        size_t start = dollar + 1;
+        bool braces = start < format.size() && format[ start ] == '{';
+        if (braces)
+            start++;
+        size_t end = start;
+        while (end < format.size() &&
+               (isalnum(static_cast<unsigned char>(format[ end ])) ||
+                format[ end ] == '_'))
+            end++;
+
+        // A lone dollar sign is a literal
+        if (end == start)
+        {
+            this->m_addLiteral("$");
+            position = dollar + 1;
+            continue;
+        }
+        this->m_addVariable(format.substr(start, end - start));
+        position = end;
+        if (braces && position < format.size() && format[ position ] == '}')
+            position++;
+    }
+}
+
+// Add a literal segment, merged with the previous one if it is a literal
+void LogFormat::m_addLiteral(const std::string &literal)
+{
+    if (!m_segments.empty() && m_segments.back().getter == NULL)
+    {
+        m_segments.back().literal += literal;
+        return;
+    }
+    LogFormatSegment segment;
+    segment.literal = literal;
+    segment.getter = NULL;
+    segment.header = HttpHeader();
+    m_segments.push_back(segment);
+}
+
+// Add the segment of a variable, throws UnknownLogVariableError if the name
+// is none of the supported ones
+void LogFormat::m_addVariable(const std::string &name)
+{
+    LogFormatSegment segment;
+    segment.getter = &getNothing;
+    segment.header = HttpHeader();
+
+    // Request headers, named in lowercase with underscores for dashes
+    if (name.compare(0, 5, "http_") == 0)
+    {
+        std::string header_name = name.substr(5);
+        for (size_t i = 0; i < header_name.size(); i++)
+        {
+            header_name[ i ] = tolower(
+                static_cast<unsigned char>(header_name[ i ]));
+            if (header_name[ i ] == '_')
+                header_name[ i ] = '-';
+        }
+        HttpHeaderHelper header_helper;
+        if (header_helper.isHeaderName(header_name))
+        {
+            segment.getter = &getHttpHeader;
+            segment.header = header_helper.stringHttpHeaderMap(header_name);
+        }
+        m_segments.push_back(segment);
+        return;
+    }
+
+    // Other variables, a name that is none of them is a mistake in the
+    // configuration
+    for (size_t i = 0; i < sizeof(s_variables) / sizeof(s_variables[ 0 ]); i++)
+    {
+        if (name == s_variables[ i ].name)
+        {
+            segment.getter = s_variables[ i ].getter;
+            m_segments.push_back(segment);
+            return;
+        }
+    }
+    throw UnknownLogVariableError(name);
+}
+
+// Append the record of a served request to a buffer
+void LogFormat::render(const IConnection &connection, const IClock &clock,
+                       std::string &record) const
+{
+    for (std::vector<LogFormatSegment>::const_iterator it = m_segments.begin();
+         it != m_segments.end(); ++it)
+    {
+        if (it->getter == NULL)
+        {
+            record += it->literal;
+            continue;
+        }
+
+        // Empty values are rendered as "-", unless escaped for JSON
+        size_t offset = record.size();
+        it->getter(connection, clock, it->header, record);
+        if (m_escape_json)
+            escapeJson(record, offset);
+        else if (record.size() == offset)
+            record += '-';
+        else
+            escapeDefault(record, offset);
+    }
+}
+
+// Path: srcs/logger/LogFormat.cpp
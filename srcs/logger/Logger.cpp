@@ -1,5 +1,4 @@
 #include "../../includes/logger/Logger.hpp"
-#include <ctime>
 #include <iostream>
 
 /*
@@ -26,9 +25,10 @@
  * method="GET" requestURI="/index.php" httpVersion="HTTP/1.1" etc.
  */
 
-Logger::Logger(IBufferManager &buffer_manager)
-    : m_configuration(NULL), m_buffer_manager(buffer_manager),
-      m_log_level_helper()
+Logger::Logger(IBufferManager &buffer_manager, IClock &clock)
+    : m_configuration(NULL), m_buffer_manager(buffer_manager), m_clock(clock),
+      m_log_level_helper(), m_async_writer(), m_default_format(),
+      m_access_record()
 {
     // Log the initialization of the Logger
     this->log(EXHAUSTIVE, "Logger initialized.");
@@ -36,18 +36,17 @@ Logger::Logger(IBufferManager &buffer_manager)
 
 // Destructor: Handles cleanup tasks like flushing buffer and closing log file
 // descriptor
+// The writer thread, if started, writes the records left before exiting
 Logger::~Logger() {}
 
-// Method to get the current timestamp
-std::string Logger::m_getCurrentTimestamp() const
+// Method to get the current timestamp, formatted by the clock once per second
+// Until the Logger is configured, no event loop updates the clock, so it is
+// read for every message
+const std::string &Logger::m_getCurrentTimestamp() const
 {
-    std::stringstream stream;
-    std::time_t current_time = std::time(NULL);
-    char buffer[ 80 ];
-
-    strftime(buffer, 80, "%Y-%m-%d %H:%M:%S", localtime(&current_time));
-    stream << buffer;
-    return stream.str();
+    if (m_configuration == NULL)
+        m_clock.update();
+    return m_clock.getLogTimestamp();
 }
 
 // Default Method to log error messages
@@ -74,9 +73,7 @@ int Logger::log(LogLevel logLevel, const std::string &message)
 {
     // If the Logger is disabled or the log level below threshold, return
     // without logging
-    if (m_configuration != NULL &&
-        (m_configuration->getErrorLogEnabled() == false ||
-         logLevel < m_configuration->getLogLevel()))
+    if (!this->isEnabled(logLevel))
         return -1;
 
     // Construct the log message string
@@ -95,6 +92,15 @@ int Logger::log(LogLevel logLevel, const std::string &message)
                               : STDERR_FILENO);
 }
 
+// Method to check if a log level is logged, everything is logged until the
+// Logger is configured
+bool Logger::isEnabled(const LogLevel logLevel) const
+{
+    return m_configuration == NULL ||
+           (m_configuration->getErrorLogEnabled() &&
+            logLevel >= m_configuration->getLogLevel());
+}
+
 // Method to log access events
 int Logger::log(const IConnection &connection)
 {
@@ -104,90 +110,45 @@ int Logger::log(const IConnection &connection)
         m_configuration->getAccessLogEnabled() == false)
         return -1;
 
-    // Get a reference to the Request and Response objects
-    IRequest &request = connection.getRequest();
-    const IResponse &response = connection.getResponse();
+    // Get the access log of the server the request was routed to, the
+    // combined format to stderr if the Logger is not configured
+    const LogFormat *format = &m_default_format;
+    BinaryLogEncoder *encoder = NULL;
+    int file_descriptor = STDERR_FILENO;
+    if (m_configuration != NULL)
+    {
+        IRequest &request = connection.getRequest();
+        const AccessLog &access_log = m_configuration->getAccessLog(
+            request.getHostName(), request.getHostPort());
+        if (access_log.file_descriptor < 0)
+            return -1;
+        format = access_log.format;
+        encoder = access_log.encoder;
+        file_descriptor = access_log.file_descriptor;
+    }
 
-    std::string log_message;
+    // Render the record into the reused buffer
+    m_access_record.clear();
     try // Will fail in case of incorrect request/response
     {
-        // Create a temporary stringstream object to construct the log message
-        std::ostringstream log_buffer_stream;
-        log_buffer_stream
-            << "{\n"
-            << "\ttimestamp=\"" << m_getCurrentTimestamp() << "\",\n"
-            << "\tclient_ip=\"" << connection.getIp() << "\",\n"
-            << "\tclient_port=\"" << connection.getPort() << "\",\n"
-            << "\tauthority=\"" << request.getAuthority() << "\",\n"
-            << "\tmethod=\"" << request.getMethodString() << "\",\n"
-            << "\trequest_uri=\"" << request.getUri() << "\",\n"
-            << "\thttp_version=\"" << request.getHttpVersionString() << "\",\n"
-            << "\tstatus_code=\"" << response.getStatusCodeString()
-            << "\tresponse_size=\"" << response.getResponseSizeString()
-            << "\",\n"
-            << "\tuser_agent=\"" << request.getHeaderValue(USER_AGENT)
-            << "\",\n"
-            << "\treferrer=\"" << request.getHeaderValue(REFERER) << "\n"
-            << "\"\n";
-
-        // Add request headers to the log message
-        m_appendMapToLog(log_buffer_stream, "request_headers",
-                         request.getHeadersStringMap());
-
-        // Add response headers to the log message
-        m_appendMapToLog(log_buffer_stream, "response_headers",
-                         response.getHeadersStringMap());
-
-        // Add request cookies to the log message
-        m_appendMapToLog(log_buffer_stream, "request_cookies",
-                         request.getCookies());
-
-        // Add response cookies to the log message
-        m_appendMapToLog(log_buffer_stream, "response_cookies",
-                         response.getCookies());
-
-        log_buffer_stream << "}\n";
-
-        // Convert the log message string to a vector of chars
-        log_message = log_buffer_stream.str();
+        if (encoder != NULL)
+            encoder->render(connection, m_clock, m_access_record);
+        else
+        {
+            format->render(connection, m_clock, m_access_record);
+            m_access_record += '\n';
+        }
     }
     catch (std::exception &e)
     {
         // Log the exception message
         this->log(ERROR, e.what());
     }
+    if (m_access_record.empty())
+        return -1;
 
-    // Push the log message to the access log file buffer if configured,
-    // otherwise push to stderr buffer
-    return m_pushToBuffer(log_message,
-                          m_configuration
-                              ? m_configuration->getAccessLogFileDescriptor()
-                              : STDERR_FILENO);
-}
-
-// Method to append map to log message
-void Logger::m_appendMapToLog(
-    std::ostringstream &log_buffer_stream, const std::string &field_name,
-    const std::map<std::string, std::string> &map) const
-{
-    std::ostringstream map_stream;
-
-    map_stream << "\t" << field_name << "=\n\t{\n";
-    for (std::map<std::string, std::string>::const_iterator it = map.begin();
-         it != map.end(); ++it)
-    {
-        map_stream << "\t\t" << it->first << ": " << it->second;
-        std::map<std::string, std::string>::const_iterator next = it;
-        next++;
-        if (next != map.end())
-        {
-            map_stream << ",\n";
-        }
-    }
-    map_stream << "\n\t}\n";
-
-    log_buffer_stream << map_stream.str(); // Append the constructed string to
-                                           // the log_buffer_stream
+    // Push the record to the access log file buffer
+    return m_pushToBuffer(m_access_record, file_descriptor);
 }
 
 // Configuration method
@@ -201,16 +162,25 @@ void Logger::configure(ILoggerConfiguration &configuration)
 int Logger::m_pushToBuffer(const std::string &log_message,
                            const int file_descriptor)
 {
-    // Copy output to stderr
-    std::cerr << log_message;
+    // Copy output to stderr if no log file is configured
+    if (m_configuration == NULL)
+        std::cerr << log_message;
 
-    // Convert the log message string to a vector of chars
-    std::vector<char> log_message_vector(log_message.begin(),
-                                         log_message.end());
+    // Hand the log message to the writer thread in asynchronous mode
+    if (m_configuration != NULL && m_configuration->getAsyncEnabled() &&
+        m_startAsyncWriter())
+    {
+        m_async_writer.push(file_descriptor, log_message);
+        return 0;
+    }
+
+    // Convert the log message string to a vector of chars, reusing the
+    // capacity of the previous messages
+    m_message_vector.assign(log_message.begin(), log_message.end());
 
     // Push the log message to the buffer, returns 1 if a flush is requested
     int return_value =
-        m_buffer_manager.pushFileBuffer(file_descriptor, log_message_vector);
+        m_buffer_manager.pushFileBuffer(file_descriptor, m_message_vector);
     if (return_value == 1 && m_configuration)
     {
         // If the buffer threshold is reached, request a flush
@@ -221,4 +191,22 @@ int Logger::m_pushToBuffer(const std::string &log_message,
     return return_value;
 }
 
+// Method to start the writer thread, with the first log message pushed once
+// configured, so that it only runs in worker processes
+// returns false if the thread could not be started
+bool Logger::m_startAsyncWriter()
+{
+    if (m_async_writer.running())
+        return true;
+
+    // Write what was buffered before, so that the log files stay in order
+    m_buffer_manager.flushBuffer(m_configuration->getErrorLogFileDescriptor(),
+                                 true);
+    m_buffer_manager.flushBuffer(m_configuration->getAccessLogFileDescriptor(),
+                                 true);
+
+    // Start the thread, or keep using the buffer
+    return m_async_writer.start();
+}
+
 // Path: includes/WebservExceptions.hpp
@@ -5,21 +5,35 @@
 LoggerConfiguration::LoggerConfiguration(IBufferManager &BufferManager,
                                          IConfiguration &configuration,
                                          IPollfdManager &pollfdManager)
-    : m_access_log_file(
-          configuration.getBlocks("http")[ 0 ]
-              ->getBlocks("server")[ 0 ]
-              ->getString("access_log")), // Currently only supports
-                                          // one access log file
-      m_buffer_manager(BufferManager), m_pollfd_manager(pollfdManager),
-      m_buffer_size(LOG_BUFFER_SIZE),
-      m_access_log_file_descriptor(
-          m_access_log_file == "off"
-              ? -2
-              : open(m_access_log_file.c_str(), O_WRONLY | O_CREAT | O_APPEND,
-                     S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)),
-      m_access_log_enabled(m_access_log_file_descriptor < 0 ? false : true),
+    : m_buffer_manager(BufferManager), m_pollfd_manager(pollfdManager),
+      m_buffer_size(LOG_BUFFER_SIZE), m_access_log_enabled(false),
+      m_async_enabled(configuration.getBool("log_async")),
       m_log_level_helper()
 {
+    // Compile the formats, then read the access log of each server
+    IConfiguration &http = *configuration.getBlocks("http")[ 0 ];
+    m_loadLogFormats(http);
+    const BlockList &servers = http.getBlocks("server");
+    for (size_t i = 0; i < servers.size(); i++)
+        m_loadAccessLog(*servers[ i ]);
+
+    // Without servers, an access log that is off stands for the default one,
+    // so that there always is one to fall back on
+    if (m_access_logs.empty())
+    {
+        AccessLog log;
+        log.file_descriptor = -2;
+        log.format = &m_log_formats[ "combined" ];
+        log.encoder = NULL;
+        m_access_logs.push_back(log);
+    }
+
+    // The first server is the default one
+    m_access_log_file = m_access_log_files.empty()
+                            ? "off"
+                            : servers[ 0 ]->getString("access_log");
+    m_access_log_file_descriptor = m_access_logs[ 0 ].file_descriptor;
+
     // Set the error log file as the first word in the error_log directive
     m_error_log_file = configuration.getString("error_log", 0);
     // Open the error log file if it is not set to "off"
@@ -46,9 +60,16 @@ LoggerConfiguration::LoggerConfiguration(IBufferManager &BufferManager,
                                // invalid, set it to the default log level
     }
 
-    // Throw an exception if the log file could not be opened
-    if (m_error_log_file_descriptor == -1 || m_access_log_file_descriptor == -1)
+    // Throw an exception if a log file could not be opened
+    if (m_error_log_file_descriptor == -1)
         throw LogFileOpenError();
+    for (std::map<std::string, int>::const_iterator it =
+             m_access_log_files.begin();
+         it != m_access_log_files.end(); ++it)
+    {
+        if (it->second == -1)
+            throw LogFileOpenError();
+    }
 
     // Set the buffer size
     m_buffer_manager.setFlushThreshold(m_buffer_size);
@@ -62,11 +83,135 @@ LoggerConfiguration::LoggerConfiguration(IBufferManager &BufferManager,
 LoggerConfiguration::~LoggerConfiguration()
 {
     m_buffer_manager.flushBuffer(m_error_log_file_descriptor, true);
-    m_buffer_manager.flushBuffer(m_access_log_file_descriptor, true);
-    if (m_error_log_file_descriptor != -1)
+    if (m_error_log_file_descriptor >= 0)
         close(m_error_log_file_descriptor);
-    if (m_access_log_file_descriptor != -1)
-        close(m_access_log_file_descriptor);
+    for (std::map<std::string, int>::const_iterator it =
+             m_access_log_files.begin();
+         it != m_access_log_files.end(); ++it)
+    {
+        m_buffer_manager.flushBuffer(it->second, true);
+        if (it->second >= 0)
+            close(it->second);
+    }
+}
+
+// Compile the log_format directives of the http block
+// The directive comes split on whitespace, each format being a name followed
+// by quoted strings or unquoted words
+void LoggerConfiguration::m_loadLogFormats(const IConfiguration &http)
+{
+    m_log_formats[ "combined" ] = LogFormat();
+    m_log_formats[ "json" ] = LogFormat(LOG_FORMAT_JSON, true);
+
+    const std::vector<std::string> &words = http.getStringVector("log_format");
+    std::string name;
+    std::string format;
+    bool escape_json = false;
+    char quote = '\0';
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        std::string word = words[ i ];
+
+        // Words between quotes belong to the same string
+        if (quote != '\0')
+        {
+            format += ' ';
+            size_t end = word.find(quote);
+            if (end == std::string::npos)
+            {
+                format += word;
+                continue;
+            }
+            format += word.substr(0, end);
+            word = word.substr(end + 1);
+            quote = '\0';
+            if (word.empty())
+                continue;
+        }
+
+        // The escaping follows the name
+        if (!name.empty() && format.empty() &&
+            word.compare(0, 7, "escape=") == 0)
+        {
+            escape_json = word == "escape=json";
+            continue;
+        }
+
+        // An unquoted word without a variable names the next format
+        if (word[ 0 ] != '\'' && word[ 0 ] != '"' &&
+            word.find('$') == std::string::npos &&
+            (name.empty() || !format.empty()))
+        {
+            if (!name.empty())
+                m_log_formats[ name ] = LogFormat(format, escape_json);
+            name = word;
+            format.clear();
+            escape_json = false;
+            continue;
+        }
+
+        // Start a quoted string, which may end in the same word
+        if (word[ 0 ] == '\'' || word[ 0 ] == '"')
+        {
+            quote = word[ 0 ];
+            size_t end = word.find(quote, 1);
+            if (end == std::string::npos)
+            {
+                format += word.substr(1);
+                continue;
+            }
+            format += word.substr(1, end - 1);
+            quote = '\0';
+        }
+        else
+            format += word;
+    }
+    if (!name.empty())
+        m_log_formats[ name ] = LogFormat(format, escape_json);
+}
+
+// Read the access_log directive of a server block
+void LoggerConfiguration::m_loadAccessLog(const IConfiguration &server)
+{
+    const std::vector<std::string> &access_log =
+        server.getStringVector("access_log");
+
+    AccessLog log;
+    log.server_name = server.getString("server_name");
+    log.listen = server.getString("listen");
+    log.file_descriptor = -2;
+    log.format = &m_log_formats[ "combined" ];
+    log.encoder = NULL;
+
+    // Open the file, unless logging is off
+    if (!access_log.empty() && access_log[ 0 ] != "off")
+    {
+        log.file_descriptor = m_openAccessLogFile(access_log[ 0 ]);
+        if (log.file_descriptor >= 0)
+            m_access_log_enabled = true;
+    }
+
+    // Use the named format, the combined one if it is unknown, binary files
+    // having an encoder of their own
+    if (access_log.size() > 1 && access_log[ 1 ] == "binary" &&
+        log.file_descriptor >= 0)
+        log.encoder = &m_binary_encoders[ access_log[ 0 ] ];
+    else if (access_log.size() > 1 &&
+             m_log_formats.find(access_log[ 1 ]) != m_log_formats.end())
+        log.format = &m_log_formats[ access_log[ 1 ] ];
+    m_access_logs.push_back(log);
+}
+
+// Open a log file, once for all the servers sharing it
+int LoggerConfiguration::m_openAccessLogFile(const std::string &path)
+{
+    std::map<std::string, int>::iterator it = m_access_log_files.find(path);
+    if (it != m_access_log_files.end())
+        return it->second;
+    int file_descriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND,
+                               S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    m_access_log_files[ path ] = file_descriptor;
+    return file_descriptor;
 }
 
 void LoggerConfiguration::setErrorLogEnabled(bool enabled)
@@ -125,4 +270,22 @@ bool LoggerConfiguration::getAccessLogEnabled() const
     return m_access_log_enabled;
 }
 
+bool LoggerConfiguration::getAsyncEnabled() const { return m_async_enabled; }
+
+// Get the access log of the server a request was routed to, matched on its
+// host like the Router does, the first server being the default one
+const AccessLog &
+LoggerConfiguration::getAccessLog(const std::string &host_name,
+                                  const std::string &host_port) const
+{
+    const AccessLog *access_log = &m_access_logs[ 0 ];
+    for (size_t i = 1; i < m_access_logs.size(); i++)
+    {
+        if (host_name == m_access_logs[ i ].server_name &&
+            host_port == m_access_logs[ i ].listen)
+            access_log = &m_access_logs[ i ];
+    }
+    return *access_log;
+}
+
 // Path: srcs/Logger.cpp
@@ -22,10 +22,11 @@ Server::Server(const ISocket &socket, IPollfdManager &pollfdManager,
                IConnectionManager &connectionManager,
                IConfiguration &configuration, ILogger &logger)
     : m_socket(socket), m_pollfd_manager(pollfdManager),
-      m_connection_manager(connectionManager), m_logger(logger)
+      m_connection_manager(connectionManager), m_logger(logger),
+      m_reuse_port(configuration.getString("worker_processes") != "1")
 {
     // Log server initialization
-    m_logger.log(VERBOSE, "Initializing Server...");
+    LOG(m_logger, VERBOSE, "Initializing Server...");
 
     // Get the maximum connections value
     int max_connections =
@@ -81,7 +82,7 @@ Server::Server(const ISocket &socket, IPollfdManager &pollfdManager,
             }
         }
     }
-    m_logger.log(VERBOSE, "... finished Server initialization");
+    LOG(m_logger, VERBOSE, "... finished Server initialization");
 }
 
 /* Destructor to close file descriptors*/
@@ -103,6 +104,10 @@ void Server::m_initializeServerSocket(int ip, int port, int max_connections)
     if (m_socket.setReuseAddr(server_socket_descriptor) < 0)
         throw SocketSetError();
 
+    // Set server socket option to share the port with the other workers
+    if (m_reuse_port && m_socket.setReusePort(server_socket_descriptor) < 0)
+        throw SocketSetError();
+
     // Bind server socket to port
     if (m_socket.bind(server_socket_descriptor, ip, port) < 0)
         throw SocketBindError(server_socket_descriptor, ip, port);
@@ -123,9 +128,9 @@ void Server::m_initializeServerSocket(int ip, int port, int max_connections)
     m_pollfd_manager.addServerSocketPollfd(pollfd);
 
     // Log server socket initialization
-    m_logger.log(INFO, "Server socket initialized. Listening on " +
-                           (ip ? Converter::toString(ip) : "ALL") + ":" +
-                           Converter::toString(port));
+    LOG(m_logger, INFO, "Server socket initialized. Listening on " +
+                        (ip ? Converter::toString(ip) : "ALL") + ":" +
+                        Converter::toString(port));
 }
 
 /* Terminate server*/
@@ -162,8 +167,8 @@ void Server::acceptConnection(int server_socket_descriptor)
         throw SocketSetError();
 
     // Log accepted connection
-    m_logger.log(VERBOSE, "Accepted new connection from " + client_ip + ":" +
-                              client_port + ".");
+    LOG(m_logger, VERBOSE, "Accepted new connection from " + client_ip + ":" +
+                           client_port + ".");
 }
 
 // Path: /srcs/network/Server.cpp
@@ -4,6 +4,10 @@
 #include <sstream>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 /*
  * Socket - Class for socket operations.
@@ -155,6 +159,63 @@ int Socket::sendAll(int socket_descriptor, const std::vector<char> &data) const
     return ::send(socket_descriptor, data.data(), data.size(), MSG_NOSIGNAL);
 }
 
+// Sends the content of several buffers over the socket
+ssize_t Socket::writev(int socket_descriptor, const struct iovec *iov,
+                       int iovcnt, bool blocking) const
+{
+    // Send the buffers in a single call, as writev(2) would, but without
+    // raising SIGPIPE on a closed connection
+    // Returns the number of bytes sent
+    // -1 is returned on error
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = const_cast<struct iovec *>(iov);
+    message.msg_iovlen = iovcnt;
+    int flags = blocking ? MSG_NOSIGNAL : MSG_DONTWAIT | MSG_NOSIGNAL;
+    return ::sendmsg(socket_descriptor, &message, flags);
+}
+
+// Sends data over the socket Non-Blockingly, more data following it
+int Socket::sendMore(int socket_descriptor, const std::vector<char> &data) const
+{
+    // Let the kernel hold a partial segment back until the rest of the data
+    // comes, a small write followed by another one would otherwise wait on
+    // the delayed acknowledgement of the client
+#ifdef MSG_MORE
+    return ::send(socket_descriptor, data.data(), data.size(),
+                  MSG_DONTWAIT | MSG_NOSIGNAL | MSG_MORE);
+#else
+    return this->send(socket_descriptor, data);
+#endif
+}
+
+// Sends a file range over the socket Non-Blockingly
+ssize_t Socket::sendFile(int socket_descriptor, int file_descriptor,
+                         off_t &offset, size_t count) const
+{
+    // Send the file without copying it through user space
+    // socket_descriptor: File descriptor of the socket
+    // file_descriptor: File descriptor of the file, read from offset
+    // Returns the number of bytes sent, offset being advanced past them
+    // -1 is returned on error
+#ifdef __linux__
+    return ::sendfile(socket_descriptor, file_descriptor, &offset, count);
+#else
+    // Fall back on a bounded read and send on other systems
+    char buffer[ 65536 ];
+    if (count > sizeof(buffer))
+        count = sizeof(buffer);
+    ssize_t bytes_read = ::pread(file_descriptor, buffer, count, offset);
+    if (bytes_read <= 0)
+        return bytes_read;
+    ssize_t bytes_sent = ::send(socket_descriptor, buffer, bytes_read,
+                                MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (bytes_sent > 0)
+        offset += bytes_sent;
+    return bytes_sent;
+#endif
+}
+
 // Receives data from the socket Non-Blockingly
 ssize_t Socket::recv(int socket_descriptor, char *buffer, size_t len) const
 {
@@ -172,4 +233,12 @@ int Socket::setReuseAddr(int fd) const
     return setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
 }
 
+// Let several sockets bind the same port, the kernel spreading the incoming
+// connections between them
+int Socket::setReusePort(int fd) const
+{
+    int optval = 1;
+    return setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval));
+}
+
 // Path: srcs/network/socket.cpp
@@ -0,0 +1,183 @@
+#include "../../includes/pollfd/EpollPollfdManager.hpp"
+#include "../../includes/exception/WebservExceptions.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <cerrno>
+
+/*
+ * EpollPollfdManager.cpp
+ *
+ * This file implements the EpollPollfdManager class, which keeps an epoll
+ * instance in sync with the PollfdQueue of its PollfdManager base.
+ *
+ */
+
+#ifdef __linux__
+
+// Constructor for EpollPollfdManager class
+EpollPollfdManager::EpollPollfdManager(IConfiguration &configuration,
+                                       ILogger &logger,
+                                       DescriptorTable &descriptors)
+    : PollfdManager(configuration, logger, descriptors),
+      m_edge_triggered(
+          configuration.getBlocks("events")[ 0 ]->getBool("edge_triggered")),
+      m_logger(logger)
+{
+    // Create the epoll instance, not inherited by the CGI processes
+    m_epoll_descriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_descriptor == -1)
+        throw PollError();
+
+    // Log the creation of the EpollPollfdManager
+    LOG(m_logger, VERBOSE, "EpollPollfdManager created.");
+}
+
+// Destructor for EpollPollfdManager class
+EpollPollfdManager::~EpollPollfdManager()
+{
+    // Close the epoll instance
+    close(m_epoll_descriptor);
+
+    // Log the destruction of the EpollPollfdManager
+    LOG(m_logger, VERBOSE, "EpollPollfdManager destroyed.");
+}
+
+// Method to translate the poll events of a descriptor to epoll events
+uint32_t EpollPollfdManager::m_toEpollEvents(short events, int position)
+{
+    uint32_t epoll_events = 0;
+
+    if (events & POLLIN)
+        epoll_events |= EPOLLIN;
+    if (events & POLLOUT)
+        epoll_events |= EPOLLOUT;
+
+    // Server sockets accept one connection per event and stay level-triggered
+    short type = getEvents(position) & 0xC0; // keep the descriptor type bits
+    if (m_edge_triggered && (type == CLIENT_SOCKET || type == PIPE))
+        epoll_events |= EPOLLET;
+
+    // EPOLLERR and EPOLLHUP are always reported
+    return epoll_events;
+}
+
+// Method to add a polling file descriptor
+void EpollPollfdManager::m_addPollfd(pollfd pollFd)
+{
+    // Add the pollfd to the PollfdQueue
+    PollfdManager::m_addPollfd(pollFd);
+
+    // Register the descriptor with the epoll instance
+    epoll_event event;
+    event.events =
+        m_toEpollEvents(pollFd.events, getPollfdQueueIndex(pollFd.fd));
+    event.data.fd = pollFd.fd;
+    if (epoll_ctl(m_epoll_descriptor, EPOLL_CTL_ADD, pollFd.fd, &event) == -1)
+    {
+        // Regular files cannot be watched, they are always ready
+        if (errno == EPERM)
+            m_regular_file_descriptors.push_back(pollFd.fd);
+        else
+            m_logger.log(ERROR, "[EPOLLFDMANAGER] Failed to register "
+                                "descriptor: " +
+                                    Converter::toString(pollFd.fd));
+    }
+}
+
+// Method to remove a polling file descriptor
+void EpollPollfdManager::removePollfd(int position)
+{
+    // Get the descriptor at the specified position
+    int descriptor = getDescriptor(position);
+
+    // Unregister the descriptor, while it is still open
+    bool is_regular_file = false;
+    for (size_t i = 0; i < m_regular_file_descriptors.size(); i++)
+    {
+        if (m_regular_file_descriptors[ i ] == descriptor)
+        {
+            m_regular_file_descriptors.erase(
+                m_regular_file_descriptors.begin() + i);
+            is_regular_file = true;
+            break;
+        }
+    }
+    if (!is_regular_file)
+        epoll_ctl(m_epoll_descriptor, EPOLL_CTL_DEL, descriptor, NULL);
+
+    // Remove the pollfd from the PollfdQueue
+    PollfdManager::removePollfd(position);
+}
+
+// Method to add the POLLOUT event for a specific position in the PollfdQueue
+void EpollPollfdManager::addPollOut(int position)
+{
+    // Add the POLLOUT event to the PollfdQueue
+    PollfdManager::addPollOut(position);
+
+    // Update the registration of the descriptor
+    m_updateRegistration(position);
+}
+
+// Method to remove the POLLOUT event for a specific position in the
+// PollfdQueue
+void EpollPollfdManager::removePollOut(int position)
+{
+    // Remove the POLLOUT event from the PollfdQueue
+    PollfdManager::removePollOut(position);
+
+    // Update the registration of the descriptor
+    m_updateRegistration(position);
+}
+
+// Method to add the POLLIN event for a specific position in the PollfdQueue
+// The registration being updated, data already waiting is reported again
+void EpollPollfdManager::addPollIn(int position)
+{
+    // Add the POLLIN event to the PollfdQueue
+    PollfdManager::addPollIn(position);
+
+    // Update the registration of the descriptor
+    m_updateRegistration(position);
+}
+
+// Method to remove the POLLIN event for a specific position in the
+// PollfdQueue
+void EpollPollfdManager::removePollIn(int position)
+{
+    // Remove the POLLIN event from the PollfdQueue
+    PollfdManager::removePollIn(position);
+
+    // Update the registration of the descriptor
+    m_updateRegistration(position);
+}
+
+// Method to update the registration of a descriptor after its events changed
+void EpollPollfdManager::m_updateRegistration(int position)
+{
+    pollfd &pollFd = getPollfdArray()[ position ];
+    epoll_event event;
+    event.events = m_toEpollEvents(pollFd.events, position);
+    event.data.fd = pollFd.fd;
+
+    // Regular files are not registered, nothing to update
+    epoll_ctl(m_epoll_descriptor, EPOLL_CTL_MOD, pollFd.fd, &event);
+}
+
+// Method to check if readiness is only reported on state changes
+bool EpollPollfdManager::isEdgeTriggered() const { return m_edge_triggered; }
+
+// Method to get the descriptor of the epoll instance
+int EpollPollfdManager::getEpollDescriptor() const
+{
+    return m_epoll_descriptor;
+}
+
+// Method to get the regular file descriptors, which are always ready
+const std::vector<int> &EpollPollfdManager::getRegularFileDescriptors() const
+{
+    return m_regular_file_descriptors;
+}
+
+#endif // __linux__
+
+// Path: srcs/pollfd/EpollPollfdManager.cpp
@@ -15,82 +15,68 @@
  */
 
 // Constructor for PollFdManager class
-PollfdManager::PollfdManager(IConfiguration &configuration, ILogger &logger)
+PollfdManager::PollfdManager(IConfiguration &configuration, ILogger &logger,
+                             DescriptorTable &descriptors)
     : m_pollfds(
           configuration.getBlocks("events")[ 0 ]->getInt("worker_connections") +
           3), // + 3 for server socket, error log, and access log, or more in
               // case of several server sockets
-      m_logger(logger)
+      m_logger(logger), m_descriptors(descriptors)
 {
     // Log the creation of the PollfdManager
-    m_logger.log(VERBOSE, "PollfdManager created.");
+    LOG(m_logger, VERBOSE, "PollfdManager created.");
 }
 
 // Destructor for PollFdManager class
 PollfdManager::~PollfdManager()
 {
     // Log the destruction of the PollfdManager
-    m_logger.log(VERBOSE, "PollfdManager destroyed.");
+    LOG(m_logger, VERBOSE, "PollfdManager destroyed.");
 }
 
 // Method to add a polling file descriptor
 void PollfdManager::m_addPollfd(pollfd pollFd)
 {
-    // Log the addition of a pollfd
-    m_logger.log(VERBOSE, "[POLLFDMANAGER] Adding pollfd for descriptor: " +
-                              Converter::toString(pollFd.fd));
+    // Record the queue index of the descriptor
+    m_descriptors[ pollFd.fd ].pollfd_index = m_pollfds.size();
 
     // Add the pollfd to the pollfdQueue
     m_pollfds.push(pollFd);
+
+    // Log the addition of a pollfd, once it is recorded: logging may request
+    // a flush of the log file, which must find its pollfd already added
+    LOG(m_logger, VERBOSE, "[POLLFDMANAGER] Adding pollfd for descriptor: " +
+                           Converter::toString(pollFd.fd));
 }
 
 // Method to add a regular file pollfd to the pollfdQueue
 void PollfdManager::addRegularFilePollfd(pollfd pollFd)
 {
-    if (m_descriptor_type_map.find(pollFd.fd) != m_descriptor_type_map.end())
+    if (m_descriptors.at(pollFd.fd).pollfd_index != -1)
         return; // Flush is already pending
 
-    m_descriptor_type_map[ pollFd.fd ] = REGULAR_FILE;
-    m_addPollfd(pollFd);
-}
-
-void PollfdManager::addBodyFilePollfd(pollfd pollFd)
-{
-    // Add the pollfd to the list of body file pollfds
-    m_body_file_descriptors.push_back(pollFd.fd);
-
-    m_descriptor_type_map[ pollFd.fd ] = REGULAR_FILE;
+    m_descriptors[ pollFd.fd ].type = REGULAR_FILE;
     m_addPollfd(pollFd);
 }
 
-bool PollfdManager::isBodyFile(int position)
-{
-    for (size_t i = 0; i < m_body_file_descriptors.size(); i++)
-    {
-        if (m_body_file_descriptors[ i ] == m_pollfds[ position ].fd)
-            return true;
-    }
-    return false;
-}
-
 // Method to add a server socket pollfd to the pollfdQueue
 void PollfdManager::addServerSocketPollfd(pollfd pollFd)
 {
-    m_descriptor_type_map[ pollFd.fd ] = SERVER_SOCKET;
+    m_descriptors[ pollFd.fd ].type = SERVER_SOCKET;
     m_addPollfd(pollFd);
 }
 
 // Method to add a client socket pollfd to the pollfdQueue
 void PollfdManager::addClientSocketPollfd(pollfd pollFd)
 {
-    m_descriptor_type_map[ pollFd.fd ] = CLIENT_SOCKET;
+    m_descriptors[ pollFd.fd ].type = CLIENT_SOCKET;
     m_addPollfd(pollFd);
 }
 
 // Method to add a pipe pollfd to the pollfdQueue
 void PollfdManager::addPipePollfd(pollfd pollFd)
 {
-    m_descriptor_type_map[ pollFd.fd ] = PIPE;
+    m_descriptors[ pollFd.fd ].type = PIPE;
     m_addPollfd(pollFd);
 }
 
@@ -101,21 +87,17 @@ void PollfdManager::removePollfd(int position)
     int descriptor = m_pollfds[ position ].fd;
 
     // Log the removal of a pollfd
-    m_logger.log(VERBOSE, "[POLLFDMANAGER] Removing pollfd for descriptor: " +
-                              Converter::toString(descriptor));
+    LOG(m_logger, VERBOSE, "[POLLFDMANAGER] Removing pollfd for descriptor: " +
+                           Converter::toString(descriptor));
 
-    // Remove the descriptor from the body file descriptors
-    for (size_t i = 0; i < m_body_file_descriptors.size(); i++)
-    {
-        if (m_body_file_descriptors[ i ] == descriptor)
-        {
-            m_body_file_descriptors.erase(m_body_file_descriptors.begin() + i);
-            break;
-        }
-    }
+    // The last pollfd is moved to the freed position, update its index
+    m_descriptors[ m_pollfds[ m_pollfds.size() - 1 ].fd ].pollfd_index =
+        position;
 
-    // Remove the descriptor from the descriptor type map
-    m_descriptor_type_map.erase(descriptor);
+    // Forget the type of the descriptor
+    DescriptorEntry &entry = m_descriptors[ descriptor ];
+    entry.pollfd_index = -1;
+    entry.type = 0;
 
     // Remove the pollfd from the pollfdQueue
     m_pollfds.erase(position);
@@ -124,6 +106,18 @@ void PollfdManager::removePollfd(int position)
 // Method to add the POLLOUT event for a specific position in the PollfdQueue
 void PollfdManager::addPollOut(int position) { m_pollfds.pollout(position); }
 
+// Method to remove the POLLOUT event for a specific position in the PollfdQueue
+void PollfdManager::removePollOut(int position) { m_pollfds.pollin(position); }
+
+// Method to add the POLLIN event for a specific position in the PollfdQueue
+void PollfdManager::addPollIn(int position) { m_pollfds.repollin(position); }
+
+// Method to remove the POLLIN event for a specific position in the PollfdQueue
+void PollfdManager::removePollIn(int position)
+{
+    m_pollfds.unpollin(position);
+}
+
 // Method to close all file descriptors in the PollfdQueue
 void PollfdManager::closeAllFileDescriptors()
 {
@@ -132,8 +126,8 @@ void PollfdManager::closeAllFileDescriptors()
         if (m_pollfds[ i ].fd != -1)
         {
             // Log the closing of a file descriptor
-            m_logger.log(VERBOSE, "[POLLFDMANAGER] Closing file descriptor: " +
-                                      Converter::toString(m_pollfds[ i ].fd));
+            LOG(m_logger, VERBOSE, "[POLLFDMANAGER] Closing file descriptor: " +
+                                   Converter::toString(m_pollfds[ i ].fd));
             close(m_pollfds[ i ].fd);
         }
     }
@@ -145,7 +139,7 @@ size_t PollfdManager::getPollfdQueueSize() const { return m_pollfds.size(); }
 // Method to get the events at a specific position in the PollfdQueue
 short PollfdManager::getEvents(int position)
 {
-    short type = m_descriptor_type_map[ m_pollfds[ position ].fd ];
+    short type = m_descriptors.at(m_pollfds[ position ].fd).type;
 
     // clear unused bits to be sure, then add the type
     return (m_pollfds[ position ].revents & 0x3F) | type;
@@ -169,12 +163,26 @@ pollfd *PollfdManager::getPollfdArray() { return m_pollfds.data(); }
 // Method to get the index of a file descriptor in the PollfdQueue
 int PollfdManager::getPollfdQueueIndex(int fd)
 {
-    for (size_t i = 0; i < m_pollfds.size(); i++)
-    {
-        if (m_pollfds[ i ].fd == fd)
-            return i;
-    }
-    return -1;
+    return m_descriptors.at(fd).pollfd_index;
 }
 
+// Method to register a descriptor reported ready by the polling service
+void PollfdManager::addReadyDescriptor(int fd)
+{
+    m_ready_descriptors.push_back(fd);
+}
+
+// Method to clear the descriptors reported ready in the last poll cycle
+void PollfdManager::clearReadyDescriptors() { m_ready_descriptors.clear(); }
+
+// Method to get the descriptors reported ready in the last poll cycle
+const std::vector<int> &PollfdManager::getReadyDescriptors() const
+{
+    return m_ready_descriptors;
+}
+
+// Method to check if readiness is only reported on state changes, poll is
+// always level-triggered
+bool PollfdManager::isEdgeTriggered() const { return false; }
+
 // Path: srcs/PollfdManager.cpp
@@ -95,6 +95,27 @@ void PollfdQueue::pollout(size_t index)
     m_pollfd_array[ index ].events |= m_poll_mask;
 }
 
+// Pollin: Removes POLLOUT from the events field of the pollfd object at the
+// specified index.
+void PollfdQueue::pollin(size_t index)
+{
+    m_pollfd_array[ index ].events &= ~POLLOUT;
+}
+
+// Unpollin: Removes POLLIN from the events field of the pollfd object at the
+// specified index.
+void PollfdQueue::unpollin(size_t index)
+{
+    m_pollfd_array[ index ].events &= ~POLLIN;
+}
+
+// Repollin: Adds POLLIN back to the events field of the pollfd object at the
+// specified index.
+void PollfdQueue::repollin(size_t index)
+{
+    m_pollfd_array[ index ].events |= POLLIN;
+}
+
 // HasReachedCapacity: Checks if the PollfdQueue has reached its maximum
 // capacity. Returns true if the size equals the capacity, indicating that no
 // more pollfd objects can be added.
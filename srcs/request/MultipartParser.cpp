@@ -0,0 +1,363 @@
+#include "../../includes/request/MultipartParser.hpp"
+#include "../../includes/constants/HttpStatusCodeHelper.hpp"
+#include "../../includes/exception/WebservExceptions.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * MultipartParser.cpp
+ *
+ * Parses a multipart/form-data body as it arrives, one read at a time.
+ *
+ */
+
+// Constructor
+MultipartParser::MultipartParser()
+    : m_stage(MULTIPART_IDLE), m_max_field_size(0), m_field_size(0),
+      m_file_descriptor(-1),
+      m_carriage_return_scanner("\r")
+{
+}
+
+// Destructor, removes the temporary files not renamed
+MultipartParser::~MultipartParser() { this->m_removeFiles(); }
+
+// Forget the body, so that the parser can be reused for another request
+void MultipartParser::reset()
+{
+    this->m_removeFiles();
+    m_stage = MULTIPART_IDLE;
+    m_delimiter.clear();
+    m_temporary_directory.clear();
+    m_max_field_size = 0;
+    m_field_size = 0;
+    m_pending.clear();
+    m_part = BodyParameter();
+    m_files.clear();
+}
+
+// Start parsing a body with a boundary, writing files to a temporary
+// directory and keeping at most max_field_size bytes of form fields
+void MultipartParser::begin(const std::string &boundary,
+                            const std::string &temporary_directory,
+                            size_t max_field_size)
+{
+    m_delimiter = "\r\n--" + boundary;
+    m_temporary_directory = temporary_directory;
+    if (m_temporary_directory.empty() ||
+        m_temporary_directory[ m_temporary_directory.size() - 1 ] != '/')
+        m_temporary_directory += "/";
+    m_max_field_size = max_field_size;
+
+    // The first boundary may start the body, without the CRLF ending the
+    // preamble
+    m_pending.assign(m_delimiter.begin(), m_delimiter.begin() + 2);
+    m_stage = MULTIPART_PREAMBLE;
+}
+
+// Parse the next bytes of the body
+void MultipartParser::feed(IRequest &request, const char *data, size_t size)
+{
+    // Parse the bytes in place when nothing was held back
+    if (m_pending.empty())
+    {
+        size_t bytes_parsed = m_parse(request, data, size);
+        m_pending.assign(data + bytes_parsed, data + size);
+        return;
+    }
+
+    // Otherwise parse them after the bytes held back
+    m_pending.insert(m_pending.end(), data, data + size);
+    size_t bytes_parsed = m_parse(request, m_pending.data(), m_pending.size());
+    m_pending.erase(m_pending.begin(), m_pending.begin() + bytes_parsed);
+}
+
+// Check if the parser was started
+bool MultipartParser::started() const { return m_stage != MULTIPART_IDLE; }
+
+// Check if the closing boundary was parsed
+bool MultipartParser::done() const { return m_stage == MULTIPART_DONE; }
+
+// Parse as many bytes as possible
+// Returns the number of bytes consumed, the rest must be parsed again with the
+// bytes of the next read
+size_t MultipartParser::m_parse(IRequest &request, const char *data,
+                                size_t size)
+{
+    const char *position = data;
+    const char *end = data + size;
+    while (position < end)
+    {
+        switch (m_stage)
+        {
+        case MULTIPART_PREAMBLE:
+        case MULTIPART_DATA:
+        {
+            // Everything before the boundary belongs to the part
+            const char *delimiter = m_findDelimiter(position, end);
+            if (m_stage == MULTIPART_DATA)
+                m_writePart(position, delimiter - position);
+
+            // Hold back the start of a boundary cut off by the end of the read
+            if (static_cast<size_t>(end - delimiter) < m_delimiter.size())
+                return delimiter - data;
+
+            // Close the part ended by the boundary
+            if (m_stage == MULTIPART_DATA)
+                m_finishPart(request);
+            position = delimiter + m_delimiter.size();
+            m_stage = MULTIPART_BOUNDARY_END;
+            break;
+        }
+        case MULTIPART_BOUNDARY_END:
+        {
+            // Wait for the two bytes following the boundary
+            if (end - position < 2)
+                return position - data;
+
+            // "--" closes the body, the epilogue is ignored
+            if (position[ 0 ] == '-' && position[ 1 ] == '-')
+            {
+                m_stage = MULTIPART_DONE;
+                request.setUploadRequest(true);
+                return size;
+            }
+
+            // CRLF starts the headers of the next part
+            if (position[ 0 ] != '\r' || position[ 1 ] != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid multipart boundary");
+            position += 2;
+            m_part = BodyParameter();
+            m_stage = MULTIPART_HEADERS;
+            break;
+        }
+        case MULTIPART_HEADERS:
+        {
+            // Wait for the whole header line
+            const char *line_end =
+                m_carriage_return_scanner.find(position, end);
+            if (line_end - position > MULTIPART_MAX_HEADER_LINE)
+                throw HttpStatusCodeException(REQUEST_HEADER_FIELDS_TOO_LARGE,
+                                              "Multipart header too large");
+            if (end - line_end < 2)
+                return position - data;
+            if (line_end[ 1 ] != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid multipart header line");
+
+            // An empty line ends the headers
+            if (line_end == position)
+            {
+                m_startPart();
+                m_stage = MULTIPART_DATA;
+            }
+            else
+                m_parseHeaderLine(std::string(position, line_end));
+            position = line_end + 2;
+            break;
+        }
+        default:
+            return size;
+        }
+    }
+    return size;
+}
+
+// Find the next boundary, the start of a boundary cut off by the end of the
+// data, or the end of the data
+const char *MultipartParser::m_findDelimiter(const char *begin,
+                                             const char *end) const
+{
+    // Jump from one CR to the next, the boundary starts with CRLF
+    for (const char *position = m_carriage_return_scanner.find(begin, end);
+         position != end;
+         position = m_carriage_return_scanner.find(position + 1, end))
+    {
+        size_t length = std::min(static_cast<size_t>(end - position),
+                                 m_delimiter.size());
+        if (memcmp(position, m_delimiter.data(), length) == 0)
+            return position;
+    }
+    return end;
+}
+
+// Parse a header line of the part
+void MultipartParser::m_parseHeaderLine(const std::string &line)
+{
+    std::string::size_type pos = line.find(':');
+    if (pos == std::string::npos)
+        throw HttpStatusCodeException(BAD_REQUEST,
+                                      "Invalid multipart header line");
+
+    // Extract and trim key and value
+    std::string key = m_trimWhitespace(line.substr(0, pos));
+    std::string value = m_trimWhitespace(line.substr(pos + 1));
+
+    // lower cases the key
+    std::transform(key.begin(), key.end(), key.begin(),
+                   static_cast<int (*)(int)>(std::tolower));
+
+    // Store the header in the map
+    m_part.headers[ key ] = value;
+
+    // Parse disposition_type, content_type, and field_name
+    if (key == "content-disposition")
+    {
+        // extract the disposition_type
+        pos = value.find(';');
+        m_part.disposition_type = m_trimWhitespace(value.substr(0, pos));
+        if (pos == std::string::npos)
+            return;
+
+        // extract the filename and field_name
+        std::string::size_type start = pos + 1;
+        while (start < value.size())
+        {
+            std::string::size_type token_end = value.find(';', start);
+            if (token_end == std::string::npos)
+                token_end = value.size();
+            std::string token = value.substr(start, token_end - start);
+            start = token_end + 1;
+
+            pos = token.find('=');
+            if (pos == std::string::npos)
+                continue;
+
+            // extract and trim the parameter and its value
+            std::string param = m_trimWhitespace(token.substr(0, pos));
+            std::string param_value = m_trimWhitespace(token.substr(pos + 1));
+
+            // Remove surrounding quotes if they exist
+            m_removeQuotes(param_value);
+
+            // Store the parameter
+            if (param == "filename")
+                m_part.filename = param_value;
+            else if (param == "name")
+                m_part.field_name = param_value;
+        }
+    }
+    else if (key == "content-type")
+        m_part.content_type = value;
+}
+
+// Open the temporary file of a file part, form fields stay in memory
+void MultipartParser::m_startPart()
+{
+    if (m_part.filename.empty())
+        return;
+
+    // Create a file with a unique name in the temporary directory
+    std::string path_template =
+        m_temporary_directory + MULTIPART_TEMPORARY_PREFIX + "XXXXXX";
+    std::vector<char> path(path_template.begin(), path_template.end());
+    path.push_back('\0');
+    m_file_descriptor = mkstemp(path.data());
+    if (m_file_descriptor == -1)
+        throw HttpStatusCodeException(INTERNAL_SERVER_ERROR,
+                                      "Failed to create upload file in " +
+                                          m_temporary_directory + ": " +
+                                          strerror(errno));
+
+    // Keep the file out of CGI processes, readable like any other upload
+    fcntl(m_file_descriptor, F_SETFD, FD_CLOEXEC);
+    fchmod(m_file_descriptor, 0644);
+
+    // Remember the file, so that it is removed if it is never renamed
+    struct stat file_stat;
+    fstat(m_file_descriptor, &file_stat);
+    m_part.file_path = path.data();
+    m_files.push_back(std::make_pair(m_part.file_path, file_stat.st_ino));
+}
+
+// Write data of the part to its file or to its parameter
+void MultipartParser::m_writePart(const char *data, size_t size)
+{
+    // Form fields are kept in memory, within their limit
+    if (m_file_descriptor == -1)
+    {
+        m_field_size += size;
+        if (m_field_size > m_max_field_size)
+            throw HttpStatusCodeException(PAYLOAD_TOO_LARGE,
+                                          "Multipart form fields too large");
+        m_part.data.insert(m_part.data.end(), data, data + size);
+        return;
+    }
+
+    // Files are written as they arrive
+    while (size > 0)
+    {
+        ssize_t bytes_written = write(m_file_descriptor, data, size);
+        if (bytes_written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw HttpStatusCodeException(INTERNAL_SERVER_ERROR,
+                                          "Failed to write upload file " +
+                                              m_part.file_path + ": " +
+                                              strerror(errno));
+        }
+        data += bytes_written;
+        size -= bytes_written;
+    }
+}
+
+// Close the part and hand it over to the request
+void MultipartParser::m_finishPart(IRequest &request)
+{
+    if (m_file_descriptor != -1)
+    {
+        close(m_file_descriptor);
+        m_file_descriptor = -1;
+    }
+    request.addBodyParameter(m_part);
+    m_part = BodyParameter();
+}
+
+// Close the file of an unfinished part and remove the temporary files not
+// renamed
+void MultipartParser::m_removeFiles()
+{
+    // Close the file of an unfinished part
+    if (m_file_descriptor != -1)
+        close(m_file_descriptor);
+    m_file_descriptor = -1;
+
+    // Remove the temporary files, unless they were renamed and their name
+    // reused by another upload since
+    for (size_t i = 0; i < m_files.size(); i++)
+    {
+        struct stat file_stat;
+        if (lstat(m_files[ i ].first.c_str(), &file_stat) == 0 &&
+            file_stat.st_ino == m_files[ i ].second)
+            unlink(m_files[ i ].first.c_str());
+    }
+}
+
+// Trim leading and trailing whitespace from a string
+std::string MultipartParser::m_trimWhitespace(const std::string &string)
+{
+    size_t start = string.find_first_not_of(" \t");
+    if (start == std::string::npos)
+        return std::string();
+    size_t end = string.find_last_not_of(" \t");
+    return string.substr(start, end - start + 1);
+}
+
+// Remove quotes from a string
+void MultipartParser::m_removeQuotes(std::string &string)
+{
+    if (string.length() >= 2 && string.at(0) == '"' &&
+        string.at(string.length() - 1) == '"')
+        string = string.substr(1, string.length() - 2);
+}
+
+// Path: srcs/request/MultipartParser.cpp
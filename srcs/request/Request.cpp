@@ -1,5 +1,7 @@
 #include "../../includes/request/Request.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
+#include <cstring>
+#include <unistd.h>
 
 /*
  * Request: Represents an HTTP request.
@@ -36,9 +38,12 @@
 // Constructor initializes the Request object with a HttpHelper and a
 // IConfiguration object
 Request::Request(const IConfiguration &configuration,
-                 const HttpHelper &httpHelper)
-    : m_configuration(configuration), m_http_helper(httpHelper),
-      m_body_file_path("")
+                 const HttpHelper &httpHelper, const IClock &clock)
+    : m_method(GET), m_http_version(HTTP_1_1),
+      m_headers(std::less<HttpHeader>(), &m_arena),
+      m_cookies(ArenaStringLess(), &m_arena), m_configuration(configuration),
+      m_http_helper(httpHelper), m_clock(clock), m_start_time(0),
+      m_body_file_path(""), m_body_file_descriptor(-1)
 {
 }
 
@@ -52,25 +57,82 @@ Request &Request::operator=(const Request &src)
     m_method = src.m_method;
     m_uri = src.m_uri;
     m_http_version = src.m_http_version;
-    m_headers = src.m_headers;
     m_body = src.m_body;
+
+    // Copy the header values into the arena of this request
+    m_headers.clear();
+    for (HeaderMap_t::const_iterator it = src.m_headers.begin();
+         it != src.m_headers.end(); ++it)
+        m_headers.insert(std::make_pair(
+            it->first, m_arena.copy(it->second.data, it->second.size)));
     return *this;
 }
 
 // Copy constructor
 Request::Request(const Request &src)
-    : m_configuration(src.m_configuration), m_http_helper(src.m_http_helper)
+    : m_headers(std::less<HttpHeader>(), &m_arena),
+      m_cookies(ArenaStringLess(), &m_arena),
+      m_configuration(src.m_configuration), m_http_helper(src.m_http_helper),
+      m_clock(src.m_clock), m_start_time(src.m_start_time),
+      m_body_file_descriptor(-1)
 {
     // Copy constructor for copying the contents of another Request object
     *this = src; // Use the assignment operator to copy the contents
 }
 
 // Destructor
-Request::~Request()
+Request::~Request() { this->m_removeBodyFile(); }
+
+// Forget the request, so that it can be reused for the next one
+// The buffers keep their capacity, up to REQUEST_RETAINED_CAPACITY
+void Request::reset()
+{
+    m_method = GET;
+    m_uri.clear();
+    m_http_version = HTTP_1_1;
+    m_headers.clear();
+    m_clearBuffer(m_body);
+    m_clearBuffer(m_buffer);
+    m_host_name.clear();
+    m_host_port.clear();
+    m_authority.clear();
+    m_query_parameters.clear();
+    m_remote_address = std::pair<std::string, std::string>();
+    m_cookies.clear();
+    m_body_parameters.clear();
+    m_upload_request = false;
+    m_request_id.clear();
+    m_raw_request.clear();
+    m_state.reset();
+    m_start_time = 0;
+    this->m_removeBodyFile();
+    m_multipart_parser.reset();
+
+    // Nothing draws from the arena anymore
+    m_arena.reset();
+}
+
+// Empty a buffer, freeing it if it grew past the retained capacity
+void Request::m_clearBuffer(std::vector<char> &buffer)
+{
+    if (buffer.capacity() > REQUEST_RETAINED_CAPACITY)
+        std::vector<char>().swap(buffer);
+    else
+        buffer.clear();
+}
+
+// Close and remove the body file
+void Request::m_removeBodyFile()
 {
+    // Close a body file still being written
+    if (m_body_file_descriptor != -1)
+        close(m_body_file_descriptor);
+    m_body_file_descriptor = -1;
+
     // If a body file path was set, delete the file
     if (!m_body_file_path.empty())
         remove(m_body_file_path.c_str());
+    m_body_file_path.clear();
 }
 
 // Getter function for retrieving the HTTP method of the request
@@ -97,20 +159,23 @@ std::string Request::getHttpVersionString() const
 // Getter function for retrieving the headers of the request
 const std::map<HttpHeader, std::string> Request::getHeaders() const
 {
-    return m_headers;
+    std::map<HttpHeader, std::string> headers;
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
+         it != m_headers.end(); ++it)
+        headers[ it->first ] = it->second.str();
+    return headers;
 }
 
 // Getter function for retrieving the headers of the request as string-keyed map
 std::map<std::string, std::string> Request::getHeadersStringMap() const
 {
     std::map<std::string, std::string> headers_strings;
-    for (std::map<HttpHeader, std::string>::const_iterator it =
-             m_headers.begin();
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
          it != m_headers.end(); ++it)
     {
         // Convert enum keys to string keys and copy values
         headers_strings[ m_http_helper.httpHeaderStringMap(it->first) ] =
-            it->second;
+            it->second.str();
     }
     return headers_strings;
 }
@@ -124,15 +189,21 @@ std::map<std::string, std::string> Request::getQueryParameters() const
 // Getter function for retrieving all the cookies
 std::map<std::string, std::string> Request::getCookies() const
 {
-    return m_cookies;
+    std::map<std::string, std::string> cookies;
+    for (CookieMap_t::const_iterator it = m_cookies.begin();
+         it != m_cookies.end(); ++it)
+        cookies[ it->first.str() ] = it->second.str();
+    return cookies;
 }
 
 // Getter function for retrieving a specific cookie
 std::string Request::getCookie(const std::string &key) const
 {
-    // Check if the cookie exists
-    if (m_cookies.find(key) != m_cookies.end())
-        return m_cookies.at(key); // Return the value of the cookie
+    // Check if the cookie exists, looking the key up in place
+    ArenaString name = {key.data(), key.size()};
+    CookieMap_t::const_iterator it = m_cookies.find(name);
+    if (it != m_cookies.end())
+        return it->second.str(); // Return the value of the cookie
     else
         return ""; // Return an empty string if the cookie does not exist
 }
@@ -141,12 +212,22 @@ std::string Request::getCookie(const std::string &key) const
 std::string Request::getHeaderValue(HttpHeader header) const
 {
     // Check if the header exists in the map
-    if (m_headers.find(header) != m_headers.end())
-        return m_headers.at(header); // Return the value of the header
+    HeaderMap_t::const_iterator it = m_headers.find(header);
+    if (it != m_headers.end())
+        return it->second.str(); // Return the value of the header
     else
         return ""; // Return an empty string if the header does not exist
 }
 
+// Append the value of a specific header to a string, without copying it to
+// a string of its own, nothing being appended if the header does not exist
+void Request::appendHeaderValue(HttpHeader header, std::string &string) const
+{
+    HeaderMap_t::const_iterator it = m_headers.find(header);
+    if (it != m_headers.end())
+        string.append(it->second.data, it->second.size);
+}
+
 // Getter function for retrieving the body of the request
 const std::vector<char> Request::getBody() const { return m_body; }
 
@@ -182,7 +263,7 @@ std::string Request::getContentLength() const
     if (m_headers.find(CONTENT_LENGTH) != m_headers.end())
     {
         // Return the value of the 'content-length' header
-        return m_headers.at(CONTENT_LENGTH);
+        return m_headers.at(CONTENT_LENGTH).str();
     }
     else
     {
@@ -198,7 +279,7 @@ std::string Request::getContentType() const
     if (m_headers.find(CONTENT_TYPE) != m_headers.end())
     {
         // Return the value of the 'content-type' header
-        return m_headers.at(CONTENT_TYPE);
+        return m_headers.at(CONTENT_TYPE).str();
     }
     else
     {
@@ -242,7 +323,7 @@ std::string Request::getClientIp() const
     if (m_headers.find(X_FORWARDED_FOR) != m_headers.end())
     {
         // Return the value of the 'X-Forwarded-For' header
-        return m_headers.at(X_FORWARDED_FOR);
+        return m_headers.at(X_FORWARDED_FOR).str();
     }
     else
     {
@@ -269,6 +350,19 @@ const std::vector<BodyParameter> &Request::getBodyParameters() const
 // Getter function for retrieving the body file path
 std::string Request::getBodyFilePath() const { return m_body_file_path; }
 
+// Getter function for retrieving the body file descriptor
+int Request::getBodyFileDescriptor() const { return m_body_file_descriptor; }
+
+// Getter function for the parser streaming a multipart body
+MultipartParser &Request::getMultipartParser() { return m_multipart_parser; }
+
+// Getter function for the arena of the request, for allocations that live as
+// long as the request
+Arena &Request::getArena() const { return m_arena; }
+
+// Get the time the first bytes of the request were buffered, in microseconds
+uint64_t Request::getStartTime() const { return m_start_time; }
+
 // Getter function for checking if the request is an upload request
 bool Request::isUploadRequest() const { return m_upload_request; }
 
@@ -325,6 +419,13 @@ void Request::setHttpVersion(const std::string &httpVersion)
 
 // Function for adding a header to the request
 void Request::addHeader(const std::string &key, const std::string &value)
+{
+    this->addHeader(key, value.data(), value.size());
+}
+
+// Function for adding a header to the request, its value being copied into
+// the arena
+void Request::addHeader(const std::string &key, const char *value, size_t size)
 {
     // Check if the key contains trailing whitespace
     if (!key.empty() &&
@@ -347,8 +448,13 @@ void Request::addHeader(const std::string &key, const std::string &value)
     try
     {
         name = m_http_helper.stringHttpHeaderMap(lowercase_key);
-        // Add the header to the internal headers map
-        m_headers[ name ] = value;
+        // Add the header to the internal headers map, the last one winning
+        ArenaString arena_value = m_arena.copy(value, size);
+        HeaderMap_t::iterator it = m_headers.find(name);
+        if (it != m_headers.end())
+            it->second = arena_value;
+        else
+            m_headers.insert(std::make_pair(name, arena_value));
     }
     catch (const UnknownHeaderError &e)
     {
@@ -388,33 +494,51 @@ void Request::addBodyChar(char value) { m_body.push_back(value); }
 // Function for adding a cookie to the request
 void Request::addCookie(const std::string &key, const std::string &value)
 {
-    // Add the cookie to the internal cookies map
-    m_cookies[ key ] = value;
+    this->addCookie(key.data(), key.size(), value.data(), value.size());
+}
+
+// Function for adding a cookie to the request, its name and value being
+// copied into the arena
+void Request::addCookie(const char *key, size_t key_size, const char *value,
+                        size_t value_size)
+{
+    // Add the cookie to the internal cookies map, the last one winning
+    ArenaString name = {key, key_size};
+    ArenaString arena_value = m_arena.copy(value, value_size);
+    CookieMap_t::iterator it = m_cookies.find(name);
+    if (it != m_cookies.end())
+        it->second = arena_value;
+    else
+        m_cookies.insert(
+            std::make_pair(m_arena.copy(key, key_size), arena_value));
 }
 #include <iostream>
 // Setter function for setting the authority of the request
 void Request::setAuthority()
 {
     // Check if the 'Host' header exists in the map
-    if (m_headers[ HOST ] == "")
+    HeaderMap_t::const_iterator host = m_headers.find(HOST);
+    if (host == m_headers.end() || host->second.size == 0)
         throw HttpStatusCodeException(BAD_REQUEST, // Throw '400' status error
                                       "missing Host header");
-    std::istringstream host_stream(m_headers[ HOST ]);
-    if (std::getline(host_stream, m_host_name, ':'))
+
+    // Split the host name from the port, in place
+    const char *begin = host->second.data;
+    const char *end = begin + host->second.size;
+    const char *colon =
+        static_cast<const char *>(memchr(begin, ':', end - begin));
+    m_host_name.assign(begin, colon != NULL ? colon : end);
+    if (colon != NULL)
     {
         // If the host header contains a port number, set the host port
-        std::getline(host_stream, m_host_port);
-    }
-    else
-    {
-        // If the host header does not contain a port number, set the host port
-        // to the default port
-        m_host_port = m_configuration.getString("default_port");
+        m_host_port.assign(colon + 1, end);
     }
+    // If the host header does not contain a port number, set the host port
+    // to the default port
     if (m_host_port.empty())
         m_host_port = m_configuration.getString("default_port");
-    // Set the authority of the request
-    m_authority = m_host_name + ":" + m_host_port;
+    // Set the authority of the request, in the capacity kept across requests
+    m_authority.assign(m_host_name).append(1, ':').append(m_host_port);
 }
 
 // Function for adding a body parameter to the request
@@ -440,6 +564,9 @@ void Request::appendBody(std::vector<char>::const_iterator start,
 // Method to append new date to the buffer
 void Request::appendBuffer(const std::vector<char> &raw_request)
 {
+    // The request starts with its first bytes
+    if (m_start_time == 0 && !raw_request.empty())
+        m_start_time = m_clock.getMicroseconds();
     m_buffer.insert(m_buffer.end(), raw_request.begin(), raw_request.end());
 }
 
@@ -471,4 +598,10 @@ void Request::setBodyFilePath(const std::string &body_file_path)
     m_body_file_path = body_file_path;
 }
 
+// Setter function for setting the body file descriptor
+void Request::setBodyFileDescriptor(int body_file_descriptor)
+{
+    m_body_file_descriptor = body_file_descriptor;
+}
+
 // path: srcs/request/Request.cpp
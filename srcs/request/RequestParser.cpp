@@ -3,9 +3,11 @@
 #include "../../includes/exception/WebservExceptions.hpp"
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <unistd.h>
 
 /*
  * RequestParser.cpp
@@ -21,289 +23,271 @@
 // Constructor to initialize the RequestParser with required references
 RequestParser::RequestParser(const IConfiguration &configuration,
                              ILogger &logger)
-    : m_logger(logger), m_configuration(configuration)
+    : m_logger(logger), m_configuration(configuration),
+      m_request_line_scanner(" \r\n"), m_header_name_scanner(":\r\n", true),
+      m_line_end_scanner("\r\n"),
+      m_client_header_buffer_size(
+          configuration.getSize_t("client_header_buffer_size")),
+      m_client_max_uri_size(configuration.getSize_t("client_max_uri_size")),
+      m_head_limit(configuration.getSize_t("large_client_header_buffers", 0) *
+                   configuration.getSize_t("large_client_header_buffers", 1)),
+      m_client_body_buffer_size(
+          configuration.getSize_t("client_body_buffer_size")),
+      m_client_body_temp_path(configuration.getString("client_body_temp_path"))
 {
+    // Log the delimiter scanning implementation picked for this CPU
+    LOG(m_logger, VERBOSE, std::string("[REQUESTPARSER] Delimiter scanning: ") +
+                           DelimiterScanner::implementation());
 }
 
-void RequestParser::parseRequest(IRequest &request) const
-{
-    const std::vector<char> buffer = request.getBuffer();
-    std::vector<char>::const_iterator it = buffer.begin();
-
-    // Parse the request line
-    m_parseRequestLine(it, buffer, request);
-
-    // Check for whitespace between request-line and first header field
-    if (m_isWhitespace(*it))
-    {
-        // throw '400' status error
-        throw HttpStatusCodeException(
-            BAD_REQUEST,
-            "whitespace between the start-line and the first header field");
-    }
-
-    // Check if either content-length or transfer-encoding is present
-    m_parseHeaders(it, buffer, request);
-    std::string content_length_string = request.getHeaderValue(CONTENT_LENGTH);
-    if (content_length_string.empty() &&
-        request.getHeaderValue(TRANSFER_ENCODING) != "chunked")
-    {
-        // Log the error
-        m_logger.log(DEBUG, "\t[REQUESTPARSER] Content-Length is empty");
-
-        // Commenting this to allow invalid 42 tester program
-        // throw '411' status error
-        // throw HttpStatusCodeException(LENGTH_REQUIRED,
-        //                              "no content-length header found");
-    }
-
-    // Remove the headers from the buffer
-    request.trimBuffer(it - buffer.begin());
-
-    // Assign the content length to the request state
-    request.getState().setContentLength(atoi(content_length_string.c_str()));
-
-    // Continue by parsing the body
-    this->parseBody(request);
-}
-
-// Function to parse the request line of an HTTP request
-void RequestParser::m_parseRequestLine(
-    std::vector<char>::const_iterator &request_iterator,
-    const std::vector<char> &buffer, IRequest &parsed_request) const
-{
-    // Parse method, URI, and HTTP version
-    std::string method = m_parseMethod(request_iterator, buffer);
-    std::string uri = m_parseUri(request_iterator, buffer);
-    std::string http_version = m_parseHttpVersion(request_iterator, buffer);
-
-    // Set method, URI, and HTTP version in the parsed request
-    parsed_request.setMethod(method);
-    parsed_request.setUri(uri);
-    parsed_request.setHttpVersion(http_version);
-}
-
-// Function to parse the HTTP method from the request line
-std::string RequestParser::m_parseMethod(
-    std::vector<char>::const_iterator &request_iterator,
-    const std::vector<char> &buffer) const
+// Function to scan the request head as bytes arrive, resuming where the
+// previous call stopped
+// Returns true once the empty line ending the head is reached
+bool RequestParser::parseHead(IRequest &request) const
 {
-    std::string method;
-    // Skip leading CRLF
-    while (buffer.end() - request_iterator >= 2 && m_isCRLF(request_iterator))
-    {
-        request_iterator += 2;
-    }
-
-    // Build 'method' string until space is found
-    while (request_iterator != buffer.end() && *request_iterator != ' ')
-    {
-        method += *request_iterator;
-        ++request_iterator;
-    }
-
-    // Check for unexpected end of request
-    /*     if (request_iterator == buffer.end())
+    const std::vector<char> &buffer = request.getBuffer();
+    HeadParsingState &head = request.getState().getHead();
+
+    // Scan the bytes not seen yet
+    // The head as a whole, leading empty lines included, must fit in
+    // large_client_header_buffers: the bytes past it are not scanned
+    const char *data = buffer.data();
+    size_t size = std::min(buffer.size(), m_head_limit);
+    for (size_t i = head.offset; i < size; i++)
+    {
+        // Skip optional whitespace before a header value
+        if (head.stage == HEAD_HEADER_VALUE && i == head.token_start &&
+            (data[ i ] == ' ' || data[ i ] == '\t'))
         {
-            throw HttpStatusCodeException(
-                BAD_REQUEST,
-                "Unexpected end of request while parsing method"); // throw
-       '400' status error
-        } */
-
-    // Move marker to next character
-    ++request_iterator;
-
-    // Log 'method'
-    m_logger.log(VERBOSE, "[REQUESTPARSER] Method: \"" + method + "\"");
+            head.token_start++;
+            continue;
+        }
 
-    // Return 'method' string
-    return method;
-}
+        // Jump over the bytes that can not end the token being scanned
+        const DelimiterScanner *scanner = m_getHeadScanner(head.stage);
+        if (scanner != NULL)
+            i = scanner->find(data + i, data + size) - data;
+
+        // Check the limits, a head trickling in can not grow past them
+        if (head.stage == HEAD_URI &&
+            i - head.token_start > m_client_max_uri_size)
+            throw HttpStatusCodeException(URI_TOO_LONG);
+        if ((head.stage == HEAD_HEADER_NAME ||
+             head.stage == HEAD_HEADER_VALUE) &&
+            i - head.line_start > m_client_header_buffer_size)
+            throw HttpStatusCodeException(REQUEST_HEADER_FIELDS_TOO_LARGE,
+                                          "Header fields too large");
+        if (i == size)
+            break;
 
-// Function to parse the URI from the request line
-std::string
-RequestParser::m_parseUri(std::vector<char>::const_iterator &request_iterator,
-                          const std::vector<char> &buffer) const
-{
-    std::string uri;
+        char c = data[ i ];
+        switch (head.stage)
+        {
+        case HEAD_LEADING_CRLF:
+            // Skip leading CRLF
+            if (c == '\r' || c == '\n')
+                break;
+            if (c == ' ')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "whitespace before the method");
+            head.line_start = i;
+            head.token_start = i;
+            head.stage = HEAD_METHOD;
+            break;
 
-    // Build 'uri' string until space is found
-    while (request_iterator != buffer.end() && *request_iterator != ' ')
-    {
-        uri += *request_iterator;
-        ++request_iterator;
-    }
+        case HEAD_METHOD:
+            // Method ends on a space
+            if (c == ' ')
+            {
+                head.method = m_span(head.token_start, i);
+                head.token_start = i + 1;
+                head.stage = HEAD_URI;
+            }
+            else if (c == '\r' || c == '\n')
+                throw HttpStatusCodeException(
+                    BAD_REQUEST, "Unexpected end of line while parsing method");
+            break;
 
-    // Check for unexpected end of request
-    // if (request_iterator == buffer.end())
-    // {
-    //     throw HttpStatusCodeException(
-    //         BAD_REQUEST,
-    //         "Unexpected end of request"); // throw '400' status error
-    // }
+        case HEAD_URI:
+            // URI ends on a space
+            if (c == ' ')
+            {
+                head.uri = m_span(head.token_start, i);
+                head.token_start = i + 1;
+                head.stage = HEAD_HTTP_VERSION;
+            }
+            else if (c == '\r' || c == '\n')
+                throw HttpStatusCodeException(
+                    BAD_REQUEST, "Unexpected end of line while parsing URI");
+            break;
 
-    // Move marker to next character
-    ++request_iterator;
+        case HEAD_HTTP_VERSION:
+            // HTTP version ends on CRLF
+            if (c == '\r')
+            {
+                head.http_version = m_span(head.token_start, i);
+                head.stage = HEAD_REQUEST_LINE_LF;
+            }
+            else if (c == '\n')
+                throw HttpStatusCodeException(
+                    BAD_REQUEST, "Invalid characters in HTTP version");
+            break;
 
-    // Log 'uri'
-    m_logger.log(VERBOSE, "[REQUESTPARSER] URI: \"" + uri + "\"");
+        case HEAD_REQUEST_LINE_LF:
+        case HEAD_HEADER_LF:
+            // Line must end with CRLF
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "CR not followed by LF");
+            head.stage = HEAD_HEADER_START;
+            break;
 
-    // Return 'uri' string
-    return uri;
-}
+        case HEAD_HEADER_START:
+            // Empty line ends the head
+            if (c == '\r')
+                head.stage = HEAD_END_LF;
+            else if (c == '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid characters in header");
+            else if (c == ' ' || c == '\t')
+                throw HttpStatusCodeException(
+                    BAD_REQUEST, head.headers.empty()
+                                     ? "whitespace between the start-line and "
+                                       "the first header field"
+                                     : "obsolete header line folding");
+            else
+            {
+                head.line_start = i;
+                head.token_start = i;
+                head.stage = HEAD_HEADER_NAME;
+            }
+            break;
 
-// Function to parse the HTTP version from the request line
-std::string RequestParser::m_parseHttpVersion(
-    std::vector<char>::const_iterator &request_iterator,
-    const std::vector<char> &buffer) const
-{
-    std::string http_version;
+        case HEAD_HEADER_NAME:
+            // Header name ends on a colon
+            if (c == ':')
+            {
+                head.header_name = m_span(head.token_start, i);
+                head.token_start = i + 1;
+                head.stage = HEAD_HEADER_VALUE;
+            }
+            else if (c == '\r' || c == '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Colon not found in header");
+            break;
 
-    // Build 'http_version' string
-    while (request_iterator != buffer.end())
-    {
-        // End of 'http_version' string, break loop
-        if (m_isCRLF(request_iterator))
+        case HEAD_HEADER_VALUE:
+            // Header value ends on CRLF, without its surrounding whitespace
+            if (c == '\r')
+            {
+                size_t end = i;
+                while (end > head.token_start &&
+                       (buffer[ end - 1 ] == ' ' || buffer[ end - 1 ] == '\t'))
+                    end--;
+                head.headers.push_back(std::make_pair(
+                    head.header_name, m_span(head.token_start, end)));
+                head.stage = HEAD_HEADER_LF;
+            }
+            else if (c == '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid characters in header");
             break;
 
-        // Check for invalid characters
-        if (m_isCharInSet(request_iterator, "\r\n"))
-        {
-            throw HttpStatusCodeException(
-                BAD_REQUEST,
-                "Invalid characters in HTTP version"); // throw '400' status
-                                                       // error
+        case HEAD_END_LF:
+            // Head must end with CRLF CRLF
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "CR not followed by LF");
+            head.offset = i + 1;
+            head.stage = HEAD_DONE;
+            return true;
+
+        case HEAD_DONE:
+            return true;
         }
-
-        // Append character to 'http_version' string
-        http_version += *request_iterator;
-        ++request_iterator;
     }
 
-    // Check for unexpected end of request
-    // if (request_iterator == buffer.end())
-    // {
-    //     throw HttpStatusCodeException(
-    //         BAD_REQUEST,
-    //         "Unexpected end of request"); // throw '400' status error
-    // }
-
-    // Move marker passed CRLF
-    request_iterator += 2;
-
-    // Log 'http_version'
-    m_logger.log(VERBOSE,
-                 "[REQUESTPARSER] HTTP Version: \"" + http_version + "\"");
+    // A head still unfinished at the limit is too large
+    if (size == m_head_limit)
+        throw HttpStatusCodeException(REQUEST_HEADER_FIELDS_TOO_LARGE,
+                                      "Request head too large");
 
-    // Return 'http_version' string
-    return http_version;
+    // Remember where to resume once more bytes arrive
+    head.offset = size;
+    return head.stage == HEAD_DONE;
 }
 
-// Function to parse the headers of an HTTP request
-void RequestParser::m_parseHeaders(
-    std::vector<char>::const_iterator &request_iterator,
-    const std::vector<char> &buffer, IRequest &parsed_request) const
+// Function to fill the request from the head scanned by parseHead
+void RequestParser::parseRequest(IRequest &request) const
 {
-    // Parse headers
-    while (request_iterator != buffer.end())
-    {
-        // End of headers, break loop
-        if (m_isCRLF(request_iterator))
-            break;
-        // Check for invalid characters
-        if (m_isCharInSet(request_iterator, "\r\n"))
-        {
-            throw HttpStatusCodeException(BAD_REQUEST,
-                                          "Invalid characters in header");
-        }
+    const std::vector<char> &buffer = request.getBuffer();
+    HeadParsingState &head = request.getState().getHead();
 
-        // Parse individual header
-        m_parseHeader(request_iterator, buffer, parsed_request);
+    // Set method, URI, and HTTP version in the parsed request
+    std::string method = m_spanString(buffer, head.method);
+    std::string uri = m_spanString(buffer, head.uri);
+    std::string http_version = m_spanString(buffer, head.http_version);
+    LOG(m_logger, VERBOSE, "[REQUESTPARSER] Method: \"" + method + "\"");
+    LOG(m_logger, VERBOSE, "[REQUESTPARSER] URI: \"" + uri + "\"");
+    LOG(m_logger, VERBOSE, "[REQUESTPARSER] HTTP Version: \"" + http_version +
+                           "\"");
+    request.setMethod(method);
+    request.setUri(uri);
+    request.setHttpVersion(http_version);
+
+    // Add the headers
+    for (size_t i = 0; i < head.headers.size(); i++)
+    {
+        std::string header_name =
+            m_spanString(buffer, head.headers[ i ].first);
+        const BufferSpan &value = head.headers[ i ].second;
+        for (size_t j = 0; j < header_name.size(); j++)
+            header_name[ j ] = std::tolower(header_name[ j ]);
+        m_addHeader(header_name, buffer.data() + value.start, value.length,
+                    request);
     }
 
-    // Check for unexpected end of request
-    // if (request_iterator == buffer.end())
-    // {
-    //     throw HttpStatusCodeException(BAD_REQUEST, "Unexpected end of
-    //     request");
-    // }
-
     // Set authority in parsed request
-    parsed_request.setAuthority();
-
-    // Move marker passed CRLF
-    request_iterator += 2;
-}
-
-// Function to parse an individual header
-void RequestParser::m_parseHeader(
-    std::vector<char>::const_iterator &request_iterator,
-    const std::vector<char> &buffer, IRequest &parsed_request) const
-{
-    // Parse header name and value
-    std::string header_name;
-    std::string header_value;
+    request.setAuthority();
 
-    // Set start value for client header buffer size
-    int client_header_buffer_size =
-        m_configuration.getInt("client_header_buffer_size");
-
-    // Find colon to separate header name and value
-    while (request_iterator != buffer.end() && *request_iterator != ':')
-    {
-        header_name += std::tolower(*request_iterator); // Convert to lowercase
-        client_header_buffer_size--;
-        ++request_iterator;
-    }
-
-    // Check if colon was found
-    if (request_iterator == buffer.end())
+    // Check if either content-length or transfer-encoding is present
+    std::string content_length_string = request.getHeaderValue(CONTENT_LENGTH);
+    if (content_length_string.empty() &&
+        request.getHeaderValue(TRANSFER_ENCODING) != "chunked")
     {
-        throw HttpStatusCodeException(BAD_REQUEST, "Colon not found in header");
-    }
-
-    // Skip colon
-    ++request_iterator;
+        // Log the error
+        LOG(m_logger, DEBUG, "\t[REQUESTPARSER] Content-Length is empty");
 
-    // Skip optional space
-    if (request_iterator != buffer.end() && *request_iterator == ' ')
-    {
-        ++request_iterator;
+        // Commenting this to allow invalid 42 tester program
+        // throw '411' status error
+        // throw HttpStatusCodeException(LENGTH_REQUIRED,
+        //                              "no content-length header found");
     }
 
-    // Find end of header value
-    while (request_iterator != buffer.end() && !m_isCRLF(request_iterator))
-    {
-        header_value += *request_iterator;
-        client_header_buffer_size--;
-        ++request_iterator;
-    }
+    // Remove the head from the buffer
+    request.trimBuffer(head.offset);
 
-    // Check for unexpected end of request
-    // if (request_iterator == buffer.end())
-    // {
-    //     throw HttpStatusCodeException(BAD_REQUEST, "Unexpected end of
-    //     request");
-    // }
-    // Check if header size exceeds client header buffer size
-    if (client_header_buffer_size < 0)
-    {
-        throw HttpStatusCodeException(REQUEST_HEADER_FIELDS_TOO_LARGE,
-                                      "Header fields too large");
-    }
-
-    // Move marker passed CRLF
-    request_iterator += 2;
+    // Assign the content length to the request state
+    request.getState().setContentLength(atoi(content_length_string.c_str()));
+}
 
+// Function to add an individual header, its value staying in the buffer
+// until the request copies it into its arena
+void RequestParser::m_addHeader(const std::string &header_name,
+                                const char *header_value,
+                                size_t header_value_size,
+                                IRequest &parsed_request) const
+{
     // Log header
-    m_logger.log(VERBOSE, "[REQUESTPARSER] Header: \"" + header_name + ": " +
-                              header_value + "\"");
+    LOG(m_logger, VERBOSE, "[REQUESTPARSER] Header: \"" + header_name + ": " +
+                           std::string(header_value, header_value_size) +
+                           "\"");
 
     // Add header to parsed request
     try
     {
-        parsed_request.addHeader(header_name, header_value);
+        parsed_request.addHeader(header_name, header_value,
+                                 header_value_size);
     }
     catch (const UnknownHeaderError &e)
     {
@@ -314,7 +298,7 @@ void RequestParser::m_parseHeader(
     // Parse cookies
     if (header_name == "cookie")
     {
-        m_parseCookie(header_value, parsed_request);
+        m_parseCookie(header_value, header_value_size, parsed_request);
     }
 }
 
@@ -334,6 +318,11 @@ void RequestParser::parseBody(IRequest &parsed_request) const
         state.finished(true);
         return; // No need to parse body for other methods
     }
+
+    // Stream a multipart upload to the root of its route
+    if (state.getContentRed() == 0)
+        m_startMultipart(parsed_request);
+
     // Check if 'Transfer-Encoding' is chunked
     std::string transfer_encoding =
         parsed_request.getHeaderValue(TRANSFER_ENCODING);
@@ -350,7 +339,7 @@ void RequestParser::parseBody(IRequest &parsed_request) const
     if (content_length_string.empty() &&
         parsed_request.getHeaderValue(TRANSFER_ENCODING) != "chunked")
     {
-        m_logger.log(DEBUG, "\t\t[REQUESTPARSER] Content-Length is empty");
+        LOG(m_logger, DEBUG, "\t\t[REQUESTPARSER] Content-Length is empty");
         // throw '411' status error
         throw HttpStatusCodeException(LENGTH_REQUIRED,
                                       "no content-length header found");
@@ -367,16 +356,10 @@ void RequestParser::parseBody(IRequest &parsed_request) const
                              content_length_string + ")");
     }
 
-    state.setContentRed(state.getContentRed() + buffer.size());
-    // m_logger.log(DEBUG, "Cuurent content red: " +
-    // Converter::toString(state.getContentRed()));
-    // Check if body size exceeds client body buffer size
-    if (static_cast<size_t>(state.getContentRed()) >
-        m_configuration.getSize_t("client_body_buffer_size"))
-    {
-        // throw '413' status error
-        throw HttpStatusCodeException(PAYLOAD_TOO_LARGE);
-    }
+    // Only take the bytes of this body, the rest belongs to the next request
+    size_t body_bytes =
+        std::min(buffer.size(), body_size - state.getContentRed());
+
     // Check if body size exceeds remaining request size
     // size_t remaining_request_size = buffer.end() - request_iterator;
     // if (remaining_request_size < body_size)
@@ -388,300 +371,361 @@ void RequestParser::parseBody(IRequest &parsed_request) const
 
     // Extract body
     // std::vector<char> body(request_iterator, request_iterator + body_size);
-    parsed_request.appendBody(buffer.begin(), buffer.end());
+    m_appendBody(parsed_request, buffer.begin(), buffer.begin() + body_bytes);
+
+    // remove the body data from the buffer - it was used to store incomplete
+    // headers and possibly some body data, followed by pipelined requests
+    parsed_request.trimBuffer(body_bytes);
 
     // set the request state to finished once all the content has been red.
     if (static_cast<size_t>(state.getContentRed()) == body_size)
-    {
-        state.finished(true);
-        this->parseBodyParameters(parsed_request);
-    }
-
-    // clear the buffer - it was used to store incomplete headers and possibly
-    // some body data
-    parsed_request.clearBuffer();
+        m_finishBody(parsed_request);
 
     // Set body in parsed request
     // parsed_request.setBody(body);
 }
 
-// Function to unchunk the body of an HTTP request
-void RequestParser::m_unchunkBody(const std::vector<char> &buffer,
-                                  IRequest &request) const
+// Function to start streaming a multipart body for a route that is not CGI,
+// form fields are kept in memory and files written to client_body_temp_path
+// as they arrive
+void RequestParser::m_startMultipart(IRequest &request) const
 {
-    // Check if buffer is empty
-    if (buffer.empty())
-    {
-        // Log the situation
-        m_logger.log(ERROR,
-                     "[REQUESTPARSER] No data to unchunk, Buffer is empty");
+    MultipartParser &multipart = request.getMultipartParser();
+    IRoute *route = request.getState().getRoute();
+    if (multipart.started() || route == NULL || route->isCGI())
+        return;
 
-        return; // no data to unchunk
-    }
+    // Check the content type
+    std::string content_type = request.getHeaderValue(CONTENT_TYPE);
+    if (content_type.find("multipart/form-data") == std::string::npos)
+        return;
 
-    // Set the buffer string
-    std::string buffer_str = std::string(buffer.begin(), buffer.end());
+    // Get the boundary string
+    std::string::size_type pos = content_type.find("boundary=");
+    if (pos == std::string::npos)
+        throw HttpStatusCodeException(BAD_REQUEST, "Multipart boundary missing");
+    std::string boundary = content_type.substr(pos + 9);
+    boundary = m_trimWhitespace(boundary.substr(0, boundary.find(';')));
+    m_removeQuotes(boundary);
+    if (boundary.empty())
+        throw HttpStatusCodeException(BAD_REQUEST, "Multipart boundary missing");
+
+    // Log the start of the multipart parsing
+    LOG(m_logger, VERBOSE, "[REQUESTPARSER] Streaming multipart request to " +
+                           m_client_body_temp_path);
+    multipart.begin(boundary, m_client_body_temp_path,
+                    m_client_body_buffer_size);
+}
 
-    // Find the end of the chunk size line
-    size_t chunk_size_end = buffer_str.find("\r\n");
+// Function to hand body bytes over to the multipart parser, or to append them
+// to the body
+void RequestParser::m_appendBody(IRequest &request,
+                                 std::vector<char>::const_iterator begin,
+                                 std::vector<char>::const_iterator end) const
+{
+    RequestState &state = request.getState();
+    size_t size = end - begin;
+    state.setContentRed(state.getContentRed() + size);
 
-    // Check if the chunk size line is found
-    if (chunk_size_end == std::string::npos)
+    // Check the body against the limit of its route as it arrives
+    IRoute *route = state.getRoute();
+    if (route != NULL && static_cast<size_t>(state.getContentRed()) >
+                             route->getClientMaxBodySize())
     {
-        return; // not enough data yet to parse the chunk size
+        // throw '413' status error
+        throw HttpStatusCodeException(PAYLOAD_TOO_LARGE);
     }
 
-    // Get the chunk size string
-    std::string chunk_size_string = buffer_str.substr(0, chunk_size_end);
-
-    // Check for last chunk
-    if (chunk_size_string == "0")
+    // A CGI body goes straight to its file
+    if (request.getBodyFileDescriptor() != -1)
     {
-        // Set the request state as finished
-        request.getState().finished(true);
-
-        // Log the situation
-        m_logger.log(VERBOSE,
-                     "[REQUESTPARSER] Unchunking Completed; Final body size: " +
-                         Converter::toString(request.getBody().size()) + ".");
-
-        // Done parsing chunks
+        m_writeBodyFile(request, &*begin, size);
         return;
     }
 
-    // Get chunk size
-    size_t chunk_size = strtol(chunk_size_string.c_str(), NULL, 16);
-
-    // Check if chunk size is valid
-    if (chunk_size <= 0)
+    // A multipart upload goes straight to its files
+    MultipartParser &multipart = request.getMultipartParser();
+    if (multipart.started())
     {
-        // throw '400' status error
-        throw HttpStatusCodeException(BAD_REQUEST,
-                                      "chunk size conversion failed (" +
-                                          chunk_size_string + ")");
+        if (size > 0)
+            multipart.feed(request, &*begin, size);
+        return;
     }
 
-    // Check if we are exceeding the maximum allowed size
-    if (request.getBody().size() + chunk_size >
-        m_configuration.getSize_t("client_body_buffer_size"))
+    // Check if the body held in memory exceeds client body buffer size
+    if (request.getBody().size() + size > m_client_body_buffer_size)
     {
         // throw '413' status error
         throw HttpStatusCodeException(PAYLOAD_TOO_LARGE);
     }
-
-    // Set an iterator to the start of the chunk data
-    std::vector<char>::const_iterator it = buffer.begin() + chunk_size_end + 2;
-
-    // Check if enough data is available
-    if (it + chunk_size + 2 > buffer.end())
-    {
-        // Log the situation
-        m_logger.log(VERBOSE,
-                     "[REQUESTPARSER] Waiting for data; current body size: " +
-                         Converter::toString(request.getBody().size()) + ".");
-
-        return; // not enough data yet
-    }
-
-    // Append the chunk data to the body
-    request.appendBody(it, it + chunk_size);
-
-    // Move the iterator to the end of the chunk data
-    it += chunk_size;
-
-    // Validate the CRLF after the chunk data
-    if (*it != '\r' || *(it + 1) != '\n')
-    {
-        throw HttpStatusCodeException(BAD_REQUEST, "Invalid chunk data ending");
-    }
-
-    // Move the iterator passed the CRLF
-    it += 2;
-
-    // Trim the buffer
-    request.trimBuffer(it - buffer.begin());
-
-    // Recursively unchunk the body
-    m_unchunkBody(request.getBuffer(), request);
+    request.appendBody(begin, end);
 }
 
-// Function to parse cookies from the request
-void RequestParser::m_parseCookie(std::string &cookie_header_value,
-                                  IRequest &parsed_request) const
+// Function to write body bytes to the body file of the request
+void RequestParser::m_writeBodyFile(IRequest &request, const char *data,
+                                    size_t size) const
 {
-    // Parse cookies
-    std::string cookie_name;
-    std::string cookie_value;
-
-    // Create a stream from the cookie header value
-    std::istringstream cookie_stream(cookie_header_value);
-
-    // Parse cookie name and value
-    while (std::getline(cookie_stream, cookie_name, '=') &&
-           std::getline(cookie_stream, cookie_value, ';'))
+    while (size > 0)
     {
-        // Trim surrounding whitespace
-        cookie_name = m_trimWhitespace(cookie_name);
-        cookie_value = m_trimWhitespace(cookie_value);
-
-        // Add cookie to parsed request
-        parsed_request.addCookie(cookie_name, cookie_value);
+        ssize_t bytes_written =
+            write(request.getBodyFileDescriptor(), data, size);
+        if (bytes_written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw HttpStatusCodeException(INTERNAL_SERVER_ERROR,
+                                          "Failed to write body file " +
+                                              request.getBodyFilePath() +
+                                              ": " + strerror(errno));
+        }
+        data += bytes_written;
+        size -= bytes_written;
     }
 }
 
-void RequestParser::parseBodyParameters(IRequest &parsed_request) const
+// Function to mark the body as complete
+void RequestParser::m_finishBody(IRequest &request) const
 {
-    if (parsed_request.getHeaderValue(CONTENT_TYPE)
-            .find("multipart/form-data") == std::string::npos)
-    {
-        return;
-    }
-    // Log the start of the body parameter parsing
-    m_logger.log(VERBOSE, "[REQUESTPARSER] Parsing multipart request...");
-
-    // Get the boundary string
-    std::string content_type = parsed_request.getHeaderValue(CONTENT_TYPE);
-    std::string boundary =
-        "--" + content_type.substr(content_type.find("boundary=") + 9);
-
-    // Get body stream
-    std::vector<char> &body = parsed_request.getBody();
-    std::string body_string(body.begin(), body.end());
-    std::istringstream body_stream(body_string);
+    request.getState().finished(true);
+
+    // A multipart body must end with its closing boundary
+    MultipartParser &multipart = request.getMultipartParser();
+    if (multipart.started() && !multipart.done())
+        throw HttpStatusCodeException(BAD_REQUEST, "Incomplete multipart body");
+    if (multipart.started())
+        LOG(m_logger, VERBOSE,
+            "[REQUESTPARSER] ...done parsing multipart request");
+}
 
-    // Declare a line string
-    std::string line;
+// Function to decode a chunked body as bytes arrive, resuming where the
+// previous call stopped
+// Chunk data is handed over as soon as it arrives, the consumed bytes are
+// trimmed from the buffer once, at the end
+void RequestParser::m_unchunkBody(const std::vector<char> &buffer,
+                                  IRequest &request) const
+{
+    ChunkParsingState &chunk = request.getState().getChunk();
 
-    // Parse BodyParameters
-    while (m_getlineNoCr(body_stream, line))
+    // Decode the bytes buffered
+    const char *data = buffer.data();
+    size_t size = buffer.size();
+    size_t i = 0;
+    while (i < size)
     {
-        // Skip leading newline
-        if (line.empty())
+        // Hand over as much chunk data as is available
+        if (chunk.stage == CHUNK_DATA)
         {
-            // Move to next line
+            size_t data_bytes = std::min(chunk.remaining, size - i);
+            m_appendBody(request, buffer.begin() + i,
+                         buffer.begin() + i + data_bytes);
+            chunk.remaining -= data_bytes;
+            i += data_bytes;
+            if (chunk.remaining == 0)
+                chunk.stage = CHUNK_DATA_CR;
             continue;
         }
 
-        // Skip boundary
-        if (line.find(boundary) != std::string::npos)
+        // Jump over chunk extensions and trailer fields, they are ignored
+        if (chunk.stage == CHUNK_EXTENSION || chunk.stage == CHUNK_TRAILER)
         {
-            // Move to next line
-            continue;
+            size_t line_end =
+                m_line_end_scanner.find(data + i, data + size) - data;
+            chunk.line_length += line_end - i;
+            if (chunk.line_length > m_client_header_buffer_size)
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Chunk line too long");
+            i = line_end;
+            if (i == size)
+                break;
         }
 
-        BodyParameter body_parameter;
-
-        // Process each header line
-        std::string key;
-        std::string value;
-        do
+        char c = data[ i ];
+        switch (chunk.stage)
         {
-            std::string::size_type pos = line.find(':');
-            if (pos != std::string::npos)
+        case CHUNK_SIZE:
+            if (std::isxdigit(static_cast<unsigned char>(c)))
+            {
+                // Leave room for the next digit
+                if (chunk.size > (static_cast<size_t>(-1) >> 4))
+                    throw HttpStatusCodeException(PAYLOAD_TOO_LARGE);
+                chunk.size = chunk.size * 16 +
+                             (std::isdigit(static_cast<unsigned char>(c))
+                                  ? c - '0'
+                                  : std::tolower(c) - 'a' + 10);
+                chunk.size_digits++;
+                if (++chunk.line_length > m_client_header_buffer_size)
+                    throw HttpStatusCodeException(BAD_REQUEST,
+                                                  "Chunk line too long");
+                break;
+            }
+            if (chunk.size_digits == 0)
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk size");
+            if (c == '\r')
+                chunk.stage = CHUNK_SIZE_LF;
+            else if (c == ';' || c == ' ' || c == '\t')
+                chunk.stage = CHUNK_EXTENSION;
+            else
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk size");
+            break;
+        case CHUNK_EXTENSION:
+            if (c != '\r')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk size line");
+            chunk.stage = CHUNK_SIZE_LF;
+            break;
+        case CHUNK_SIZE_LF:
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk size line");
+            chunk.line_length = 0;
+            if (chunk.size == 0)
+                chunk.stage = CHUNK_TRAILER_START; // last chunk
+            else
             {
-                // Extract and trim key and value
-                key = line.substr(0, pos);
-                value = line.substr(pos + 1);
-                key = m_trimWhitespace(key);
-                value = m_trimWhitespace(value);
-
-                // lower cases the key
-                std::transform(key.begin(), key.end(), key.begin(),
-                               static_cast<int (*)(int)>(std::tolower));
-
-                // Store the header in the map
-                body_parameter.headers[ key ] = value;
-
-                // Parse disposition_type, content_type, and field_name
-                if (key == "content-disposition")
-                {
-                    // extract the disposition_type
-                    size_t pos = value.find(';');
-
-                    // declare remaining value
-                    std::string remaining_value;
-
-                    if (pos != std::string::npos)
-                    {
-                        body_parameter.disposition_type = value.substr(0, pos);
-                        remaining_value = value.substr(pos + 1);
-                    }
-
-                    // extract the filename and field_name
-                    std::istringstream iss(remaining_value);
-                    std::string token;
-                    while (std::getline(iss, token, ';'))
-                    {
-                        size_t pos = token.find('=');
-                        if (pos != std::string::npos)
-                        {
-                            // extract and trim the parameter and its value
-                            std::string param = token.substr(0, pos);
-                            std::string param_value = token.substr(pos + 1);
-                            param = m_trimWhitespace(param);
-                            param_value = m_trimWhitespace(param_value);
-
-                            // Remove surrounding quotes if they exist
-                            m_removeQuotes(param_value);
-
-                            // Store the parameter
-                            if (param == "filename")
-                                body_parameter.filename = param_value;
-                            else if (param == "name")
-                                body_parameter.field_name = param_value;
-                        }
-                    }
-                }
-                else if (key == "content-type")
-                    body_parameter.content_type = value;
+                chunk.remaining = chunk.size;
+                chunk.stage = CHUNK_DATA;
             }
-            // Log the header
-            m_logger.log(VERBOSE, "[REQUESTPARSER]  Header: " + key + ": \"" +
-                                      value + "\"");
-        } while (m_getlineNoCr(body_stream, line) && !line.empty());
-
-        // Assign the data to the body_parameter data member
-        m_assignUntilBoundary(body_stream, boundary, body_parameter.data);
-
-        // Log the first character of the BodyParameter data
-        if (!body_parameter.data.empty())
-            m_logger.log(VERBOSE,
-                         "[REQUESTPARSER]  Data: \"" +
-                             Converter::toString(body_parameter.data[ 0 ]) +
-                             "...\"");
-        else
-            m_logger.log(VERBOSE,
-                         "[REQUESTPARSER] No data found in BodyParameter");
-
-        // Add BodyParameter to vector
-        parsed_request.addBodyParameter(body_parameter);
+            break;
+        case CHUNK_DATA_CR:
+            if (c != '\r')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk data ending");
+            chunk.stage = CHUNK_DATA_LF;
+            break;
+        case CHUNK_DATA_LF:
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk data ending");
+            chunk.size = 0;
+            chunk.size_digits = 0;
+            chunk.stage = CHUNK_SIZE;
+            break;
+        case CHUNK_TRAILER_START:
+            // An empty line ends the trailer section, and the body
+            if (c == '\r')
+                chunk.stage = CHUNK_END_LF;
+            else
+            {
+                chunk.stage = CHUNK_TRAILER;
+                continue; // the byte is part of the trailer field
+            }
+            break;
+        case CHUNK_TRAILER:
+            if (c != '\r')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk trailer line");
+            chunk.stage = CHUNK_TRAILER_LF;
+            break;
+        case CHUNK_TRAILER_LF:
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunk trailer line");
+            chunk.line_length = 0;
+            chunk.stage = CHUNK_TRAILER_START;
+            break;
+        case CHUNK_END_LF:
+            if (c != '\n')
+                throw HttpStatusCodeException(BAD_REQUEST,
+                                              "Invalid chunked body ending");
+
+            // Remove the body from the buffer, the rest belongs to the next
+            // request
+            request.trimBuffer(i + 1);
+
+            // Set the request state as finished
+            m_finishBody(request);
+
+            // Log the situation
+            LOG(m_logger, VERBOSE,
+                "[REQUESTPARSER] Unchunking Completed; Final body size: " +
+                    Converter::toString(request.getState().getContentRed()) +
+                    ".");
+            return;
+        default:
+            break;
+        }
+        i++;
     }
 
-    // Log the end of the BodyParameter
-    m_logger.log(VERBOSE, "[REQUESTPARSER] ...done parsing multipart request");
+    // Remove the bytes decoded from the buffer
+    request.trimBuffer(i);
 
-    // Mark the request as an upload request
-    parsed_request.setUploadRequest(true);
+    // Log the situation
+    LOG(m_logger, VERBOSE,
+        "[REQUESTPARSER] Waiting for data; current body size: " +
+            Converter::toString(request.getState().getContentRed()) + ".");
 }
 
-// Function to check if a character is whitespace
-bool RequestParser::m_isWhitespace(char c) const
+// Function to parse cookies from the request, "name=value; name=value",
+// handing over spans of the header value rather than strings
+void RequestParser::m_parseCookie(const char *cookie_header_value,
+                                  size_t size, IRequest &parsed_request) const
 {
-    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r' ||
-           c == '\n';
+    const char *position = cookie_header_value;
+    const char *end = cookie_header_value + size;
+    while (position < end)
+    {
+        // Parse cookie name, up to '='
+        const char *name = position;
+        const char *equal =
+            static_cast<const char *>(memchr(name, '=', end - name));
+        if (equal == NULL)
+            break;
+
+        // Parse cookie value, up to ';' or the end of the header
+        const char *value = equal + 1;
+        const char *semicolon =
+            static_cast<const char *>(memchr(value, ';', end - value));
+        const char *value_end = semicolon != NULL ? semicolon : end;
+        position = semicolon != NULL ? semicolon + 1 : end;
+
+        // Trim surrounding whitespace
+        const char *name_end = equal;
+        m_trimSpan(name, name_end);
+        m_trimSpan(value, value_end);
+
+        // Add cookie to parsed request
+        parsed_request.addCookie(name, name_end - name, value,
+                                 value_end - value);
+    }
+}
+
+// Function to get the scanner finding the end of the token of a head parsing
+// stage, or NULL if the stage looks at a single byte
+const DelimiterScanner *
+RequestParser::m_getHeadScanner(HeadParsingStage stage) const
+{
+    switch (stage)
+    {
+    case HEAD_METHOD:
+    case HEAD_URI:
+        return &m_request_line_scanner;
+    case HEAD_HTTP_VERSION:
+    case HEAD_HEADER_VALUE:
+        return &m_line_end_scanner;
+    case HEAD_HEADER_NAME:
+        return &m_header_name_scanner;
+    default:
+        return NULL;
+    }
 }
 
-// Function to check if an iterator points to CRLF (carriage return + line feed)
-bool RequestParser::m_isCRLF(std::vector<char>::const_iterator it) const
+// Function to make a span of the bytes from start up to end
+BufferSpan RequestParser::m_span(size_t start, size_t end) const
 {
-    return *it == '\r' && *(it + 1) == '\n';
+    BufferSpan span = {start, end - start};
+    return span;
 }
 
-// Function to check if an iterator points to a character that is in a given set
-bool RequestParser::m_isCharInSet(std::vector<char>::const_iterator it,
-                                  const std::string &set) const
+// Function to copy the bytes of a span out of the buffer
+std::string RequestParser::m_spanString(const std::vector<char> &buffer,
+                                        const BufferSpan &span) const
 {
-    return set.find(*it) != std::string::npos;
+    if (span.length == 0)
+        return std::string();
+    return std::string(&buffer[ span.start ], span.length);
 }
 
 // Function to trim whitespace
@@ -707,6 +751,16 @@ std::string RequestParser::m_trimWhitespace(const std::string &string) const
     return result;
 }
 
+// Function to trim leading and trailing whitespace from the bytes between
+// begin and end, moving them
+void RequestParser::m_trimSpan(const char *&begin, const char *&end) const
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+        begin++;
+    while (end > begin && (end[ -1 ] == ' ' || end[ -1 ] == '\t'))
+        end--;
+}
+
 // Function to remove quotes from a string
 void RequestParser::m_removeQuotes(std::string &string) const
 {
@@ -715,71 +769,4 @@ void RequestParser::m_removeQuotes(std::string &string) const
         string = string.substr(1, string.length() - 2);
 }
 
-// Custom getline function to remove carriage return
-std::istream &RequestParser::m_getlineNoCr(std::istream &is,
-                                           std::string &line) const
-{
-    if (std::getline(is, line))
-    {
-        if (!line.empty() && line[ line.size() - 1 ] == '\r')
-        {
-            line.erase(line.size() - 1);
-        }
-    }
-    return is;
-}
-#include <iostream>
-// Function to read a stringstream into a char vector until the boundary is
-// found NOTE - This function will currently fail when the boundary is split
-// between two buffer reads
-void RequestParser::m_assignUntilBoundary(std::istringstream &iss,
-                                          const std::string &boundary,
-                                          std::vector<char> &dest) const
-{
-    const size_t buffer_size = 1024;
-    char buffer[ buffer_size + 1 ];
-    size_t boundary_length = boundary.length();
-    size_t bytes_read;
-    size_t pos;
-
-    // Read the buffer until the boundary is found
-    while (!iss.eof())
-    {
-        // Get the current position
-        pos = iss.tellg();
-
-        // Read the buffer
-        iss.read(buffer, buffer_size);
-
-        // Get the number of bytes read
-        bytes_read = iss.gcount();
-        buffer[ bytes_read ] = '\0';
-
-        // Check if the boundary is found in the buffer
-        for (size_t i = 0; i < bytes_read; i++)
-        {
-            if (buffer[ i ] == boundary[ 0 ])
-            {
-                // Check if the boundary is found in the buffer
-                if (strncmp(&buffer[ i ], boundary.c_str(), boundary_length) ==
-                    0)
-                {
-                    // Add the buffer to the destination minus the CRLF
-                    dest.insert(dest.end(), buffer, buffer + i - 2);
-
-                    // Move the stringstream to the end of the boundary
-                    // and passed the CRLF
-                    iss.clear(); // Clear the eof flag if necessary
-                    iss.seekg(pos + i + boundary_length + 2);
-
-                    // Return from the function
-                    return;
-                }
-            }
-        }
-
-        // Add the buffer to the destination and continue reading
-        dest.insert(dest.end(), buffer, buffer + bytes_read);
-    }
-}
-// path: srcs/RequestHandler.cpp
+// Path: srcs/request/RequestParser.cpp
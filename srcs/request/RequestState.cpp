@@ -8,6 +8,8 @@ RequestState::RequestState()
     m_headers = false;
     m_initial = true;
     m_route = NULL;
+    m_resetHead();
+    m_resetChunk();
 }
 
 bool RequestState::finished() const { return m_finished; }
@@ -16,6 +18,8 @@ bool RequestState::initial() const { return m_initial; }
 int RequestState::getContentLength() const { return m_content_length; }
 int RequestState::getContentRed() const { return m_content_red; }
 IRoute *RequestState::getRoute() const { return m_route; }
+HeadParsingState &RequestState::getHead() { return m_head; }
+ChunkParsingState &RequestState::getChunk() { return m_chunk; }
 
 void RequestState::finished(bool value) { m_finished = value; }
 void RequestState::headers(bool value) { m_headers = value; }
@@ -26,9 +30,38 @@ void RequestState::setContentRed(int value) { m_content_red = value; }
 void RequestState::reset()
 {
     m_finished = false;
+    m_headers = false;
     m_initial = true;
     m_content_red = 0;
     m_content_length = 0;
+    m_route = NULL;
+    m_resetHead();
+    m_resetChunk();
 }
 
 void RequestState::setRoute(IRoute *route) { m_route = route; }
+
+// Start the head parser over, at the beginning of the buffer
+void RequestState::m_resetHead()
+{
+    BufferSpan empty = {0, 0};
+    m_head.stage = HEAD_LEADING_CRLF;
+    m_head.offset = 0;
+    m_head.line_start = 0;
+    m_head.token_start = 0;
+    m_head.method = empty;
+    m_head.uri = empty;
+    m_head.http_version = empty;
+    m_head.header_name = empty;
+    m_head.headers.clear();
+}
+
+// Start the chunk decoder over, expecting the size of the first chunk
+void RequestState::m_resetChunk()
+{
+    m_chunk.stage = CHUNK_SIZE;
+    m_chunk.size = 0;
+    m_chunk.size_digits = 0;
+    m_chunk.remaining = 0;
+    m_chunk.line_length = 0;
+}
@@ -2,8 +2,9 @@
 #include <cstdio>
 
 // Constructor
-DeleteResponseGenerator::DeleteResponseGenerator(ILogger &logger)
-    : m_logger(logger)
+DeleteResponseGenerator::DeleteResponseGenerator(
+    ILogger &logger, OpenFileCache &open_file_cache)
+    : m_logger(logger), m_open_file_cache(open_file_cache)
 {
 }
 
@@ -34,8 +35,10 @@ Triplet_t DeleteResponseGenerator::generateResponse(
     }
     std::string file_path = root + uri;
 
-    // Delete the file
-    if (remove(file_path.c_str()) != 0)
+    // Delete the file, forgetting it in the open file cache
+    int removed = remove(file_path.c_str());
+    m_open_file_cache.invalidate(file_path);
+    if (removed != 0)
     {
         // log the error
         m_logger.log(ERROR, "Could not delete file: " + file_path);
@@ -46,7 +49,7 @@ Triplet_t DeleteResponseGenerator::generateResponse(
     else
     {
         // log the situation
-        m_logger.log(VERBOSE, "File deleted: " + file_path);
+        LOG(m_logger, VERBOSE, "File deleted: " + file_path);
 
         // set the response
         response.setErrorResponse(
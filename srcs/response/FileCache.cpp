@@ -0,0 +1,151 @@
+#include "../../includes/response/FileCache.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <unistd.h>
+
+/*
+ * FileCache.cpp
+ *
+ * In-memory cache of the hot static files, bounded by a byte budget with
+ * LRU eviction.
+ *
+ */
+
+// Constructor
+FileCache::FileCache(const IClock &clock, size_t size, size_t max_file_size,
+                     time_t valid)
+    : m_clock(clock), m_size(size),
+      m_max_file_size(max_file_size < size ? max_file_size : size),
+      m_valid(valid), m_used(0)
+{
+}
+
+// Destructor
+FileCache::~FileCache() {}
+
+// Get the entry of a key, checking it against the file if it was not checked
+// recently
+// Returns NULL if the key is not cached or the file changed
+const FileCacheEntry *FileCache::lookup(const std::string &key)
+{
+    std::map<std::string, FileCacheEntry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return NULL;
+    FileCacheEntry &entry = it->second;
+
+    // Check the entry against the file once the validity window is over
+    time_t now = m_clock.getTime();
+    if (now - entry.validated >= m_valid)
+    {
+        struct stat info;
+        if (stat(entry.file_path.c_str(), &info) == -1 ||
+            info.st_dev != entry.device || info.st_ino != entry.inode ||
+            info.st_size != entry.size || info.st_mtime != entry.modified)
+        {
+            this->m_evict(it);
+            return NULL;
+        }
+        entry.validated = now;
+    }
+
+    // Move the entry to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, entry.position);
+    return &entry;
+}
+
+// Read a file, open by the caller, into the cache under a key, evicting the
+// least recently used entries to make room
+// Returns NULL if the file cannot be read or is not worth caching
+const FileCacheEntry *FileCache::load(const std::string &key,
+                                      const std::string &file_path,
+                                      int file_descriptor,
+                                      const struct stat &info,
+                                      const std::string &content_type,
+                                      const std::string &content_encoding)
+{
+    // Only regular files small enough are cached
+    if (m_size == 0 || !S_ISREG(info.st_mode) ||
+        static_cast<size_t>(info.st_size) > m_max_file_size)
+        return NULL;
+
+    // Read the whole file, giving up if it changed size meanwhile
+    std::vector<char> body(info.st_size);
+    if (!readFile(file_descriptor, body))
+        return NULL;
+
+    // Replace a previous entry of the key
+    std::map<std::string, FileCacheEntry>::iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+        this->m_evict(it);
+
+    // Make room, least recently used first
+    while (m_used + body.size() > m_size && !m_lru.empty())
+        this->m_evict(m_entries.find(m_lru.back()));
+
+    // Add the entry with its headers
+    FileCacheEntry &entry = m_entries[ key ];
+    entry.file_path = file_path;
+    entry.body.swap(body);
+    entry.content_type = content_type;
+    entry.content_encoding = content_encoding;
+    entry.content_length = Converter::toString(info.st_size);
+    entry.etag = makeEntityTag(info);
+    entry.last_modified = makeLastModified(info);
+    entry.device = info.st_dev;
+    entry.inode = info.st_ino;
+    entry.size = info.st_size;
+    entry.modified = info.st_mtime;
+    entry.validated = m_clock.getTime();
+    m_lru.push_front(key);
+    entry.position = m_lru.begin();
+    m_used += entry.body.size();
+    return &entry;
+}
+
+// Remove an entry
+void FileCache::m_evict(std::map<std::string, FileCacheEntry>::iterator entry)
+{
+    m_used -= entry->second.body.size();
+    m_lru.erase(entry->second.position);
+    m_entries.erase(entry);
+}
+
+// Read a file from an offset, filling a body
+// Returns false if the file ended before the body was full
+bool FileCache::readFile(int file_descriptor, std::vector<char> &body,
+                         off_t offset)
+{
+    size_t total = 0;
+    while (total < body.size())
+    {
+        ssize_t bytes_read = pread(file_descriptor, &body[ total ],
+                                   body.size() - total, offset + total);
+        if (bytes_read == -1 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0)
+            return false;
+        total += bytes_read;
+    }
+    return true;
+}
+
+// Get the weak entity tag of a file, from its inode, size and modification
+// time
+std::string FileCache::makeEntityTag(const struct stat &info)
+{
+    char buffer[ 64 ];
+    snprintf(buffer, sizeof(buffer), "W/\"%lx-%lx-%lx\"",
+             static_cast<unsigned long>(info.st_ino),
+             static_cast<unsigned long>(info.st_size),
+             static_cast<unsigned long>(info.st_mtime));
+    return buffer;
+}
+
+// Get the Last-Modified header of a file
+std::string FileCache::makeLastModified(const struct stat &info)
+{
+    return Converter::toHttpDate(info.st_mtime);
+}
+
+// Path: srcs/response/FileCache.cpp
@@ -0,0 +1,259 @@
+#include "../../includes/response/OpenFileCache.hpp"
+#include "../../includes/utils/Converter.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+/*
+ * OpenFileCache.cpp
+ *
+ * Cache of the open descriptors, metadata and lookup errors of files, bounded
+ * by a number of entries with LRU eviction.
+ *
+ */
+
+// Constructor, reads the open_file_cache directives of the http block
+OpenFileCache::OpenFileCache(const IClock &clock, const IConfiguration &http)
+    : m_clock(clock), m_max(0), m_inactive(60), m_valid(60), m_errors(false)
+{
+    this->m_loadConfiguration(http);
+}
+
+// Destructor, closes the cached descriptors
+OpenFileCache::~OpenFileCache()
+{
+    std::map<std::string, OpenFileCacheEntry>::iterator it;
+    for (it = m_entries.begin(); it != m_entries.end(); it++)
+    {
+        if (it->second.file_descriptor != -1)
+            close(it->second.file_descriptor);
+    }
+}
+
+// Get the metadata of a file, as stat does
+// Returns -1 with errno set if the file cannot be found
+int OpenFileCache::stat(const std::string &path, struct stat &info)
+{
+    if (m_max == 0)
+        return ::stat(path.c_str(), &info);
+
+    const OpenFileCacheEntry *entry = this->m_lookup(path);
+    if (entry == NULL)
+        return -1;
+    if (entry->error != 0)
+    {
+        errno = entry->error;
+        return -1;
+    }
+    info = entry->info;
+    return 0;
+}
+
+// Open a regular file for reading and get its metadata
+// Returns a descriptor belonging to the caller, or -1 with errno set
+int OpenFileCache::open(const std::string &path, struct stat &info)
+{
+    if (m_max != 0)
+    {
+        const OpenFileCacheEntry *entry = this->m_lookup(path);
+        if (entry == NULL)
+            return -1;
+        if (entry->error != 0)
+        {
+            errno = entry->error;
+            return -1;
+        }
+        if (S_ISDIR(entry->info.st_mode))
+        {
+            errno = EISDIR;
+            return -1;
+        }
+
+        // The responses close their descriptor, they get a duplicate of the
+        // cached one, the file being sent from offsets of their own
+        if (entry->file_descriptor != -1)
+        {
+            info = entry->info;
+            return fcntl(entry->file_descriptor, F_DUPFD_CLOEXEC, 0);
+        }
+    }
+
+    // Open the file itself if it is not cached, or could not be opened when
+    // it was looked up
+    int file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor == -1)
+        return -1;
+    int error = 0;
+    if (fstat(file_descriptor, &info) == -1)
+        error = errno;
+    else if (S_ISDIR(info.st_mode))
+        error = EISDIR;
+    if (error != 0)
+    {
+        close(file_descriptor);
+        errno = error;
+        return -1;
+    }
+    return file_descriptor;
+}
+
+// Forget a path, once it was changed
+void OpenFileCache::invalidate(const std::string &path)
+{
+    std::map<std::string, OpenFileCacheEntry>::iterator it =
+        m_entries.find(path);
+    if (it != m_entries.end())
+        this->m_evict(it);
+}
+
+// Get the entry of a path, looking it up again if it is missing or was not
+// checked recently
+// Returns NULL if the lookup failed and errors are not cached, with errno set
+const OpenFileCacheEntry *OpenFileCache::m_lookup(const std::string &path)
+{
+    time_t now = m_clock.getTime();
+    this->m_expire(now);
+
+    // Use the entry while it is valid
+    std::map<std::string, OpenFileCacheEntry>::iterator it =
+        m_entries.find(path);
+    if (it != m_entries.end())
+    {
+        if (now - it->second.validated < m_valid)
+        {
+            it->second.used = now;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+            return &it->second;
+        }
+        this->m_evict(it);
+    }
+
+    // Look the path up, the failed lookups being only cached on request
+    OpenFileCacheEntry entry;
+    m_load(path, entry);
+    if (entry.error != 0 && !m_errors)
+    {
+        errno = entry.error;
+        return NULL;
+    }
+
+    // Make room, least recently used first
+    while (m_entries.size() >= m_max && !m_lru.empty())
+        this->m_evict(m_entries.find(m_lru.back()));
+
+    // Add the entry
+    entry.validated = now;
+    entry.used = now;
+    m_lru.push_front(path);
+    entry.position = m_lru.begin();
+    return &(m_entries[ path ] = entry);
+}
+
+// Look a path up, filling an entry
+void OpenFileCache::m_load(const std::string &path, OpenFileCacheEntry &entry)
+{
+    entry.file_descriptor = -1;
+    entry.error = 0;
+    if (::stat(path.c_str(), &entry.info) == -1)
+    {
+        entry.error = errno;
+        return;
+    }
+    if (!S_ISREG(entry.info.st_mode))
+        return;
+
+    // Keep regular files open, with the metadata of the file actually opened
+    // in case it was replaced meanwhile
+    int file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor == -1)
+        return;
+    if (fstat(file_descriptor, &entry.info) == -1 ||
+        !S_ISREG(entry.info.st_mode))
+    {
+        close(file_descriptor);
+        return;
+    }
+    entry.file_descriptor = file_descriptor;
+}
+
+// Close the entries not used for too long, a few at a time
+void OpenFileCache::m_expire(time_t now)
+{
+    for (int i = 0; i < OPEN_FILE_CACHE_EXPIRE && !m_lru.empty(); i++)
+    {
+        std::map<std::string, OpenFileCacheEntry>::iterator it =
+            m_entries.find(m_lru.back());
+        if (now - it->second.used < m_inactive)
+            break;
+        this->m_evict(it);
+    }
+}
+
+// Remove an entry, closing its descriptor
+void OpenFileCache::m_evict(
+    std::map<std::string, OpenFileCacheEntry>::iterator entry)
+{
+    if (entry->second.file_descriptor != -1)
+        close(entry->second.file_descriptor);
+    m_lru.erase(entry->second.position);
+    m_entries.erase(entry);
+}
+
+// Read the open_file_cache directives of the http block
+// "open_file_cache off" or "open_file_cache max=N [inactive=T]", an invalid
+// directive leaving the cache disabled
+void OpenFileCache::m_loadConfiguration(const IConfiguration &http)
+{
+    try
+    {
+        const std::vector<std::string> &parameters =
+            http.getStringVector("open_file_cache");
+        size_t max = 0;
+        time_t inactive = 60;
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            if (parameters[ i ].compare(0, 4, "max=") == 0)
+                max = Converter::toUInt(parameters[ i ].substr(4));
+            else if (parameters[ i ].compare(0, 9, "inactive=") == 0)
+                inactive = m_parseTime(parameters[ i ].substr(9));
+        }
+        m_valid = m_parseTime(http.getString("open_file_cache_valid"));
+        m_errors = http.getBool("open_file_cache_errors");
+        m_inactive = inactive;
+        m_max = max;
+    }
+    catch (const std::invalid_argument &e)
+    {
+        m_max = 0;
+    }
+}
+
+// Parse a time such as 30, 30s, 5m, 1h or 1d into seconds
+time_t OpenFileCache::m_parseTime(const std::string &time)
+{
+    if (time.empty())
+        throw std::invalid_argument(time);
+    std::string number = time;
+    time_t unit = 1;
+    switch (time[ time.size() - 1 ])
+    {
+    case 's':
+        break;
+    case 'm':
+        unit = 60;
+        break;
+    case 'h':
+        unit = 3600;
+        break;
+    case 'd':
+        unit = 86400;
+        break;
+    default:
+        number += 's';
+    }
+    number.erase(number.size() - 1);
+    return Converter::toUInt(number) * unit;
+}
+
+// Path: srcs/response/OpenFileCache.cpp
@@ -1,5 +1,6 @@
 #include "../../includes/response/RFCCgiResponseGenerator.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
+#include "../../includes/utils/Arena.hpp"
 #include "../../includes/utils/Converter.hpp"
 #include <cerrno>
 #include <cstdio>
@@ -52,14 +53,14 @@ Triplet_t RFCCgiResponseGenerator::generateResponse(
     std::string script =
         uri.substr(last_slash + 1, question_mark - last_slash - 1);
 
-    m_logger.log(DEBUG, "CGI SCRIPT " + script);
+    LOG(m_logger, DEBUG, "CGI SCRIPT " + script);
     (void)m_from_file;
 
-    // Set cgi arguments
+    // Set cgi arguments, drawn from the arena of the request
     std::vector<char *> cgi_args;
-    m_setCgiArguments(m_bin_path, script, route, cgi_args);
+    m_setCgiArguments(m_bin_path, script, route, request, cgi_args);
 
-    // Set cgi environment variables
+    // Set cgi environment variables, drawn from the arena of the request
     std::vector<char *> cgi_env;
     m_setCgiEnvironment(script, route, request, cgi_env);
 
@@ -67,30 +68,27 @@ Triplet_t RFCCgiResponseGenerator::generateResponse(
     int cgi_output_pipe_fd[ 2 ];
     if (pipe(cgi_output_pipe_fd) == -1)
         // pipe failed
-        m_cleanUp(cgi_args.data(),
-                  cgi_env.data()); // Free memory and throw exception 500
+        m_cleanUp(); // Throw exception 500
 
     // Fork a child process
     pid_t pid = fork();
     if (pid == -1)
         // fork failed
-        m_cleanUp(cgi_args.data(), cgi_env.data(),
-                  cgi_output_pipe_fd); // Free memory and throw exception 500
+        m_cleanUp(cgi_output_pipe_fd); // Close the pipe and throw exception 500
 
     else if (pid == 0) // child process
     {
-        m_logger.log(DEBUG,
-                     "Forked a child process to execute the CGI script PID: " +
-                         Converter::toString(getpid()) +
-                         " Parent PID: " + Converter::toString(getppid()));
+        LOG(m_logger, DEBUG,
+            "Forked a child process to execute the CGI script PID: " +
+                Converter::toString(getpid()) + " Parent PID: " +
+                Converter::toString(getppid()));
 
         // open the body file for reading
         std::string body_file_path = request.getBodyFilePath();
         int file_fd = open(body_file_path.c_str(), O_RDONLY);
         if (file_fd == -1)
         {
-            m_cleanUp(cgi_args.data(), cgi_env.data(), cgi_output_pipe_fd,
-                      NO_THROW);
+            m_cleanUp(cgi_output_pipe_fd, NO_THROW);
             exit(1);
         }
 
@@ -110,9 +108,8 @@ Triplet_t RFCCgiResponseGenerator::generateResponse(
         // Call execve
         execve(cgi_args[ 0 ], cgi_args.data(), cgi_env.data());
         m_logger.log(ERROR, "Execve failed: " + std::string(strerror(errno)));
-        // If execve returns, an error occurred; free memory and exit
-        m_cleanUp(cgi_args.data(), cgi_env.data(), cgi_output_pipe_fd,
-                  NO_THROW);
+        // If execve returns, an error occurred; close the pipe and exit
+        m_cleanUp(cgi_output_pipe_fd, NO_THROW);
         close(file_fd);
         exit(EXIT_FAILURE);
     }
@@ -120,21 +117,19 @@ Triplet_t RFCCgiResponseGenerator::generateResponse(
     else // parent process
     {
         // Log the new CGI process ID
-        m_logger.log(DEBUG, "New CGI process ID: " + Converter::toString(pid));
+        LOG(m_logger, DEBUG, "New CGI process ID: " + Converter::toString(pid));
 
         // Set the read end of the Cgi Output Pipe to non-blocking
         fcntl(cgi_output_pipe_fd[ 0 ], F_SETFL, O_NONBLOCK);
 
-        // Free memory and keep the write end of the CGI Input pipe open and the
-        // read end of the CGI Output pipe open
-        m_cleanUp(cgi_args.data(), cgi_env.data(), cgi_output_pipe_fd,
-                  NO_THROW | KEEP_CGI_OUTPUT_PIPE_READ_END);
+        // Close the write end of the CGI Output pipe, keeping the read end open
+        m_cleanUp(cgi_output_pipe_fd, NO_THROW | KEEP_CGI_OUTPUT_PIPE_READ_END);
 
         // Log the Cgi info
-        m_logger.log(VERBOSE, "Returning CGI info tuple; PID: " +
-                                  Converter::toString(pid) +
-                                  " CGI output pipe Read end: " +
-                                  Converter::toString(cgi_output_pipe_fd[ 0 ]));
+        LOG(m_logger, VERBOSE, "Returning CGI info tuple; PID: " +
+                               Converter::toString(pid) +
+                               " CGI output pipe Read end: " +
+                               Converter::toString(cgi_output_pipe_fd[ 0 ]));
 
         // Return the read end of the pipe to read the response later without
         // blocking
@@ -149,25 +144,19 @@ Triplet_t RFCCgiResponseGenerator::generateResponse(
 void RFCCgiResponseGenerator::m_setCgiArguments(const std::string &cgi_script,
                                                 const std::string &script,
                                                 const IRoute &route,
+                                                const IRequest &request,
                                                 std::vector<char *> &cgi_args)
 {
-    cgi_args.push_back(strdup(cgi_script.c_str())); // Interpreter absolute path
+    Arena &arena = request.getArena();
     cgi_args.push_back(
-        m_getScriptPath(script, route)); // script path: location block root
-                                         // path + URI(excl. query string)
+        arena.duplicate(cgi_script)); // Interpreter absolute path
+    cgi_args.push_back(arena.duplicate(
+        m_getScriptPath(script, route))); // script path: location block root
+                                          // path + URI(excl. query string)
     cgi_args.push_back(NULL);
 
-    // Check for strdup failures
-    for (size_t i = 0; i < cgi_args.size() - 1; ++i)
-    {
-        if (cgi_args[ i ] == NULL)
-        {
-            m_cleanUp(cgi_args.data()); // Free memory and throw exception 500
-        }
-    }
-
-    m_logger.log(DEBUG, "CGI interpreter: " + std::string(cgi_args[ 0 ]));
-    m_logger.log(DEBUG, "CGI script: " + std::string(cgi_args[ 1 ]));
+    LOG(m_logger, DEBUG, "CGI interpreter: " + std::string(cgi_args[ 0 ]));
+    LOG(m_logger, DEBUG, "CGI script: " + std::string(cgi_args[ 1 ]));
 }
 
 void RFCCgiResponseGenerator::m_setCgiEnvironment(const std::string &script,
@@ -175,46 +164,40 @@ void RFCCgiResponseGenerator::m_setCgiEnvironment(const std::string &script,
                                                   const IRequest &request,
                                                   std::vector<char *> &cgi_env)
 {
+    Arena &arena = request.getArena();
     cgi_env.push_back(
-        strdup(("REQUEST_METHOD=" + request.getMethodString()).c_str()));
+        arena.duplicate("REQUEST_METHOD=" + request.getMethodString()));
     cgi_env.push_back(
-        strdup(("QUERY_STRING=" + request.getQueryString()).c_str()));
+        arena.duplicate("QUERY_STRING=" + request.getQueryString()));
     cgi_env.push_back(
-        strdup(("CONTENT_LENGTH=" + request.getContentLength()).c_str()));
+        arena.duplicate("CONTENT_LENGTH=" + request.getContentLength()));
     cgi_env.push_back(
-        strdup(("CONTENT_TYPE=" + request.getContentType()).c_str()));
+        arena.duplicate("CONTENT_TYPE=" + request.getContentType()));
     std::string script_filename = route.getRoot() + route.getPath();
     if (script_filename[ script_filename.size() - 1 ] != '/')
         script_filename += "/";
     script_filename += script;
-    cgi_env.push_back(strdup(("SCRIPT_FILENAME=" + script_filename).c_str()));
-    cgi_env.push_back(strdup(("SCRIPT_NAME=" + script).c_str()));
+    cgi_env.push_back(arena.duplicate("SCRIPT_FILENAME=" + script_filename));
+    cgi_env.push_back(arena.duplicate("SCRIPT_NAME=" + script));
     // path info to satisfy 42 tester
     std::string path_info = request.getUri();
-    cgi_env.push_back(strdup(("PATH_INFO=" + path_info).c_str()));
-    cgi_env.push_back(strdup(
-        ("PATH_TRANSLATED=" + m_getPathTranslated(path_info, route)).c_str()));
-    cgi_env.push_back(strdup(("REQUEST_URI=" + request.getUri()).c_str()));
+    cgi_env.push_back(arena.duplicate("PATH_INFO=" + path_info));
+    cgi_env.push_back(arena.duplicate("PATH_TRANSLATED=" +
+                                      m_getPathTranslated(path_info, route)));
+    cgi_env.push_back(arena.duplicate("REQUEST_URI=" + request.getUri()));
     cgi_env.push_back(
-        strdup(("SERVER_PROTOCOL=" + request.getHttpVersionString()).c_str()));
-    std::map<HttpHeader, std::string> headers = request.getHeaders();
-    cgi_env.push_back(strdup(
-        ("HTTP_X_SECRET_HEADER_FOR_TEST=" + headers[ X_SECRET_HEADER_FOR_TEST ])
-            .c_str()));
+        arena.duplicate("SERVER_PROTOCOL=" + request.getHttpVersionString()));
+    cgi_env.push_back(
+        arena.duplicate("HTTP_X_SECRET_HEADER_FOR_TEST=" +
+                        request.getHeaderValue(X_SECRET_HEADER_FOR_TEST)));
     cgi_env.push_back(NULL);
 
-    // Check for strdup failures
-    for (size_t i = 0; i < cgi_env.size() - 1; ++i)
-        if (cgi_env[ i ] == NULL)
-            m_cleanUp(NULL,
-                      cgi_env.data()); // Free memory and throw exception 500
-
     // Log the environment variables
     for (size_t i = 0; i < cgi_env.size() - 1; ++i)
-        m_logger.log(VERBOSE, "CGI Environment: " + std::string(cgi_env[ i ]));
+        LOG(m_logger, VERBOSE, "CGI Environment: " + std::string(cgi_env[ i ]));
 }
 
-char *RFCCgiResponseGenerator::m_getScriptPath(const std::string &script_name,
+std::string RFCCgiResponseGenerator::m_getScriptPath(const std::string &script_name,
                                                const IRoute &route) const
 {
     // Get the root path
@@ -228,8 +211,7 @@ char *RFCCgiResponseGenerator::m_getScriptPath(const std::string &script_name,
         prefix += '/';
 
     // Return the script path without the query string
-    return strdup((root_path + prefix + script_name)
-                      .c_str()); //  e.g. /path/to/script.php
+    return root_path + prefix + script_name; //  e.g. /path/to/script.php
 }
 
 std::string
@@ -248,27 +230,11 @@ RFCCgiResponseGenerator::m_getPathTranslated(std::string &path_info,
     return root_path + prefix + path_info;
 }
 
-void RFCCgiResponseGenerator::m_cleanUp(char *cgi_args[], char *cgi_env[],
-                                        int cgi_output_pipe_fd[ 2 ],
+void RFCCgiResponseGenerator::m_cleanUp(int cgi_output_pipe_fd[ 2 ],
                                         short option) const
 {
-    // Free args
-    if (cgi_args != NULL)
-    {
-        for (int i = 0; cgi_args[ i ] != NULL; ++i)
-        {
-            free(cgi_args[ i ]);
-        }
-    }
-
-    // Free env
-    if (cgi_env != NULL)
-    {
-        for (int i = 0; cgi_env[ i ] != NULL; ++i)
-        {
-            free(cgi_env[ i ]);
-        }
-    }
+    // The arguments and the environment belong to the arena of the request,
+    // and are freed with it
 
     // Close CGI Output pipe
     if (cgi_output_pipe_fd != NULL)
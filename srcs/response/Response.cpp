@@ -1,6 +1,8 @@
 #include "../../includes/response/Response.hpp"
 #include "../../includes/utils/Converter.hpp"
+#include <algorithm>
 #include <cstddef>
+#include <unistd.h>
 
 /*
  * Response class
@@ -11,13 +13,41 @@
  */
 
 // Default constructor
-Response::Response(const HttpHelper &httpHelper)
-    : m_content_length(0), m_http_helper(httpHelper), m_buffer(0)
+Response::Response(const HttpHelper &httpHelper, const IClock &clock)
+    : m_headers(std::less<std::string>(), &m_arena),
+      m_body_file_descriptor(-1), m_body_file_offset(0), m_content_length(0),
+      m_http_helper(httpHelper), m_clock(clock), m_buffer(0)
 {
 }
 
 // Destructor
-Response::~Response() {}
+Response::~Response() { this->m_closeBodyFile(); }
+
+// Forget the response, so that it can be reused for the next one
+// The buffers keep their capacity, up to RESPONSE_RETAINED_CAPACITY
+void Response::reset()
+{
+    m_status_line.clear();
+    m_headers.clear();
+    m_clearBuffer(m_body);
+    this->m_closeBodyFile();
+    m_body_file_offset = 0;
+    m_content_length = 0;
+    m_cookies.clear();
+    m_clearBuffer(m_buffer);
+
+    // Nothing draws from the arena anymore
+    m_arena.reset();
+}
+
+// Empty a buffer, freeing it if it grew past the retained capacity
+void Response::m_clearBuffer(std::vector<char> &buffer)
+{
+    if (buffer.capacity() > RESPONSE_RETAINED_CAPACITY)
+        std::vector<char>().swap(buffer);
+    else
+        buffer.clear();
+}
 
 // Getter for status line
 std::string Response::getStatusLine() const { return m_status_line; }
@@ -26,16 +56,41 @@ std::string Response::getStatusLine() const { return m_status_line; }
 std::string Response::getHeaders() const
 {
     std::string headers;
-    for (std::map<std::string, std::string>::const_iterator it =
-             m_headers.begin();
+    headers.reserve(this->m_getHeadersSize());
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
          it != m_headers.end(); it++)
     {
         // Construct each header line in the format "HeaderName: Value\r\n"
-        headers += it->first + ": " + it->second + "\r\n";
+        headers.append(it->first)
+            .append(": ")
+            .append(it->second.data, it->second.size)
+            .append("\r\n");
     }
     return headers;
 }
 
+// Size of the header lines, without building them
+size_t Response::m_getHeadersSize() const
+{
+    size_t size = 0;
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
+         it != m_headers.end(); it++)
+        size += it->first.size() + 2 + it->second.size + 2;
+    return size;
+}
+
+// Set a header, its value being copied into the arena
+void Response::m_setHeader(const std::string &header_name, const char *value,
+                           size_t size)
+{
+    ArenaString arena_value = m_arena.copy(value, size);
+    HeaderMap_t::iterator it = m_headers.find(header_name);
+    if (it != m_headers.end())
+        it->second = arena_value;
+    else
+        m_headers.insert(std::make_pair(header_name, arena_value));
+}
+
 // Getter for body string
 std::string Response::getBodyString() const { return m_body.data(); }
 
@@ -69,7 +124,8 @@ void Response::setHeaders(std::vector<std::string> headers)
         std::string header_value = header.substr(header.find(":") + 1);
 
         // Add header to the map
-        m_headers[ header_name ] = header_value;
+        this->m_setHeader(header_name, header_value.data(),
+                          header_value.size());
     }
 }
 
@@ -85,7 +141,8 @@ void Response::setHeaders(std::string headers)
         std::string header_value = header.substr(header.find(":") + 1);
 
         // Add header to the map
-        m_headers[ header_name ] = header_value;
+        this->m_setHeader(header_name, header_value.data(),
+                          header_value.size());
     }
 }
 
@@ -98,7 +155,7 @@ void Response::addHeader(HttpHeader header, std::string value)
 // Add a header to the map - string, string input
 void Response::addHeader(std::string header, std::string value)
 {
-    m_headers[ header ] = value;
+    this->m_setHeader(header, value.data(), value.size());
 }
 
 // Add a header to the map - single string input
@@ -124,16 +181,29 @@ void Response::addCookie(std::string key, std::string value)
 // Add Cookie Headers to the response
 void Response::addCookieHeaders()
 {
+    static const char attributes[] = "; HttpOnly; Secure; SameSite=Strict;";
     for (std::map<std::string, std::string>::const_iterator it =
              m_cookies.begin();
          it != m_cookies.end(); ++it)
     {
-        // Construct the Set-Cookie header for the current cookie
-        std::string cookie_header = it->first + "=" + it->second +
-                                    "; HttpOnly; Secure; SameSite=Strict;";
+        // Construct the Set-Cookie header for the current cookie, in the
+        // arena
+        size_t size = it->first.size() + 1 + it->second.size() +
+                      sizeof(attributes) - 1;
+        char *cookie_header = static_cast<char *>(m_arena.allocate(size));
+        char *end =
+            std::copy(it->first.begin(), it->first.end(), cookie_header);
+        *end++ = '=';
+        end = std::copy(it->second.begin(), it->second.end(), end);
+        std::copy(attributes, attributes + sizeof(attributes) - 1, end);
 
         // Add the Set-Cookie header to the response
-        this->addHeader(SET_COOKIE, cookie_header);
+        ArenaString value = {cookie_header, size};
+        std::pair<HeaderMap_t::iterator, bool> header = m_headers.insert(
+            std::make_pair(m_http_helper.httpHeaderStringMap(SET_COOKIE),
+                           value));
+        if (!header.second)
+            header.first->second = value;
     }
 }
 
@@ -146,10 +216,39 @@ void Response::setBody(std::string body)
 // Setter for body - vector of chars input
 void Response::setBody(std::vector<char> body)
 {
+    this->m_closeBodyFile();
     m_body = body;
     m_content_length = body.size();
 }
 
+// Setter for body - file input, size bytes from an offset, the response owns
+// the descriptor until it is released
+void Response::setBodyFile(int file_descriptor, off_t offset, size_t size)
+{
+    this->m_closeBodyFile();
+    m_body.clear();
+    m_body_file_descriptor = file_descriptor;
+    m_body_file_offset = offset;
+    m_content_length = size;
+}
+
+// Check if the body is a file
+bool Response::hasBodyFile() const { return m_body_file_descriptor != -1; }
+
+// Hand the body file descriptor over to the caller
+int Response::releaseBodyFile()
+{
+    int file_descriptor = m_body_file_descriptor;
+    m_body_file_descriptor = -1;
+    return file_descriptor;
+}
+
+// Getter for the offset of the body in the body file
+off_t Response::getBodyFileOffset() const { return m_body_file_offset; }
+
+// Getter for the body size, whether it is in memory or in a file
+size_t Response::getContentLength() const { return m_content_length; }
+
 // Set all response fields from a status code
 void Response::setErrorResponse(HttpStatusCode status_code)
 {
@@ -159,7 +258,6 @@ void Response::setErrorResponse(HttpStatusCode status_code)
                      "content-length: " +
                      Converter::toString(body.length()) +
                      "\r\n"
-                     "connection: close\r\n"
                      "server: webserv/1.0\r\n");
     this->setBody(body);
 }
@@ -177,7 +275,6 @@ void Response::setRedirectResponse(std::string location)
     this->setHeaders("location: " + location +
                      "\r\n"
                      "content-length: 0\r\n"
-                     "connection: close\r\n"
                      "server: webserv/1.0\r\n");
 }
 
@@ -244,8 +341,6 @@ void Response::setCgiResponse(std::vector<char> response)
                         Converter::toString(m_body.size()));
     if (m_headers.find("content-type") == m_headers.end())
         this->addHeader("content-type: text/html");
-    if (m_headers.find("connection") == m_headers.end())
-        this->addHeader("connection: close");
     if (m_headers.find("server") == m_headers.end())
         this->addHeader("server: webserv/1.0");
 }
@@ -259,14 +354,14 @@ std::string Response::getStatusCodeString() const
 // Calculate the size of the response
 std::string Response::getResponseSizeString() const
 {
-    return Converter::toString(m_status_line.length() +
-                               this->getHeaders().length() + m_body.size());
+    return Converter::toString(this->getResponseSize());
 }
 
 // Calculate the size of the response in bytes
 size_t Response::getResponseSize() const
 {
-    return m_status_line.length() + this->getHeaders().length() + m_body.size();
+    return m_status_line.length() + this->m_getHeadersSize() +
+           m_content_length;
 }
 
 // Get the map of cookies
@@ -289,31 +384,68 @@ std::string Response::getCookie(const std::string &key) const
 // Convert headers to a map of strings
 std::map<std::string, std::string> Response::getHeadersStringMap() const
 {
-    return m_headers;
+    std::map<std::string, std::string> headers;
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
+         it != m_headers.end(); it++)
+        headers[ it->first ] = it->second.str();
+    return headers;
 }
 
 // Serialise the response into a vector of chars
 std::vector<char> Response::serialise()
 {
-    std::vector<char> response;
+    std::vector<char> response = this->serialiseHead();
+
+    // Add body, a file body is left out to be sent from its descriptor
+    response.insert(response.end(), m_body.begin(), m_body.end());
+
+    // Return the serialised response
+    return response;
+}
+
+// Serialise the status line and the headers, up to the blank line
+std::vector<char> Response::serialiseHead()
+{
+    std::vector<char> head;
+
+    // Add cookies and the date to the headers first, then size the head once
+    this->addCookieHeaders();
+    if (m_headers.find("date") == m_headers.end())
+    {
+        const std::string &date = m_clock.getHttpDate();
+        this->m_setHeader("date", date.data(), date.size());
+    }
+    head.reserve(m_status_line.size() + this->m_getHeadersSize() + 2);
 
     // Add status line
-    response.insert(response.end(), m_status_line.begin(), m_status_line.end());
+    head.insert(head.end(), m_status_line.begin(), m_status_line.end());
 
-    // Add headers
-    this->addCookieHeaders(); // Add cookies to the headers first
-    const std::string &headers = this->getHeaders();
-    response.insert(response.end(), headers.begin(), headers.end());
+    // Add headers, in the format "HeaderName: Value\r\n"
+    for (HeaderMap_t::const_iterator it = m_headers.begin();
+         it != m_headers.end(); it++)
+    {
+        head.insert(head.end(), it->first.begin(), it->first.end());
+        head.push_back(':');
+        head.push_back(' ');
+        head.insert(head.end(), it->second.data,
+                    it->second.data + it->second.size);
+        head.push_back('\r');
+        head.push_back('\n');
+    }
 
     // Add a blank line
-    response.push_back('\r');
-    response.push_back('\n');
+    head.push_back('\r');
+    head.push_back('\n');
 
-    // Add body
-    response.insert(response.end(), m_body.begin(), m_body.end());
+    // Return the serialised head
+    return head;
+}
 
-    // Return the serialised response
-    return response;
+// Hand the in-memory body over to the caller, leaving it empty
+void Response::releaseBody(std::vector<char> &body)
+{
+    body.clear();
+    body.swap(m_body);
 }
 
 // Append data to the buffer
@@ -322,4 +454,12 @@ void Response::appendBuffer(std::vector<char> &data)
     m_buffer.insert(m_buffer.end(), data.begin(), data.end());
 }
 
+// Close the body file if the response still owns one
+void Response::m_closeBodyFile()
+{
+    if (m_body_file_descriptor != -1)
+        close(m_body_file_descriptor);
+    m_body_file_descriptor = -1;
+}
+
 // Path: srcs/Response.cpp
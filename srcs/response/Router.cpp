@@ -15,18 +15,26 @@
 'Route', ie the Router selects the correct locationblock)*/
 
 // Constructor
-Router::Router(IConfiguration &configuration, ILogger &logger)
+Router::Router(IConfiguration &configuration, ILogger &logger,
+               const IClock &clock)
     : m_configuration(configuration), m_logger(logger),
-      m_http_helper(HttpHelper(configuration))
+      m_http_helper(HttpHelper(configuration)),
+      m_open_file_cache(clock, *configuration.getBlocks("http")[ 0 ])
 {
     // Log the creation of the Router
-    m_logger.log(VERBOSE, "Initializing Router...");
-
-    // Create the response generators
-    m_response_generators[ "GET" ] = new StaticFileResponseGenerator(logger);
-    m_response_generators[ "POST" ] = new UploadResponseGenerator(logger);
-    m_response_generators[ "PUT" ] = new UploadResponseGenerator(logger);
-    m_response_generators[ "DELETE" ] = new DeleteResponseGenerator(logger);
+    LOG(m_logger, VERBOSE, "Initializing Router...");
+
+    // Create the response generators, sharing the open file cache so that
+    // the files changed by uploads and deletions are looked up again
+    m_response_generators[ "GET" ] = new StaticFileResponseGenerator(
+        logger, clock, *configuration.getBlocks("http")[ 0 ],
+        m_open_file_cache);
+    m_response_generators[ "POST" ] =
+        new UploadResponseGenerator(logger, m_open_file_cache);
+    m_response_generators[ "PUT" ] =
+        new UploadResponseGenerator(logger, m_open_file_cache);
+    m_response_generators[ "DELETE" ] =
+        new DeleteResponseGenerator(logger, m_open_file_cache);
     // m_response_generators["CGI"] = NULL;
 
     const BlockList &servers =
@@ -47,7 +55,7 @@ Router::Router(IConfiguration &configuration, ILogger &logger)
 Router::~Router()
 {
     // Log the destruction of the Router
-    m_logger.log(VERBOSE, "Router destroyed.");
+    LOG(m_logger, VERBOSE, "Router destroyed.");
 
     // Delete the ResponseGenerators
     std::map<std::string, IResponseGenerator *>::iterator it;
@@ -92,7 +100,12 @@ IRoute *Router::getRoute(IRequest *request, IResponse *response)
         m_http_helper.httpMethodStringMap(request->getMethod());
     IResponseGenerator *response_generator =
         m_response_generators[ method_str ];
+    // Requests are routed before their body arrives, match them on the size
+    // they announce
     size_t body_size = request->getBody().size();
+    long content_length = atol(request->getContentLength().c_str());
+    if (content_length > 0 && static_cast<size_t>(content_length) > body_size)
+        body_size = content_length;
 
     // Match the request to a route
     (void)response;
@@ -136,6 +149,10 @@ IRoute *Router::getRoute(IRequest *request, IResponse *response)
     {
         throw HttpStatusCodeException(METHOD_NOT_ALLOWED);
     }
+    if (body_size > route->getClientMaxBodySize())
+    {
+        throw HttpStatusCodeException(PAYLOAD_TOO_LARGE);
+    }
     route->setResponseGenerator(response_generator);
     return route;
 }
@@ -274,23 +291,21 @@ void Router::m_createRoutes(IConfiguration &server,
             route =
                 new Route(path, is_regex, methods, root, index, cgi_path,
                           matcher, client_max_body_size, redirects, autoindex);
-            m_logger.log(VERBOSE, "[Router] New location: '" + path +
-                                      "',  methods: '" + methods_string +
-                                      "', root: '" + root + "', index: '" +
-                                      index + "', cgi script: '" + cgi_script +
-                                      "'." + "CGI" +
-                                      server.getString("server_name"));
+            LOG(m_logger, VERBOSE,
+                "[Router] New location: '" + path + "',  methods: '" +
+                    methods_string + "', root: '" + root + "', index: '" +
+                    index + "', cgi script: '" + cgi_script + "'." + "CGI" +
+                    server.getString("server_name"));
             route->setResponseGenerator(cgi_rg);
             routes.push_back(route);
             m_response_generators[ cgi_path ] = cgi_rg;
         }
         if (!cgi_route)
         {
-            m_logger.log(VERBOSE, "[Router] New location: '" + path +
-                                      "',  methods: '" + methods_string +
-                                      "', root: '" + root + "', index: '" +
-                                      index + "', cgi script: '" + cgi_script +
-                                      "'.");
+            LOG(m_logger, VERBOSE,
+                "[Router] New location: '" + path + "',  methods: '" +
+                    methods_string + "', root: '" + root + "', index: '" +
+                    index + "', cgi script: '" + cgi_script + "'.");
             route = new Route(path, is_regex, methods, root, index,
                               client_max_body_size, redirects, autoindex);
             // route->setResponseGenerator(m_response_generators["GET"]);
@@ -304,8 +319,8 @@ void Router::m_createRoutes(IConfiguration &server,
     // print all the route paths
     for (size_t i = 0; i < routes.size(); i++)
     {
-        m_logger.log(VERBOSE,
-                     "[Router] Route path: '" + routes[ i ]->getPath() + "'.");
+        LOG(m_logger, VERBOSE, "[Router] Route path: '" +
+                               routes[ i ]->getPath() + "'.");
     }
 }
 
@@ -318,10 +333,10 @@ Triplet_t Router::execRoute(IRoute *route, IRequest *request,
         *route, *request, *response, m_configuration);
 
     // print return value
-    m_logger.log(DEBUG,
-                 "Return value: " + Converter::toString(return_value.first) +
-                     " " + Converter::toString(return_value.second.first) +
-                     " " + Converter::toString(return_value.second.second));
+    LOG(m_logger, DEBUG, "Return value: " +
+                         Converter::toString(return_value.first) + " " +
+                         Converter::toString(return_value.second.first) + " " +
+                         Converter::toString(return_value.second.second));
 
     // return the return value
     return return_value;
@@ -1,12 +1,27 @@
 #include "../../includes/response/StaticFileResponseGenerator.hpp"
 #include "../../includes/utils/Converter.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <dirent.h>
-#include <fstream>
 #include <sys/stat.h>
-
-// Constructor
-StaticFileResponseGenerator::StaticFileResponseGenerator(ILogger &logger)
-    : m_mime_types(m_initialiseMimeTypes()), m_logger(logger)
+#include <unistd.h>
+
+// Constructor, reads the sendfile, file_cache and *_static directives of the
+// http block, the open file cache being shared with the other generators
+StaticFileResponseGenerator::StaticFileResponseGenerator(
+    ILogger &logger, const IClock &clock, const IConfiguration &http,
+    OpenFileCache &open_file_cache)
+    : m_mime_types(m_initialiseMimeTypes()), m_logger(logger), m_clock(clock),
+      m_open_file_cache(open_file_cache),
+      m_sendfile(http.getBool("sendfile")),
+      m_file_cache(clock, http.getSize_t("file_cache_size"),
+                   http.getSize_t("file_cache_max_file_size"),
+                   http.getSize_t("file_cache_valid")),
+      m_boundary(static_cast<unsigned long>(time(NULL))),
+      m_gzip_static(http.getBool("gzip_static")),
+      m_brotli_static(http.getBool("brotli_static"))
 {
 }
 
@@ -37,15 +52,37 @@ Triplet_t StaticFileResponseGenerator::generateResponse(
     }
     std::string file_path = root + uri;
 
+    // serve the hot files from memory, without touching the filesystem,
+    // ranges being served from the file
+    // A client accepting compressed files gets the cached sidecars, and
+    // otherwise looks for the sidecars on disk before getting the file
+    const FileCacheEntry *entry = NULL;
+    if (request.getHeaderValue(RANGE).empty())
+    {
+        std::vector<Encoding_t> encodings = m_getAcceptedEncodings(request);
+        for (size_t i = 0; i < encodings.size() && entry == NULL; i++)
+            entry = m_file_cache.lookup(file_path + encodings[ i ].second);
+        if (encodings.empty())
+            entry = m_file_cache.lookup(file_path);
+    }
+    if (entry != NULL)
+    {
+        if (m_isNotModified(request, entry->etag, entry->modified))
+            m_serveNotModified(entry->etag, entry->last_modified, response);
+        else
+            m_serveCachedFile(*entry, response);
+        return Triplet_t(-1, std::make_pair(0, 0));
+    }
+
     // check if the file_path is a directory
+    std::string directory_path = file_path;
     if (m_isDirectory(file_path))
     {
-        std::string directory_path = file_path;
 
         // log the situation
-        m_logger.log(VERBOSE, "Directory requested: " + file_path +
-                                  " serving index file: " + file_path +
-                                  route.getIndex());
+        LOG(m_logger, VERBOSE, "Directory requested: " + file_path +
+                               " serving index file: " + file_path +
+                               route.getIndex());
 
         // append a slash to the file path if needed
         if (file_path.size() > 1 && file_path[ file_path.size() - 1 ] != '/')
@@ -54,7 +91,7 @@ Triplet_t StaticFileResponseGenerator::generateResponse(
         // append the default file name
         file_path += route.getIndex();
 
-        if (m_serveFile(file_path, response) == -1)
+        if (m_serveFile(file_path, request, response, directory_path) == -1)
         {
             if (route.autoindex() == false)
             {
@@ -64,8 +101,8 @@ Triplet_t StaticFileResponseGenerator::generateResponse(
             else
             {
                 // log the situation
-                m_logger.log(VERBOSE,
-                             "Serving directory listing: " + directory_path);
+                LOG(m_logger, VERBOSE, "Serving directory listing: " +
+                                       directory_path);
                 // serve the directory listing
                 m_serveDirectoryListing(directory_path, response);
             }
@@ -74,7 +111,7 @@ Triplet_t StaticFileResponseGenerator::generateResponse(
     else
     {
         // serve the file
-        if (m_serveFile(file_path, response) == -1)
+        if (m_serveFile(file_path, request, response, file_path) == -1)
         {
             // set the error response
             response.setErrorResponse(NOT_FOUND);
@@ -147,10 +184,10 @@ StaticFileResponseGenerator::m_initialiseMimeTypes() const
 }
 
 // Check if a path is a directory
-bool StaticFileResponseGenerator::m_isDirectory(const std::string &path) const
+bool StaticFileResponseGenerator::m_isDirectory(const std::string &path)
 {
     struct stat info;
-    if (stat(path.c_str(), &info) != 0)
+    if (m_open_file_cache.stat(path, info) != 0)
         return false; // path does not exist
     else if (info.st_mode & S_IFDIR)
         return true; // path is a directory
@@ -158,62 +195,489 @@ bool StaticFileResponseGenerator::m_isDirectory(const std::string &path) const
         return false; // path is a file
 }
 
-// Serve a file
+// Serve a file, keeping it in the cache under a key if it is worth it
 int StaticFileResponseGenerator::m_serveFile(const std::string &file_path,
-                                             IResponse &response)
+                                             const IRequest &request,
+                                             IResponse &response,
+                                             const std::string &cache_key)
 {
-    // open the file in binary mode, in read mode and at the end
-    std::ifstream file(file_path.c_str(),
-                       std::ios::in | std::ios::binary | std::ios::ate);
-    if (!file.is_open())
+    ServedFile file;
+    file.path = file_path;
+    file.cache_key = cache_key;
+    file.content_type = m_getMimeType(file_path);
+
+    // serve the precompressed sidecar of the file, the best encoding the
+    // client accepts first, the open file cache knowing the missing ones
+    struct stat info;
+    std::vector<Encoding_t> encodings = m_getAcceptedEncodings(request);
+    for (size_t i = 0; i < encodings.size(); i++)
+    {
+        std::string sidecar_path = file_path + encodings[ i ].second;
+        if (m_open_file_cache.stat(sidecar_path, info) == 0 &&
+            S_ISREG(info.st_mode))
+        {
+            file.path = sidecar_path;
+            file.cache_key = cache_key + encodings[ i ].second;
+            file.content_encoding = encodings[ i ].first;
+            break;
+        }
+    }
+
+    // answer the conditional requests from the metadata alone, without
+    // opening the file
+    if (!request.getHeaderValue(IF_NONE_MATCH).empty() ||
+        !request.getHeaderValue(IF_MODIFIED_SINCE).empty())
+    {
+        if (m_open_file_cache.stat(file.path, info) == -1)
+        {
+            // log the error
+            m_logger.log(ERROR, "Could not open file: " + file.path);
+
+            return -1;
+        }
+        std::string etag = FileCache::makeEntityTag(info);
+        if (S_ISREG(info.st_mode) &&
+            m_isNotModified(request, etag, info.st_mtime))
+        {
+            m_serveNotModified(etag, FileCache::makeLastModified(info),
+                               response);
+            return 0;
+        }
+    }
+
+    // serve the file from memory if it was cached since, as the clients
+    // accepting sidecars skipped the cache to look for them
+    const FileCacheEntry *entry = NULL;
+    std::string range = request.getHeaderValue(RANGE);
+    if (range.empty() && !encodings.empty())
+        entry = m_file_cache.lookup(file.cache_key);
+    if (entry != NULL)
+    {
+        m_serveCachedFile(*entry, response);
+        return 0;
+    }
+
+    // open the file, a missing file being known without a lookup if the
+    // open file cache remembers it
+    int file_descriptor = m_open_file_cache.open(file.path, info);
+    if (file_descriptor == -1)
     {
         // log the error
-        m_logger.log(ERROR, "Could not open file: " + file_path);
+        m_logger.log(ERROR, "Could not open file: " + file.path);
 
         return -1;
     }
-    else
+
+    // log the file being served
+    LOG(m_logger, VERBOSE, "Serving file: " + file.path);
+
+    // serve the requested ranges of the file, unless it changed since the
+    // client got its first part
+    if (!range.empty() && m_isRangeFresh(request, info))
+    {
+        std::vector<ByteRange_t> ranges;
+        if (m_parseRanges(range, info.st_size, ranges) != -1)
+            return m_serveRanges(file, file_descriptor, info, ranges,
+                                 response);
+    }
+
+    // serve the file from memory if it fits in the cache
+    entry = m_file_cache.load(file.cache_key, file.path, file_descriptor,
+                              info, file.content_type, file.content_encoding);
+    if (entry != NULL)
+    {
+        close(file_descriptor);
+        m_serveCachedFile(*entry, response);
+        return 0;
+    }
+
+    // leave the file content out of memory if sendfile is on
+    if (m_sendfile)
     {
-        // log the file being served
-        m_logger.log(VERBOSE, "Serving file: " + file_path);
+        m_serveFileDescriptor(file, file_descriptor, info, response);
+        return 0;
+    }
+
+    // read the file into the body
+    std::vector<char> body(info.st_size);
+    bool read = FileCache::readFile(file_descriptor, body);
+    close(file_descriptor);
+
+    // check if the file was read successfully
+    if (!read)
+    {
+        // log the error
+        m_logger.log(ERROR, "Error reading file: " + file.path);
+
+        // set the response
+        response.setErrorResponse(INTERNAL_SERVER_ERROR);
 
-        // get the size of the file
-        std::streampos size = file.tellg();
+        return -2;
+    }
 
-        // set the position of the file to the beginning
-        file.seekg(0, std::ios::beg);
+    // set the response
+    response.setBody(body);
+    response.setStatusLine(OK);
+    response.addHeader(CONTENT_LENGTH, Converter::toString(body.size()));
+    m_addFileHeaders(file, info, response);
 
-        // read the file into the body
-        std::vector<char> body(size);
-        file.read(&body[ 0 ], size);
+    return 0;
+}
 
-        // check if the file was read successfully
-        if (!file)
+// Get the encodings of the sidecars the client accepts, best first
+// Accept-Encoding lists codings with an optional weight, "*" standing for the
+// codings not listed and a weight of 0 refusing a coding
+std::vector<Encoding_t>
+StaticFileResponseGenerator::m_getAcceptedEncodings(
+    const IRequest &request) const
+{
+    std::vector<Encoding_t> encodings;
+    if (!m_gzip_static && !m_brotli_static)
+        return encodings;
+    std::string accept_encoding = request.getHeaderValue(ACCEPT_ENCODING);
+    if (accept_encoding.empty())
+        return encodings;
+
+    // weights of the codings, -1 if not listed
+    double brotli = -1;
+    double gzip = -1;
+    double any = -1;
+    size_t position = 0;
+    while (position < accept_encoding.size())
+    {
+        size_t end = accept_encoding.find(',', position);
+        if (end == std::string::npos)
+            end = accept_encoding.size();
+        std::string coding = accept_encoding.substr(position, end - position);
+        position = end + 1;
+
+        // the weight follows the coding, 1 if missing
+        double weight = 1;
+        size_t parameter = coding.find(';');
+        if (parameter != std::string::npos)
         {
-            // log the error
-            m_logger.log(ERROR, "Error reading file: " + file_path);
+            size_t q = coding.find("q=", parameter);
+            if (q != std::string::npos)
+                weight = strtod(coding.c_str() + q + 2, NULL);
+            coding.erase(parameter);
+        }
+        coding.erase(0, coding.find_first_not_of(" \t"));
+        coding.erase(coding.find_last_not_of(" \t") + 1);
+        for (size_t i = 0; i < coding.size(); i++)
+            coding[ i ] = tolower(coding[ i ]);
+        if (coding == "br")
+            brotli = weight;
+        else if (coding == "gzip" || coding == "x-gzip")
+            gzip = weight;
+        else if (coding == "*")
+            any = weight;
+    }
+    if (brotli == -1)
+        brotli = any;
+    if (gzip == -1)
+        gzip = any;
+
+    // brotli is the more compact, it wins ties
+    if (m_brotli_static && brotli > 0 && brotli >= gzip)
+        encodings.push_back(Encoding_t("br", ".br"));
+    if (m_gzip_static && gzip > 0)
+        encodings.push_back(Encoding_t("gzip", ".gz"));
+    if (m_brotli_static && brotli > 0 && brotli < gzip)
+        encodings.push_back(Encoding_t("br", ".br"));
+    return encodings;
+}
 
-            // set the response
-            response.setErrorResponse(INTERNAL_SERVER_ERROR);
+// Add the headers describing a file served whole or in part
+void StaticFileResponseGenerator::m_addFileHeaders(const ServedFile &file,
+                                                   const struct stat &info,
+                                                   IResponse &response) const
+{
+    response.addHeader(CONTENT_TYPE, file.content_type);
+    response.addHeader(ETAG, FileCache::makeEntityTag(info));
+    response.addHeader(LAST_MODIFIED, FileCache::makeLastModified(info));
+    response.addHeader(ACCEPT_RANGES, "bytes");
+    if (!file.content_encoding.empty())
+        response.addHeader(CONTENT_ENCODING, file.content_encoding);
+
+    // the file served depends on Accept-Encoding once sidecars are served
+    if (m_gzip_static || m_brotli_static)
+        response.addHeader(VARY, "Accept-Encoding");
+}
 
-            return -2;
+// Check if the validators of a request match the file, so that the copy of
+// the client can be used
+// If-None-Match is compared weakly and takes precedence over
+// If-Modified-Since, as RFC 9110 requires
+bool StaticFileResponseGenerator::m_isNotModified(const IRequest &request,
+                                                  const std::string &etag,
+                                                  time_t modified) const
+{
+    std::string if_none_match = request.getHeaderValue(IF_NONE_MATCH);
+    if (!if_none_match.empty())
+    {
+        // compare the opaque tags, without the weakness prefix
+        std::string opaque_tag = etag.substr(etag.find('"'));
+        size_t position = 0;
+        while (position < if_none_match.size())
+        {
+            // skip the separators
+            char character = if_none_match[ position ];
+            if (character == ' ' || character == '\t' || character == ',')
+            {
+                position++;
+                continue;
+            }
+            if (character == '*')
+                return true;
+            if (if_none_match.compare(position, 2, "W/") == 0)
+                position += 2;
+
+            // an entity tag runs to its closing quote
+            if (position >= if_none_match.size() ||
+                if_none_match[ position ] != '"')
+                return false;
+            size_t end = if_none_match.find('"', position + 1);
+            if (end == std::string::npos)
+                return false;
+            if (if_none_match.compare(position, end + 1 - position,
+                                      opaque_tag) == 0)
+                return true;
+            position = end + 1;
         }
+        return false;
+    }
+
+    // the file was not modified since the date, an invalid date being
+    // ignored
+    std::string if_modified_since = request.getHeaderValue(IF_MODIFIED_SINCE);
+    if (if_modified_since.empty())
+        return false;
+    time_t since = Converter::fromHttpDate(if_modified_since);
+    return since != -1 && modified <= since;
+}
+
+// Tell the client its copy of the file is still valid, without a body
+void StaticFileResponseGenerator::m_serveNotModified(
+    const std::string &etag, const std::string &last_modified,
+    IResponse &response)
+{
+    response.setStatusLine(NOT_MODIFIED);
+    response.addHeader(ETAG, etag);
+    response.addHeader(LAST_MODIFIED, last_modified);
+    if (m_gzip_static || m_brotli_static)
+        response.addHeader(VARY, "Accept-Encoding");
+}
+
+// Check if the file is still the one the client got its first part of
+// If-Range only matches a strong validator (RFC 9110, 13.1.5). The entity
+// tags are weak, so none matches. A date must be the modification time, and
+// that time strong: a file modified within the current second may still
+// change within it without its Last-Modified changing.
+bool StaticFileResponseGenerator::m_isRangeFresh(const IRequest &request,
+                                                 const struct stat &info) const
+{
+    std::string if_range = request.getHeaderValue(IF_RANGE);
+    if (if_range.empty())
+        return true;
+    if (if_range[ 0 ] == '"' || if_range.compare(0, 2, "W/") == 0)
+        return false;
+    return info.st_mtime < m_clock.getTime() &&
+           Converter::fromHttpDate(if_range) == info.st_mtime;
+}
+
+// Parse the Range header of a request against the size of the file
+// Returns the number of satisfiable ranges, or -1 if the header is to be
+// ignored: invalid, not in bytes, or asking for too many ranges or bytes
+int StaticFileResponseGenerator::m_parseRanges(
+    const std::string &range, off_t size,
+    std::vector<ByteRange_t> &ranges) const
+{
+    if (range.compare(0, 6, "bytes=") != 0)
+        return -1;
+
+    off_t total = 0;
+    size_t position = 6;
+    size_t count = 0;
+    while (position < range.size())
+    {
+        // skip the separators
+        if (range[ position ] == ' ' || range[ position ] == '\t' ||
+            range[ position ] == ',')
+        {
+            position++;
+            continue;
+        }
+        if (++count > RANGE_MAX_RANGES)
+            return -1;
+
+        // first and last positions, either of them possibly missing
+        size_t end = range.find(',', position);
+        if (end == std::string::npos)
+            end = range.size();
+        std::string spec = range.substr(position, end - position);
+        position = end;
+        spec.erase(spec.find_last_not_of(" \t") + 1);
+        size_t dash = spec.find('-');
+        if (dash == std::string::npos ||
+            spec.find_first_not_of("0123456789-") != std::string::npos ||
+            spec.find('-', dash + 1) != std::string::npos ||
+            spec.size() - dash > 19 || dash > 18 || spec.size() == 1)
+            return -1;
+        std::string first = spec.substr(0, dash);
+        std::string last = spec.substr(dash + 1);
+        ByteRange_t byte_range;
+
+        // the suffix of the file, as long as it is not empty
+        if (first.empty())
+        {
+            off_t length = strtoll(last.c_str(), NULL, 10);
+            if (length == 0 || size == 0)
+                continue;
+            byte_range.first = length < size ? size - length : 0;
+            byte_range.second = size - 1;
+        }
+
+        // from a position to another or to the end, clipped to the file
         else
         {
-            // close the file
-            file.close();
+            byte_range.first = strtoll(first.c_str(), NULL, 10);
+            byte_range.second = size - 1;
+            if (!last.empty())
+            {
+                off_t last_position = strtoll(last.c_str(), NULL, 10);
+                if (last_position < byte_range.first)
+                    return -1;
+                if (last_position < byte_range.second)
+                    byte_range.second = last_position;
+            }
+            if (byte_range.first >= size)
+                continue;
+        }
+        total += byte_range.second - byte_range.first + 1;
+        ranges.push_back(byte_range);
+    }
 
-            // set the response
-            response.setBody(body);
-            response.setStatusLine(OK);
-            response.addHeader(CONTENT_TYPE, m_getMimeType(file_path));
-            response.addHeader(CONTENT_LENGTH,
-                               Converter::toString(body.size()));
-            response.addHeader(CONNECTION, "close");
+    // overlapping ranges asking for more than the file are not served, nor
+    // are parts too large to be built in memory
+    if (total > size ||
+        (ranges.size() > 1 && total > RANGE_MULTIPART_MAX_SIZE))
+        return -1;
+    return ranges.size();
+}
+
+// Serve ranges of a file, as a single part from its descriptor or as a
+// multipart/byteranges body, or tell the client none of them can be served
+int StaticFileResponseGenerator::m_serveRanges(
+    const ServedFile &file, int file_descriptor, const struct stat &info,
+    const std::vector<ByteRange_t> &ranges, IResponse &response)
+{
+    std::string size = Converter::toString(info.st_size);
+
+    // none of the ranges overlaps the file
+    if (ranges.empty())
+    {
+        close(file_descriptor);
+        response.setErrorResponse(RANGE_NOT_SATISFIABLE);
+        response.addHeader(CONTENT_RANGE, "bytes */" + size);
+        return 0;
+    }
+
+    response.setStatusLine(PARTIAL_CONTENT);
+    m_addFileHeaders(file, info, response);
 
+    // a single range is sent straight from the file when sendfile is on
+    if (ranges.size() == 1)
+    {
+        off_t length = ranges[ 0 ].second - ranges[ 0 ].first + 1;
+        response.addHeader(CONTENT_LENGTH, Converter::toString(length));
+        response.addHeader(CONTENT_RANGE,
+                           "bytes " + Converter::toString(ranges[ 0 ].first) +
+                               "-" + Converter::toString(ranges[ 0 ].second) +
+                               "/" + size);
+        if (m_sendfile)
+        {
+            response.setBodyFile(file_descriptor, ranges[ 0 ].first, length);
             return 0;
         }
+        std::vector<char> body(length);
+        bool read = FileCache::readFile(file_descriptor, body,
+                                        ranges[ 0 ].first);
+        close(file_descriptor);
+        if (!read)
+        {
+            m_logger.log(ERROR, "Error reading file: " + file.path);
+            response.setErrorResponse(INTERNAL_SERVER_ERROR);
+            return -2;
+        }
+        response.setBody(body);
+        return 0;
+    }
+
+    // several ranges are sent as the parts of a multipart body, each with
+    // its own headers
+    char boundary[ 32 ];
+    snprintf(boundary, sizeof(boundary), "%020lu", ++m_boundary);
+    std::vector<char> body;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        std::string part_head =
+            std::string("\r\n--") + boundary +
+            "\r\nContent-Type: " + file.content_type +
+            "\r\nContent-Range: bytes " +
+            Converter::toString(ranges[ i ].first) + "-" +
+            Converter::toString(ranges[ i ].second) + "/" + size + "\r\n\r\n";
+        body.insert(body.end(), part_head.begin(), part_head.end());
+
+        // read the range after its headers
+        std::vector<char> part(ranges[ i ].second - ranges[ i ].first + 1);
+        if (!FileCache::readFile(file_descriptor, part, ranges[ i ].first))
+        {
+            close(file_descriptor);
+            m_logger.log(ERROR, "Error reading file: " + file.path);
+            response.setErrorResponse(INTERNAL_SERVER_ERROR);
+            return -2;
+        }
+        body.insert(body.end(), part.begin(), part.end());
     }
+    close(file_descriptor);
+    std::string closing = std::string("\r\n--") + boundary + "--\r\n";
+    body.insert(body.end(), closing.begin(), closing.end());
+
+    response.addHeader(CONTENT_TYPE,
+                       std::string("multipart/byteranges; boundary=") +
+                           boundary);
+    response.addHeader(CONTENT_LENGTH, Converter::toString(body.size()));
+    response.setBody(body);
+    return 0;
+}
+
+// Serve a file from the cache
+void StaticFileResponseGenerator::m_serveCachedFile(
+    const FileCacheEntry &entry, IResponse &response)
+{
+    response.setBody(entry.body);
+    response.setStatusLine(OK);
+    response.addHeader(CONTENT_TYPE, entry.content_type);
+    response.addHeader(CONTENT_LENGTH, entry.content_length);
+    response.addHeader(ETAG, entry.etag);
+    response.addHeader(LAST_MODIFIED, entry.last_modified);
+    response.addHeader(ACCEPT_RANGES, "bytes");
+    if (!entry.content_encoding.empty())
+        response.addHeader(CONTENT_ENCODING, entry.content_encoding);
+    if (m_gzip_static || m_brotli_static)
+        response.addHeader(VARY, "Accept-Encoding");
+}
+
+// Serve a file from its descriptor, the body being sent with sendfile
+void StaticFileResponseGenerator::m_serveFileDescriptor(
+    const ServedFile &file, int file_descriptor, const struct stat &info,
+    IResponse &response)
+{
+    // set the response, the descriptor now belongs to it
+    response.setBodyFile(file_descriptor, 0, info.st_size);
+    response.setStatusLine(OK);
+    response.addHeader(CONTENT_LENGTH, Converter::toString(info.st_size));
+    m_addFileHeaders(file, info, response);
 }
 
 // List a directory
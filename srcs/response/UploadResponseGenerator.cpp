@@ -1,9 +1,12 @@
 #include "../../includes/response/UploadResponseGenerator.hpp"
-#include <fstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <sys/stat.h>
 
-UploadResponseGenerator::UploadResponseGenerator(ILogger &logger)
-    : m_logger(logger)
+UploadResponseGenerator::UploadResponseGenerator(
+    ILogger &logger, OpenFileCache &open_file_cache)
+    : m_logger(logger), m_open_file_cache(open_file_cache)
 {
 }
 
@@ -40,24 +43,27 @@ Triplet_t UploadResponseGenerator::generateResponse(
             }
             catch (const std::exception &e)
             {
-                m_logger.log(DEBUG, "Mime Type: " + itr->content_type +
-                                        "not recognized");
+                LOG(m_logger, DEBUG, "Mime Type: " + itr->content_type +
+                                     "not recognized");
             }
         }
-        m_logger.log(DEBUG, "Received upload request for: " + file_path);
+        LOG(m_logger, DEBUG, "Received upload request for: " + file_path);
         // check if file exists.
-        if (stat(file_path.c_str(), &buffer) == 0 && !created)
+        if (m_open_file_cache.stat(file_path, buffer) == 0 && !created)
         {
             created = true;
         }
-        std::ofstream file(file_path.c_str(), std::ios::binary);
-        if (!file.is_open())
+        // the file was streamed to a temporary file in the root as it arrived,
+        // give it its name now that the upload is complete
+        int renamed = rename(itr->file_path.c_str(), file_path.c_str());
+        m_open_file_cache.invalidate(file_path);
+        if (renamed == -1)
         {
-            m_logger.log(ERROR, "Failed to open file for write: " + file_path);
+            m_logger.log(ERROR, "Failed to rename upload to " + file_path +
+                                    ": " + strerror(errno));
             response.setErrorResponse(INTERNAL_SERVER_ERROR);
             return std::make_pair(-1, std::make_pair(-1, -1));
         }
-        file.write(itr->data.data(), itr->data.size());
     }
     // if a file was created set the status to created.
     if (created)
@@ -0,0 +1,71 @@
+#include "../../includes/utils/AllocationCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+/*
+ * AllocationCounter
+ *
+ * Counts the calls to the global operator new, when built with
+ * WEBSERV_ALLOCATION_STATS.
+ */
+
+#ifdef WEBSERV_ALLOCATION_STATS
+
+// Calls to operator new, updated atomically as the log writer thread
+// allocates too
+static size_t s_allocations = 0;
+
+// Allocate memory, counting the call
+static void *countedAllocate(size_t size)
+{
+    __atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new(size_t size) { return countedAllocate(size); }
+
+void *operator new[](size_t size) { return countedAllocate(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) throw()
+{
+    __atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) throw()
+{
+    __atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *memory) throw() { free(memory); }
+
+void operator delete[](void *memory) throw() { free(memory); }
+
+void operator delete(void *memory, size_t) throw() { free(memory); }
+
+void operator delete[](void *memory, size_t) throw() { free(memory); }
+
+// Check if the allocations are counted in this build
+bool AllocationCounter::enabled() { return true; }
+
+// Get the number of calls to operator new made by the process so far
+size_t AllocationCounter::count()
+{
+    return __atomic_load_n(&s_allocations, __ATOMIC_RELAXED);
+}
+
+#else
+
+// Check if the allocations are counted in this build
+bool AllocationCounter::enabled() { return false; }
+
+// Get the number of calls to operator new made by the process so far
+size_t AllocationCounter::count() { return 0; }
+
+#endif // WEBSERV_ALLOCATION_STATS
+
+// Path: srcs/utils/AllocationCounter.cpp
@@ -0,0 +1,89 @@
+#include "../../includes/utils/Arena.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/*
+ * Arena
+ *
+ * Bump allocator for the short-lived objects of a request.
+ */
+
+// Constructor, no memory is allocated until it is needed
+Arena::Arena() : m_block(0), m_offset(0) {}
+
+// Destructor, frees all the blocks
+Arena::~Arena()
+{
+    this->reset();
+    for (size_t i = 0; i < m_blocks.size(); i++)
+        ::operator delete(m_blocks[ i ]);
+}
+
+// Allocate memory, valid until the next reset
+void *Arena::allocate(size_t size)
+{
+    // Round the size up, so that the next allocation stays aligned
+    size = (size + ARENA_ALIGNMENT - 1) & ~static_cast<size_t>(
+                                              ARENA_ALIGNMENT - 1);
+
+    // Large allocations get their own block
+    if (size > ARENA_LARGE_ALLOCATION)
+    {
+        m_large.push_back(::operator new(size));
+        return m_large.back();
+    }
+
+    // Move to the next block when the current one is full, allocating it if
+    // it was never needed before
+    if (m_blocks.empty() || m_offset + size > ARENA_BLOCK_SIZE)
+    {
+        if (!m_blocks.empty())
+            m_block++;
+        if (m_block == m_blocks.size())
+            m_blocks.push_back(
+                static_cast<char *>(::operator new(ARENA_BLOCK_SIZE)));
+        m_offset = 0;
+    }
+
+    // Hand out the memory at the offset
+    void *memory = m_blocks[ m_block ] + m_offset;
+    m_offset += size;
+    return memory;
+}
+
+// Copy a string to a C string, valid until the next reset
+char *Arena::duplicate(const std::string &string)
+{
+    char *copy = static_cast<char *>(this->allocate(string.size() + 1));
+    memcpy(copy, string.c_str(), string.size() + 1);
+    return copy;
+}
+
+// Copy bytes, valid until the next reset
+ArenaString Arena::copy(const char *data, size_t size)
+{
+    ArenaString string = {static_cast<char *>(this->allocate(size)), size};
+    memcpy(const_cast<char *>(string.data), data, size);
+    return string;
+}
+
+// Byte-wise order of arena strings, as for std::string
+bool ArenaStringLess::operator()(const ArenaString &lhs,
+                                 const ArenaString &rhs) const
+{
+    int order = memcmp(lhs.data, rhs.data, std::min(lhs.size, rhs.size));
+    return order < 0 || (order == 0 && lhs.size < rhs.size);
+}
+
+// Forget all the allocations, keeping the blocks for reuse
+void Arena::reset()
+{
+    for (size_t i = 0; i < m_large.size(); i++)
+        ::operator delete(m_large[ i ]);
+    m_large.clear();
+    m_block = 0;
+    m_offset = 0;
+}
+
+// Path: srcs/utils/Arena.cpp
@@ -1,4 +1,6 @@
 #include "../../includes/utils/Converter.hpp"
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
 #include <stdlib.h>
 
@@ -36,3 +38,38 @@ std::string Converter::toString(unsigned long value)
 std::string Converter::toString(long value) { return to_string(value); }
 
 std::string Converter::toString(float value) { return to_string(value); }
+
+// Format a time as an IMF-fixdate, always in English and in GMT
+std::string Converter::toHttpDate(time_t time)
+{
+    static const char *days[] = {"Sun", "Mon", "Tue", "Wed",
+                                 "Thu", "Fri", "Sat"};
+    static const char *months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    struct tm utc_time;
+    gmtime_r(&time, &utc_time);
+    char buffer[ 32 ];
+    snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+             days[ utc_time.tm_wday ], utc_time.tm_mday,
+             months[ utc_time.tm_mon ], utc_time.tm_year + 1900,
+             utc_time.tm_hour, utc_time.tm_min, utc_time.tm_sec);
+    return buffer;
+}
+
+// Parse an HTTP-date, in the IMF-fixdate, RFC 850 or asctime format
+// Returns -1 if the date is not valid
+time_t Converter::fromHttpDate(const std::string &date)
+{
+    static const char *formats[] = {"%a, %d %b %Y %H:%M:%S GMT",
+                                    "%A, %d-%b-%y %H:%M:%S GMT",
+                                    "%a %b %e %H:%M:%S %Y"};
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[ 0 ]); i++)
+    {
+        struct tm utc_time;
+        memset(&utc_time, 0, sizeof(utc_time));
+        const char *end = strptime(date.c_str(), formats[ i ], &utc_time);
+        if (end != NULL && *end == '\0')
+            return timegm(&utc_time);
+    }
+    return -1;
+}
@@ -0,0 +1,157 @@
+#include "../../includes/utils/DelimiterScanner.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DELIMITER_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * DelimiterScanner
+ *
+ * Finds the first occurrence of any of a few delimiter bytes in a buffer.
+ */
+
+// Check one byte at a time
+static const char *scanScalar(const char *begin, const char *end,
+                              const char *delimiters)
+{
+    for (; begin < end; begin++)
+    {
+        char c = *begin;
+        if (c == delimiters[ 0 ] || c == delimiters[ 1 ] ||
+            c == delimiters[ 2 ] || c == delimiters[ 3 ])
+            return begin;
+    }
+    return end;
+}
+
+#ifdef DELIMITER_SCANNER_X86
+
+// Check 16 bytes at a time
+__attribute__((target("sse2"))) static const char *
+scanSse2(const char *begin, const char *end, const char *delimiters)
+{
+    // Broadcast each delimiter to all the lanes
+    const __m128i d0 = _mm_set1_epi8(delimiters[ 0 ]);
+    const __m128i d1 = _mm_set1_epi8(delimiters[ 1 ]);
+    const __m128i d2 = _mm_set1_epi8(delimiters[ 2 ]);
+    const __m128i d3 = _mm_set1_epi8(delimiters[ 3 ]);
+
+    for (; end - begin >= 16; begin += 16)
+    {
+        // Mark the lanes holding a delimiter
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, d0), _mm_cmpeq_epi8(block, d1)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, d2), _mm_cmpeq_epi8(block, d3)));
+
+        // The lowest marked lane is the first delimiter
+        int mask = _mm_movemask_epi8(matches);
+        if (mask != 0)
+            return begin + __builtin_ctz(mask);
+    }
+    return scanScalar(begin, end, delimiters);
+}
+
+// Check 32 bytes at a time
+__attribute__((target("avx2"))) static const char *
+scanAvx2(const char *begin, const char *end, const char *delimiters)
+{
+    // Broadcast each delimiter to all the lanes
+    const __m256i d0 = _mm256_set1_epi8(delimiters[ 0 ]);
+    const __m256i d1 = _mm256_set1_epi8(delimiters[ 1 ]);
+    const __m256i d2 = _mm256_set1_epi8(delimiters[ 2 ]);
+    const __m256i d3 = _mm256_set1_epi8(delimiters[ 3 ]);
+
+    for (; end - begin >= 32; begin += 32)
+    {
+        // Mark the lanes holding a delimiter
+        __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i matches = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, d0),
+                            _mm256_cmpeq_epi8(block, d1)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, d2),
+                            _mm256_cmpeq_epi8(block, d3)));
+
+        // The lowest marked lane is the first delimiter
+        unsigned int mask = _mm256_movemask_epi8(matches);
+        if (mask != 0)
+            return begin + __builtin_ctz(mask);
+    }
+    return scanSse2(begin, end, delimiters);
+}
+
+#endif // DELIMITER_SCANNER_X86
+
+// Implementation picked for this CPU
+const DelimiterScanner::ScanFunction DelimiterScanner::s_scan =
+    DelimiterScanner::m_selectScanFunction();
+
+// Constructor, from a string of 1 to 4 delimiters
+// Scanners for short tokens use the scalar loop
+DelimiterScanner::DelimiterScanner(const char *delimiters, bool short_tokens)
+    : m_scan(short_tokens ? scanScalar : s_scan)
+{
+    // Repeat the last delimiter to fill the set, so that every
+    // implementation can always compare against all of them
+    size_t count = strlen(delimiters);
+    if (count > DELIMITER_SCANNER_MAX_DELIMITERS)
+        count = DELIMITER_SCANNER_MAX_DELIMITERS;
+    for (size_t i = 0; i < DELIMITER_SCANNER_MAX_DELIMITERS; i++)
+        m_delimiters[ i ] = (count == 0) ? '\0'
+                            : delimiters[ i < count ? i : count - 1 ];
+}
+
+// Find the first delimiter in [begin, end), or end if there is none
+const char *DelimiterScanner::find(const char *begin, const char *end) const
+{
+    return m_scan(begin, end, m_delimiters);
+}
+
+// Get the name of the implementation in use
+const char *DelimiterScanner::implementation()
+{
+#ifdef DELIMITER_SCANNER_X86
+    if (s_scan == scanAvx2)
+        return "avx2";
+    if (s_scan == scanSse2)
+        return "sse2";
+#endif
+    return "scalar";
+}
+
+// Get an implementation by name, "avx2", "sse2" or "scalar", or NULL if the
+// CPU does not support it
+DelimiterScanner::ScanFunction
+DelimiterScanner::getScanFunction(const char *name)
+{
+    if (strcmp(name, "scalar") == 0)
+        return scanScalar;
+#ifdef DELIMITER_SCANNER_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+        return scanAvx2;
+    if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2"))
+        return scanSse2;
+#endif
+    return NULL;
+}
+
+// Pick the fastest implementation the CPU supports
+// Without optimization the intrinsics are slower than the scalar loop
+DelimiterScanner::ScanFunction DelimiterScanner::m_selectScanFunction()
+{
+#if defined(DELIMITER_SCANNER_X86) && defined(__OPTIMIZE__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return scanAvx2;
+    if (__builtin_cpu_supports("sse2"))
+        return scanSse2;
+#endif
+    return scanScalar;
+}
+
+// Path: srcs/utils/DelimiterScanner.cpp
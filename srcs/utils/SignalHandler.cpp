@@ -1,10 +1,12 @@
 #include "../../includes/utils/SignalHandler.hpp"
 #include "../../includes/exception/WebservExceptions.hpp"
 #include <csignal>
-#include <cstdlib>
 #include <iostream>
 
-SignalHandler::SignalHandler() : m_sigint_received(0) {}
+// The flag is static: the signal handler receives no pointer to the instance
+volatile sig_atomic_t SignalHandler::m_sigint_received = 0;
+
+SignalHandler::SignalHandler() {}
 
 SignalHandler::~SignalHandler() {}
 
@@ -12,10 +14,8 @@ void SignalHandler::m_sigintHandler(int param, siginfo_t *info, void *context)
 {
     static_cast<void>(param);
     static_cast<void>(info);
-    SignalHandler *handler = static_cast<SignalHandler *>(context);
-    if (!handler)
-        exit(1); // Should not happen
-    handler->m_sigint_received = 1;
+    static_cast<void>(context);
+    m_sigint_received = 1;
 }
 
 void SignalHandler::sigint()
@@ -32,3 +32,5 @@ void SignalHandler::checkState()
     if (m_sigint_received)
         throw SigintException();
 }
+
+bool SignalHandler::sigintReceived() const { return m_sigint_received; }
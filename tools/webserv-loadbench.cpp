@@ -0,0 +1,300 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <pthread.h>
+#include <string>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * webserv-loadbench
+ *
+ * Measures the requests per second a server sustains on keep-alive
+ * connections. Each client is a thread sending a GET for the URL, waiting
+ * for the whole response and sending the next one, for the given number of
+ * seconds. Closed connections are opened again. The result is written to
+ * the standard output:
+ *
+ *   8 clients, 10 s, http://localhost:8080/: 231784 requests, 0 errors,
+ *   23178 req/s
+ *
+ * Usage: webserv-loadbench [clients] [seconds] [url]
+ * The defaults are 8 clients, 10 seconds and http://localhost:8080/.
+ *
+ * tools/webserv-loadbench.conf runs a single worker logging at warn, which
+ * is how the level check of the logger was measured. To compare two
+ * revisions, build each one in its own worktree and run them in turn with
+ * that configuration, from their worktree as the paths are relative:
+ *
+ *   git worktree add ../webserv-before cc56552^
+ *   git worktree add ../webserv-after cc56552
+ *   cd ../webserv-before && make re && ./webserv \
+ *       $OLDPWD/tools/webserv-loadbench.conf
+ *   ./webserv-loadbench 8 10 http://localhost:8080/    (from this tree)
+ *
+ * then stop the server and do the same in ../webserv-after. Older
+ * revisions tracked their object files, hence "make re". Run each side a
+ * few times, alternating, as the first runs warm the page cache.
+ *
+ */
+
+// Default number of clients
+#define LOADBENCH_CLIENTS 8
+
+// Default duration of the measure, in seconds
+#define LOADBENCH_SECONDS 10
+
+// Default URL
+#define LOADBENCH_URL "http://localhost:8080/"
+
+// Size of the reads
+#define LOADBENCH_READ_SIZE 65536
+
+// Target of the clients
+struct Target
+{
+    std::string host;    // Host, as sent in the Host header
+    std::string port;    // Port, "80" if the URL has none
+    std::string path;    // Path of the request
+    std::string request; // Request sent on every turn
+    addrinfo *address;   // Address connected to
+};
+
+// Counters of a client
+struct Client
+{
+    const Target *target;   // Target of the requests
+    double deadline;        // Time the client stops at
+    unsigned long requests; // Complete 2xx or 3xx responses
+    unsigned long errors;   // Other responses and broken connections
+};
+
+// Get the current time, in seconds
+static double now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Split an http:// URL into its host, port and path
+// Returns false if it is not one
+static bool parseUrl(const std::string &url, Target &target)
+{
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0)
+        return false;
+    size_t authority_end = url.find('/', scheme.size());
+    if (authority_end == std::string::npos)
+        authority_end = url.size();
+    std::string authority =
+        url.substr(scheme.size(), authority_end - scheme.size());
+    size_t colon = authority.find(':');
+    target.host = authority;
+    target.port = "80";
+    if (colon != std::string::npos)
+    {
+        target.port = authority.substr(colon + 1);
+        authority.erase(colon);
+    }
+    target.path =
+        authority_end == url.size() ? "/" : url.substr(authority_end);
+    if (authority.empty() || target.port.empty())
+        return false;
+
+    // Resolve the host once, as the request is the same for every client
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int status = getaddrinfo(authority.c_str(), target.port.c_str(), &hints,
+                             &target.address);
+    if (status != 0)
+    {
+        fprintf(stderr, "webserv-loadbench: %s: %s\n", authority.c_str(),
+                gai_strerror(status));
+        return false;
+    }
+    target.request = "GET " + target.path + " HTTP/1.1\r\n" +
+                     "Host: " + target.host + "\r\n" +
+                     "User-Agent: webserv-loadbench\r\n" +
+                     "Accept: */*\r\n" + "Connection: keep-alive\r\n\r\n";
+    return true;
+}
+
+// Open a connection to the target
+// Returns the socket, or -1 on error
+static int openConnection(const Target &target)
+{
+    int socket_descriptor =
+        socket(target.address->ai_family, target.address->ai_socktype,
+               target.address->ai_protocol);
+    if (socket_descriptor == -1)
+        return -1;
+    if (connect(socket_descriptor, target.address->ai_addr,
+                target.address->ai_addrlen) == -1)
+    {
+        close(socket_descriptor);
+        return -1;
+    }
+    return socket_descriptor;
+}
+
+// Find a header field in a response head, name given as "\r\nname:"
+// Returns the start of its value, or NULL if the head has none
+static const char *findHeader(const std::string &head, const char *name)
+{
+    size_t length = strlen(name);
+    for (size_t i = 0; i + length <= head.size(); i++)
+        if (strncasecmp(head.c_str() + i, name, length) == 0)
+            return head.c_str() + i + length;
+    return NULL;
+}
+
+// Send a request and read its response
+// Returns the status code, or -1 if the connection is broken or the
+// response has no length, closing being set if the server closes the
+// connection after the response
+static int exchange(int socket_descriptor, const Target &target,
+                    std::string &buffer, bool &closing)
+{
+    if (send(socket_descriptor, target.request.data(), target.request.size(),
+             MSG_NOSIGNAL) != static_cast<ssize_t>(target.request.size()))
+        return -1;
+
+    // Read up to the end of the head
+    char chunk[ LOADBENCH_READ_SIZE ];
+    size_t head_end;
+    while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos)
+    {
+        ssize_t size = recv(socket_descriptor, chunk, sizeof(chunk), 0);
+        if (size <= 0)
+            return -1;
+        buffer.append(chunk, size);
+    }
+    head_end += 4;
+    std::string head = buffer.substr(0, head_end);
+    const char *content_length = findHeader(head, "\r\ncontent-length:");
+    if (content_length == NULL)
+        return -1;
+    const char *connection = findHeader(head, "\r\nconnection:");
+    if (connection != NULL)
+        connection += strspn(connection, " ");
+    closing = connection != NULL && strncasecmp(connection, "close", 5) == 0;
+
+    // Read the body, keeping the bytes of a next response
+    size_t response_end = head_end + strtoul(content_length, NULL, 10);
+    while (buffer.size() < response_end)
+    {
+        ssize_t size = recv(socket_descriptor, chunk, sizeof(chunk), 0);
+        if (size <= 0)
+            return -1;
+        buffer.append(chunk, size);
+    }
+
+    // The status code follows "HTTP/1.1 "
+    int status = atoi(buffer.c_str() + strlen("HTTP/1.1 "));
+    buffer.erase(0, response_end);
+    return status;
+}
+
+// Run a client until its deadline
+static void *runClient(void *argument)
+{
+    Client &client = *static_cast<Client *>(argument);
+    std::string buffer;
+    int socket_descriptor = -1;
+    while (now() < client.deadline)
+    {
+        // Open the connection again if the server closed it
+        if (socket_descriptor == -1)
+        {
+            buffer.clear();
+            socket_descriptor = openConnection(*client.target);
+            if (socket_descriptor == -1)
+            {
+                client.errors++;
+                usleep(1000);
+                continue;
+            }
+        }
+
+        bool closing = false;
+        int status =
+            exchange(socket_descriptor, *client.target, buffer, closing);
+        if (status >= 200 && status < 400)
+            client.requests++;
+        else
+            client.errors++;
+        if (status == -1 || closing)
+        {
+            close(socket_descriptor);
+            socket_descriptor = -1;
+        }
+    }
+    if (socket_descriptor != -1)
+        close(socket_descriptor);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int clients = LOADBENCH_CLIENTS;
+    int seconds = LOADBENCH_SECONDS;
+    std::string url = LOADBENCH_URL;
+    if (argc > 1)
+        clients = atoi(argv[ 1 ]);
+    if (argc > 2)
+        seconds = atoi(argv[ 2 ]);
+    if (argc > 3)
+        url = argv[ 3 ];
+    Target target;
+    if (argc > 4 || clients <= 0 || seconds <= 0 || !parseUrl(url, target))
+    {
+        fprintf(stderr,
+                "usage: webserv-loadbench [clients] [seconds] [url]\n");
+        return 2;
+    }
+
+    // Start the clients together
+    std::vector<Client> states(clients);
+    std::vector<pthread_t> threads(clients);
+    double start = now();
+    for (int i = 0; i < clients; i++)
+    {
+        states[ i ].target = &target;
+        states[ i ].deadline = start + seconds;
+        states[ i ].requests = 0;
+        states[ i ].errors = 0;
+        int error =
+            pthread_create(&threads[ i ], NULL, runClient, &states[ i ]);
+        if (error != 0)
+        {
+            fprintf(stderr, "webserv-loadbench: pthread_create: %s\n",
+                    strerror(error));
+            return 1;
+        }
+    }
+
+    // Sum the counters once they are all done
+    unsigned long requests = 0;
+    unsigned long errors = 0;
+    for (int i = 0; i < clients; i++)
+    {
+        pthread_join(threads[ i ], NULL);
+        requests += states[ i ].requests;
+        errors += states[ i ].errors;
+    }
+    double elapsed = now() - start;
+    freeaddrinfo(target.address);
+
+    printf("%d clients, %d s, %s: %lu requests, %lu errors, %.0f req/s\n",
+           clients, seconds, url.c_str(), requests, errors,
+           requests / elapsed);
+    return errors == 0 ? 0 : 1;
+}
+
+// Path: tools/webserv-loadbench.cpp
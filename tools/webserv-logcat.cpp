@@ -0,0 +1,382 @@
+#include "../includes/constants/HttpMethodHelper.hpp"
+#include "../includes/logger/BinaryLogRecord.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * webserv-logcat
+ *
+ * Decodes the binary access logs of webserv, see
+ * includes/logger/BinaryLogRecord.hpp, and writes one line per request to
+ * the standard output:
+ *
+ *   2011-01-01T01:11:11.123456Z 127.0.0.1 GET "/index.html" 200 4321
+ *   0.000125 "curl/8.0"
+ *
+ * or, with -j, one JSON object per request with the fields of the "json"
+ * access log format.
+ *
+ * A record torn by a short write is skipped up to the next magic number, the
+ * number of bytes skipped being reported on the standard error.
+ *
+ * Usage: webserv-logcat [-j] [file ...]
+ * The standard input is read if no file is given.
+ *
+ */
+
+// Size of the reads
+#define LOGCAT_READ_SIZE 65536
+
+// String tables, by pid then offset
+typedef std::map<uint32_t, std::map<uint32_t, std::string> > StringTables_t;
+
+// Decoding state, carried from a read to the next
+struct Decoder
+{
+    bool json;                // Write JSON lines
+    StringTables_t tables;    // String tables of the workers
+    std::string output;       // Lines waiting to be written
+    HttpMethodHelper methods; // Names of the methods
+    size_t records;           // Records decoded in the current file
+    size_t skipped;           // Bytes skipped in the current file
+};
+
+// Write the lines waiting in the output
+static void flushOutput(Decoder &decoder)
+{
+    size_t written = 0;
+    while (written < decoder.output.size())
+    {
+        ssize_t bytes = write(STDOUT_FILENO, decoder.output.data() + written,
+                              decoder.output.size() - written);
+        if (bytes == -1 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+            break;
+        written += bytes;
+    }
+    decoder.output.clear();
+}
+
+// Append a string, escaped for JSON or quoted text
+static void appendString(std::string &output, const std::string &string,
+                         bool json)
+{
+    static const char hex[] = "0123456789abcdef";
+    output += '"';
+    for (size_t i = 0; i < string.size(); i++)
+    {
+        unsigned char character = string[ i ];
+        if (character == '"' || character == '\\')
+        {
+            output += '\\';
+            output += character;
+        }
+        else if (character < 0x20 || (!json && character >= 0x7f))
+        {
+            output += json ? "\\u00" : "\\x";
+            output += hex[ character >> 4 ];
+            output += hex[ character & 0xf ];
+        }
+        else
+            output += character;
+    }
+    output += '"';
+}
+
+// Get a string of a table, empty if it was never written
+static const std::string &getString(Decoder &decoder, uint32_t pid,
+                                    uint32_t offset)
+{
+    static const std::string empty;
+    std::map<uint32_t, std::string> &table = decoder.tables[ pid ];
+    std::map<uint32_t, std::string>::const_iterator it = table.find(offset);
+    return it == table.end() ? empty : it->second;
+}
+
+// Append the line of an access record
+static void appendAccess(Decoder &decoder, const BinaryLogAccess &access)
+{
+    char buffer[ 128 ];
+    std::string &output = decoder.output;
+
+    // Time, in UTC with the microseconds
+    time_t seconds = access.time / 1000000;
+    struct tm utc_time;
+    gmtime_r(&seconds, &utc_time);
+    size_t length =
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc_time);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%06luZ",
+             static_cast<unsigned long>(access.time % 1000000));
+    std::string time = buffer;
+
+    // Client address
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", access.client_ip >> 24,
+             (access.client_ip >> 16) & 0xff, (access.client_ip >> 8) & 0xff,
+             access.client_ip & 0xff);
+    std::string client_ip = buffer;
+
+    // Method, "-" if the request was too broken to have one
+    std::string method = "-";
+    if (access.method <= CONNECT)
+        method = decoder.methods.httpMethodStringMap(
+            static_cast<HttpMethod>(access.method));
+
+    const std::string &uri = getString(decoder, access.pid, access.uri);
+    const std::string &user_agent =
+        getString(decoder, access.pid, access.user_agent);
+    if (decoder.json)
+    {
+        output += "{\"time\":\"" + time + "\",\"remote_addr\":\"" +
+                  client_ip + "\",\"method\":\"" + method + "\",\"uri\":";
+        appendString(output, uri, true);
+        snprintf(buffer, sizeof(buffer),
+                 ",\"status\":%u,\"bytes_sent\":%llu,\"request_time\":%u.%06u,"
+                 "\"user_agent\":",
+                 access.status,
+                 static_cast<unsigned long long>(access.bytes_sent),
+                 access.duration / 1000000, access.duration % 1000000);
+        output += buffer;
+        appendString(output, user_agent, true);
+        snprintf(buffer, sizeof(buffer), ",\"pid\":%u}\n", access.pid);
+        output += buffer;
+        return;
+    }
+    output += time + ' ' + client_ip + ' ' + method + ' ';
+    appendString(output, uri, false);
+    snprintf(buffer, sizeof(buffer), " %u %llu %u.%06u ", access.status,
+             static_cast<unsigned long long>(access.bytes_sent),
+             access.duration / 1000000, access.duration % 1000000);
+    output += buffer;
+    appendString(output, user_agent, false);
+    output += '\n';
+}
+
+// Get the size of the record at the start of a buffer holding at least its
+// magic number and type, 0 if it is not a record, setting complete if all of
+// its bytes are there
+static size_t getRecordSize(const char *record, size_t left, bool &complete)
+{
+    uint32_t magic;
+    memcpy(&magic, record, sizeof(magic));
+    if (magic != BINARY_LOG_MAGIC)
+        return 0;
+
+    size_t size = 0;
+    switch (record[ sizeof(magic) ])
+    {
+    case BINARY_LOG_HEADER:
+    {
+        BinaryLogHeader header;
+        size = sizeof(header);
+        if (left < size)
+            break;
+        memcpy(&header, record, sizeof(header));
+        if (header.version != BINARY_LOG_VERSION)
+            return 0;
+        break;
+    }
+    case BINARY_LOG_STRING:
+    {
+        BinaryLogString header;
+        size = sizeof(header);
+        if (left < size)
+            break;
+        memcpy(&header, record, sizeof(header));
+        if (header.length > BINARY_LOG_TABLE_SIZE)
+            return 0;
+        size += header.length;
+        break;
+    }
+    case BINARY_LOG_ACCESS:
+        size = sizeof(BinaryLogAccess);
+        break;
+    default:
+        return 0;
+    }
+    complete = left >= size;
+    return size;
+}
+
+// Decode a record whose bytes are all there
+static void decodeRecord(Decoder &decoder, const char *record)
+{
+    if (record[ sizeof(uint32_t) ] == BINARY_LOG_HEADER)
+    {
+        // A worker starts its table again
+        BinaryLogHeader header;
+        memcpy(&header, record, sizeof(header));
+        decoder.tables[ header.pid ].clear();
+    }
+    else if (record[ sizeof(uint32_t) ] == BINARY_LOG_STRING)
+    {
+        BinaryLogString header;
+        memcpy(&header, record, sizeof(header));
+        decoder.tables[ header.pid ][ header.offset ].assign(
+            record + sizeof(header), header.length);
+    }
+    else
+    {
+        BinaryLogAccess access;
+        memcpy(&access, record, sizeof(access));
+        appendAccess(decoder, access);
+    }
+    decoder.records++;
+}
+
+// Decode the complete records at the start of a buffer, the end of the file
+// being reached if end is set
+// A record is only decoded once the magic number of the next one, or the end
+// of the file, follows it: the bytes up to the next magic number are skipped
+// otherwise, as a torn record
+// Returns the number of bytes decoded or skipped, or -1 if the buffer is not
+// a log
+static ssize_t decodeRecords(Decoder &decoder, const char *data, size_t size,
+                             bool end)
+{
+    const uint32_t magic = BINARY_LOG_MAGIC;
+    size_t position = 0;
+    while (size - position > sizeof(magic))
+    {
+        const char *record = data + position;
+        size_t left = size - position;
+
+        // Wait for the rest of the record, and the start of the next one
+        bool complete = false;
+        size_t record_size = getRecordSize(record, left, complete);
+        if (record_size != 0 && !complete && !end)
+            break;
+        if (record_size != 0 && complete &&
+            left - record_size < sizeof(magic) && !end)
+            break;
+
+        // Decode the record if it is followed by the next one, or ends the
+        // file
+        if (record_size != 0 && complete &&
+            (left == record_size ||
+             (left - record_size >= sizeof(magic) &&
+              memcmp(record + record_size, &magic, sizeof(magic)) == 0)))
+        {
+            decodeRecord(decoder, record);
+            position += record_size;
+            continue;
+        }
+
+        // A file that does not start with a record is not a log
+        if (record_size == 0 && decoder.records == 0 && decoder.skipped == 0)
+            return -1;
+
+        // Skip a torn record, up to the next magic number
+        const char *next = static_cast<const char *>(
+            memmem(record + 1, left - 1, &magic, sizeof(magic)));
+        size_t skip = next != NULL ? next - record : left - sizeof(magic) + 1;
+        decoder.skipped += skip;
+        position += skip;
+    }
+
+    // Bytes too few to hold a magic number and a type are torn as well, at
+    // the end
+    if (end && position < size)
+    {
+        decoder.skipped += size - position;
+        position = size;
+    }
+    return position;
+}
+
+// Decode a file
+// Returns false if it could not be read or is not a binary access log
+static bool decodeFile(Decoder &decoder, int file_descriptor,
+                       const char *name)
+{
+    std::vector<char> buffer;
+    size_t size = 0;
+    decoder.records = 0;
+    decoder.skipped = 0;
+    while (true)
+    {
+        // Read after the bytes left from the previous read
+        buffer.resize(size + LOGCAT_READ_SIZE);
+        ssize_t bytes = read(file_descriptor, &buffer[ size ],
+                             LOGCAT_READ_SIZE);
+        if (bytes == -1 && errno == EINTR)
+            continue;
+        if (bytes == -1)
+        {
+            fprintf(stderr, "webserv-logcat: %s: %s\n", name,
+                    strerror(errno));
+            return false;
+        }
+        size += bytes;
+
+        // Decode the complete records, keeping the last partial one until
+        // the end of the file
+        ssize_t decoded =
+            decodeRecords(decoder, &buffer[ 0 ], size, bytes == 0);
+        if (decoded == -1)
+        {
+            fprintf(stderr, "webserv-logcat: %s: not a binary access log\n",
+                    name);
+            return false;
+        }
+        memmove(&buffer[ 0 ], &buffer[ decoded ], size - decoded);
+        size -= decoded;
+        flushOutput(decoder);
+        if (bytes == 0)
+            break;
+    }
+    if (decoder.skipped > 0)
+        fprintf(stderr,
+                "webserv-logcat: %s: skipped %lu bytes of torn records\n",
+                name, static_cast<unsigned long>(decoder.skipped));
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    Decoder decoder;
+    decoder.json = false;
+
+    // Options
+    int first_file = 1;
+    if (argc > 1 && strcmp(argv[ 1 ], "-j") == 0)
+    {
+        decoder.json = true;
+        first_file++;
+    }
+    else if (argc > 1 && argv[ 1 ][ 0 ] == '-' && argv[ 1 ][ 1 ] != '\0')
+    {
+        fprintf(stderr, "usage: webserv-logcat [-j] [file ...]\n");
+        return 2;
+    }
+
+    // Standard input, if no file is given
+    if (first_file == argc)
+        return decodeFile(decoder, STDIN_FILENO, "-") ? 0 : 1;
+
+    int status = 0;
+    for (int i = first_file; i < argc; i++)
+    {
+        int file_descriptor = open(argv[ i ], O_RDONLY);
+        if (file_descriptor == -1)
+        {
+            fprintf(stderr, "webserv-logcat: %s: %s\n", argv[ i ],
+                    strerror(errno));
+            status = 1;
+            continue;
+        }
+        if (!decodeFile(decoder, file_descriptor, argv[ i ]))
+            status = 1;
+        close(file_descriptor);
+    }
+    return status;
+}
+
+// Path: tools/webserv-logcat.cpp
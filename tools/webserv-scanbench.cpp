@@ -0,0 +1,255 @@
+#include "../includes/utils/DelimiterScanner.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCANBENCH_RDTSC
+#include <x86intrin.h>
+#endif
+
+/*
+ * webserv-scanbench
+ *
+ * Measures the implementations of the DelimiterScanner on the same inputs
+ * and writes their throughput, in bytes per cycle of the time stamp counter
+ * (bytes per nanosecond on CPUs without one), along with the speedup over
+ * the scalar loop:
+ *
+ *   input           delimiters scalar          sse2            avx2
+ *   token of 1024 B CRLF       0.89 B/c (x1.0) 10.85 B/c (x12.2) 20.10 ...
+ *
+ * Each input is scanned from delimiter to delimiter, as the request parser
+ * does, and the best of several rounds is kept. The "header lines" input is
+ * scanned as the parser does it, the header names with the scalar loop and
+ * the rest with the implementation of the column. The figures depend on the
+ * optimization flags the scanner is built with.
+ *
+ * Usage: webserv-scanbench [rounds]
+ *
+ */
+
+// Bytes scanned per round, by input
+#define SCANBENCH_INPUT_SIZE (1 << 20)
+
+// Default number of rounds, the best one being kept
+#define SCANBENCH_ROUNDS 20
+
+// Implementations, in the order of the columns
+static const char *const s_implementations[] = {"scalar", "sse2", "avx2"};
+static const size_t s_implementation_count = 3;
+
+// Request head sent by a browser, repeated to fill the head input
+static const char s_request_head[] =
+    "GET /images/logo.png?v=1718093215 HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:126.0) Gecko/20100101 "
+    "Firefox/126.0\r\n"
+    "Accept: image/avif,image/webp,image/png,image/svg+xml,image/*;q=0.8,"
+    "*/*;q=0.5\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Connection: keep-alive\r\n"
+    "Referer: http://localhost:8080/index.html\r\n"
+    "Cookie: session=1081419069; theme=dark\r\n"
+    "Sec-Fetch-Dest: image\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Priority: u=5, i\r\n"
+    "\r\n";
+
+// Input of a measure
+struct Input
+{
+    const char *name;       // Name of the input
+    const char *delimiters; // Delimiters looked for
+    std::string data;       // Bytes scanned
+    bool header_lines;      // Scan the header names with the scalar loop
+};
+
+// Get the current time stamp
+static unsigned long long now()
+{
+#ifdef SCANBENCH_RDTSC
+    return __rdtsc();
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000000ULL + time.tv_nsec;
+#endif
+}
+
+// Fill an input with a filler byte, a delimiter every spacing bytes
+static std::string makeSpacedInput(size_t spacing, char delimiter)
+{
+    std::string data(SCANBENCH_INPUT_SIZE, 'a');
+    for (size_t i = spacing - 1; i < data.size(); i += spacing)
+        data[ i ] = delimiter;
+    return data;
+}
+
+// Fill an input with request heads
+static std::string makeHeadInput()
+{
+    std::string data;
+    data.reserve(SCANBENCH_INPUT_SIZE + sizeof(s_request_head));
+    while (data.size() < SCANBENCH_INPUT_SIZE)
+        data += s_request_head;
+    return data;
+}
+
+// Scan an input from delimiter to delimiter
+// Returns the sum of the offsets found, so that no scan is optimized away
+static size_t scanInput(DelimiterScanner::ScanFunction scan,
+                        const char *delimiters, const std::string &data)
+{
+    const char *begin = data.data();
+    const char *end = begin + data.size();
+    size_t sum = 0;
+    for (const char *position = begin; position < end; position++)
+    {
+        position = scan(position, end, delimiters);
+        sum += position - begin;
+    }
+    return sum;
+}
+
+// Scan request heads as the request parser does, the header names with the
+// scalar loop and the request lines and header values with an implementation
+// Returns the sum of the offsets found, so that no scan is optimized away
+static size_t scanHeaderLines(DelimiterScanner::ScanFunction scan,
+                              const std::string &data)
+{
+    DelimiterScanner::ScanFunction scalar =
+        DelimiterScanner::getScanFunction("scalar");
+    const char name_delimiters[] = {':', '\r', '\n', '\n'};
+    const char line_delimiters[] = {'\r', '\n', '\n', '\n'};
+    const char *begin = data.data();
+    const char *end = begin + data.size();
+    size_t sum = 0;
+    bool name = false;
+    for (const char *position = begin; position < end; position++)
+    {
+        // A header name ends on ':', its value on the end of the line
+        if (name)
+            position = scalar(position, end, name_delimiters);
+        else
+            position = scan(position, end, line_delimiters);
+        sum += position - begin;
+        if (position < end)
+            name = (*position != ':');
+    }
+    return sum;
+}
+
+// Measure an implementation on an input
+// Returns the bytes scanned per time stamp tick, at best
+static double measure(DelimiterScanner::ScanFunction scan, const Input &input,
+                      int rounds, size_t &checksum)
+{
+    // Fill the set of delimiters as the scanner does
+    char delimiters[ DELIMITER_SCANNER_MAX_DELIMITERS ];
+    size_t count = strlen(input.delimiters);
+    for (size_t i = 0; i < DELIMITER_SCANNER_MAX_DELIMITERS; i++)
+        delimiters[ i ] = input.delimiters[ i < count ? i : count - 1 ];
+
+    // Keep the fastest round, the others having been interrupted
+    unsigned long long best = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        unsigned long long start = now();
+        checksum += input.header_lines
+                        ? scanHeaderLines(scan, input.data)
+                        : scanInput(scan, delimiters, input.data);
+        unsigned long long ticks = now() - start;
+        if (round == 0 || ticks < best)
+            best = ticks;
+    }
+    return best == 0 ? 0 : static_cast<double>(input.data.size()) / best;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = SCANBENCH_ROUNDS;
+    if (argc > 1)
+        rounds = atoi(argv[ 1 ]);
+    if (argc > 2 || rounds <= 0)
+    {
+        fprintf(stderr, "usage: webserv-scanbench [rounds]\n");
+        return 2;
+    }
+
+    // Inputs, from the request heads to long tokens
+    std::vector<Input> inputs;
+    Input input;
+    input.name = "request head";
+    input.delimiters = "\r\n";
+    input.data = makeHeadInput();
+    input.header_lines = false;
+    inputs.push_back(input);
+    input.name = "header names";
+    input.delimiters = ":\r\n";
+    inputs.push_back(input);
+    input.name = "header lines";
+    input.header_lines = true;
+    inputs.push_back(input);
+    input.header_lines = false;
+    size_t spacings[] = {16, 64, 256, 1024, 8192};
+    static char names[ 5 ][ 32 ];
+    for (size_t i = 0; i < 5; i++)
+    {
+        snprintf(names[ i ], sizeof(names[ i ]), "token of %lu B",
+                 static_cast<unsigned long>(spacings[ i ]));
+        input.name = names[ i ];
+        input.delimiters = "\r\n";
+        input.data = makeSpacedInput(spacings[ i ], '\r');
+        inputs.push_back(input);
+    }
+
+    // Header
+    const char *unit = "B/c";
+#ifndef SCANBENCH_RDTSC
+    unit = "B/ns";
+#endif
+    printf("%-16s %-10s", "input", "delimiters");
+    for (size_t i = 0; i < s_implementation_count; i++)
+        printf(" %-22s", s_implementations[ i ]);
+    printf("\n");
+
+    // One line per input, one column per implementation
+    size_t checksum = 0;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        printf("%-16s %-10s", inputs[ i ].name,
+               strcmp(inputs[ i ].delimiters, "\r\n") == 0 ? "CRLF"
+                                                           : "':' CRLF");
+        double scalar = 0;
+        for (size_t j = 0; j < s_implementation_count; j++)
+        {
+            DelimiterScanner::ScanFunction scan =
+                DelimiterScanner::getScanFunction(s_implementations[ j ]);
+            if (scan == NULL)
+            {
+                printf(" %-22s", "unsupported");
+                continue;
+            }
+            double rate = measure(scan, inputs[ i ], rounds, checksum);
+            if (j == 0)
+                scalar = rate;
+            char cell[ 32 ];
+            snprintf(cell, sizeof(cell), "%.2f %s (x%.1f)", rate, unit,
+                     scalar == 0 ? 0 : rate / scalar);
+            printf(" %-22s", cell);
+        }
+        printf("\n");
+    }
+
+    // Keep the scans from being optimized away
+    fprintf(stderr, "checksum %lu\n", static_cast<unsigned long>(checksum));
+    return 0;
+}
+
+// Path: tools/webserv-scanbench.cpp